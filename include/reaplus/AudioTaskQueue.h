@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include "util/InlineTask.h"
+#include "util/BoundedQueue.h"
+
+namespace reaplus {
+  // Enough for a few pointers and numbers. Captures are destroyed in the audio thread, so they shouldn't own heap
+  // memory (e.g. std::string).
+  using AudioTask = util::InlineTask<64>;
+
+  // Bounded lock-free queue of tasks to be executed in the audio thread. Any thread may push, only the audio hook runs
+  // tasks. Task storage is allocated at construction, so neither push() nor runFor() allocates or takes a lock.
+  class AudioTaskQueue {
+  public:
+    // Capacity is rounded up to the next power of two
+    explicit AudioTaskQueue(std::size_t capacity);
+
+    AudioTaskQueue(const AudioTaskQueue&) = delete;
+
+    AudioTaskQueue& operator=(const AudioTaskQueue&) = delete;
+
+    // Any thread. Returns false and counts a drop if the queue is full.
+    template<typename F>
+    bool push(F&& task) {
+      if (!tasks_.tryPush(AudioTask(std::forward<F>(task)))) {
+        droppedCount_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      return true;
+    }
+
+    // Consumer only. Executes tasks in push order until the queue is empty or the budget is used up and returns the
+    // number of executed tasks. Executes at least one task (if there's one), so a budget of 0 means one task per call.
+    std::size_t runFor(std::chrono::microseconds budget);
+
+    std::size_t capacity() const;
+
+    // Approximate if called while other threads push
+    std::size_t size() const;
+
+    // Number of tasks rejected because the queue was full
+    std::uint64_t droppedCount() const;
+
+    // Sum of the tasks which were still waiting when runFor() ran out of budget
+    std::uint64_t deferredCount() const;
+
+    std::uint64_t executedCount() const;
+
+  private:
+    util::BoundedQueue<AudioTask> tasks_;
+    std::atomic<std::uint64_t> droppedCount_{0};
+    std::atomic<std::uint64_t> deferredCount_{0};
+    std::atomic<std::uint64_t> executedCount_{0};
+  };
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <chrono>
+#include <stdexcept>
+#include "MainThreadTaskQueue.h"
+#include "AudioTaskQueue.h"
+
+namespace reaplus {
+  // Thread hops for C++20 coroutines, e.g. co_await Reaper::instance().mainThread() (see Coroutines.h for a suitable
+  // coroutine return type). await_suspend() takes any coroutine handle type, so this header (and Reaper.h) stays usable
+  // from C++17. Suspending doesn't allocate unless the main thread queues need to grow.
+
+  // Resumes immediately if already in the main thread, otherwise in the next Run() cycle
+  class MainThreadAwaitable {
+  public:
+    bool await_ready() const;
+
+    template<typename Handle>
+    void await_suspend(Handle handle) const {
+      scheduleInMainThread(MainThreadTask([handle] {
+        handle.resume();
+      }));
+    }
+
+    void await_resume() const {
+    }
+
+  private:
+    static void scheduleInMainThread(MainThreadTask task);
+  };
+
+  // Resumes in the main thread at the beginning of the next Run() cycle, with feedback priority (see
+  // MainThreadScheduler)
+  class NextRunCycleAwaitable {
+  public:
+    bool await_ready() const {
+      return false;
+    }
+
+    template<typename Handle>
+    void await_suspend(Handle handle) const {
+      scheduleInNextRunCycle(MainThreadTask([handle] {
+        handle.resume();
+      }));
+    }
+
+    void await_resume() const {
+    }
+
+  private:
+    static void scheduleInNextRunCycle(MainThreadTask task);
+  };
+
+  // Resumes in the audio thread at the beginning of the next audio block. Everything up to the next hop then runs in
+  // the audio thread, so it must be real-time safe. Throws std::runtime_error if the audio task queue is full.
+  class AudioBlockAwaitable {
+  public:
+    bool await_ready() const {
+      return false;
+    }
+
+    // Doesn't suspend if the task queue is full
+    template<typename Handle>
+    bool await_suspend(Handle handle) {
+      queued_ = scheduleInAudioThread(AudioTask([handle] {
+        handle.resume();
+      }));
+      return queued_;
+    }
+
+    void await_resume() const {
+      if (!queued_) {
+        throw std::runtime_error("audio task queue full");
+      }
+    }
+
+  private:
+    bool queued_ = false;
+
+    static bool scheduleInAudioThread(AudioTask task);
+  };
+
+  // Resumes in the main thread as soon as the given time has passed, with 1 ms resolution (see TimerWheel). Timers are
+  // checked once per Run() cycle, so the delay is rounded up to the next cycle. Suspending from another thread (e.g.
+  // the audio thread) first hops to the main thread via the fast queue, so only the main thread touches the timer wheel.
+  class DelayAwaitable {
+  public:
+    explicit DelayAwaitable(std::chrono::steady_clock::duration duration);
+
+    bool await_ready() const;
+
+    template<typename Handle>
+    void await_suspend(Handle handle) const {
+      const auto resume = [handle] {
+        handle.resume();
+      };
+      if (isInMainThread()) {
+        scheduleAt(dueTime_, MainThreadTask(resume));
+      } else {
+        const auto dueTime = dueTime_;
+        scheduleInMainThread(MainThreadTask([dueTime, resume] {
+          scheduleAt(dueTime, MainThreadTask(resume));
+        }));
+      }
+    }
+
+    void await_resume() const {
+    }
+
+  private:
+    std::chrono::steady_clock::time_point dueTime_;
+
+    static bool isInMainThread();
+
+    static void scheduleInMainThread(MainThreadTask task);
+
+    static void scheduleAt(std::chrono::steady_clock::time_point dueTime, MainThreadTask task);
+  };
+
+  DelayAwaitable delay(std::chrono::steady_clock::duration duration);
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <reaper_plugin.h>
+#include <cstdint>
+#include <type_traits>
+
+namespace reaplus {
+  enum class ControlSurfaceEventKind : std::uint8_t {
+    FxParameterValueChanged,
+    // REAPER reported the last known value again
+    FxParameterValueUnchanged,
+    FxParameterTouched,
+    TrackVolumeChanged,
+    TrackVolumeTouched,
+    TrackPanChanged,
+    TrackPanTouched,
+    TrackSendVolumeChanged,
+    TrackSendVolumeTouched,
+    TrackSendPanChanged,
+    TrackSendPanTouched,
+    TrackAdded,
+    TrackRemoved,
+    TracksReordered,
+    TrackMoved,
+    TrackNameChanged,
+    TrackInputChanged,
+    TrackInputMonitoringChanged,
+    TrackArmChanged,
+    TrackMuteChanged,
+    TrackMuteTouched,
+    TrackSoloChanged,
+    TrackSelectedChanged,
+    FxAdded,
+    FxRemoved,
+    FxEnabledChanged,
+    FxOpened,
+    FxClosed,
+    FxFocused,
+    FxReordered,
+    FxMoved,
+    MasterTempoChanged,
+    MasterTempoTouched,
+    MasterPlayrateChanged,
+    MasterPlayrateTouched,
+    MainThreadIdle,
+    ProjectClosed,
+    FxParameterValueChangedCoalesced,
+    TrackVolumeChangedCoalesced,
+    TrackPanChangedCoalesced,
+    TrackSendVolumeChangedCoalesced,
+    TrackSendPanChangedCoalesced
+  };
+
+  using ControlSurfaceEventMask = std::uint64_t;
+
+  constexpr ControlSurfaceEventMask eventMask(ControlSurfaceEventKind kind) {
+    return ControlSurfaceEventMask(1) << static_cast<int>(kind);
+  }
+
+  template<typename... Kinds>
+  constexpr ControlSurfaceEventMask eventMask(ControlSurfaceEventKind kind, Kinds... kinds) {
+    return eventMask(kind) | eventMask(kinds...);
+  }
+
+  // Compact POD event as published by HelperControlSurface. Fields which don't apply to a kind have their default.
+  struct ControlSurfaceEvent {
+    ControlSurfaceEventKind kind;
+    // FX events
+    bool isInputFx = false;
+    // FX index (FX events), send index (send events) or old index (FxMoved, TrackMoved)
+    int index = -1;
+    // Parameter index (FX parameter events) or new index (FxMoved, TrackMoved)
+    int subIndex = -1;
+    // nullptr for FxFocused means that no FX is focused anymore
+    MediaTrack* mediaTrack = nullptr;
+    // Only set for project-level events (TrackRemoved, TracksReordered, TrackMoved, ProjectClosed)
+    ReaProject* reaProject = nullptr;
+    // Latest value as reported by REAPER, if any
+    double value = 0;
+    // GUID of the track (TrackRemoved) or FX (FxAdded, FxRemoved)
+    GUID guid = {};
+  };
+
+  static_assert(std::is_trivially_copyable<ControlSurfaceEvent>::value, "Events are copied into a ring buffer");
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "ControlSurfaceEvent.h"
+
+namespace reaplus {
+  // Single dispatcher for all events detected by HelperControlSurface. Listeners register for a mask of event kinds.
+  // Publishing an event which nobody listens to is just a mask check. Events published while a dispatch is running
+  // (e.g. by a listener) are queued in a preallocated ring and delivered after the current event, in order.
+  //
+  // Not thread-safe. Must only be used from the main thread.
+  class ControlSurfaceEventBus {
+  public:
+    using Listener = std::function<void(const ControlSurfaceEvent&)>;
+    using ListenerId = std::uint64_t;
+
+    explicit ControlSurfaceEventBus(std::size_t ringCapacity);
+
+    ListenerId addListener(ControlSurfaceEventMask mask, Listener listener);
+
+    void removeListener(ListenerId id);
+
+    bool hasListeners(ControlSurfaceEventKind kind) const {
+      return (listenedMask_ & eventMask(kind)) != 0;
+    }
+
+    void publish(const ControlSurfaceEvent& event) {
+      if (hasListeners(event.kind)) {
+        enqueueAndDispatch(event);
+      }
+    }
+
+    // Number of events which didn't fit into the ring and therefore were delivered out of order (immediately)
+    std::uint64_t ringOverflowCount() const;
+
+  private:
+    struct Entry {
+      ListenerId id;
+      ControlSurfaceEventMask mask;
+      Listener listener;
+      bool removed;
+    };
+    std::vector<Entry> entries_;
+    // Listeners added during dispatch, merged afterwards (so entries_ doesn't reallocate while we iterate it)
+    std::vector<Entry> addedEntries_;
+    ControlSurfaceEventMask listenedMask_ = 0;
+    ListenerId nextListenerId_ = 1;
+    std::vector<ControlSurfaceEvent> ring_;
+    std::size_t ringHead_ = 0;
+    std::size_t ringSize_ = 0;
+    bool isDispatching_ = false;
+    bool hasRemovedEntries_ = false;
+    std::uint64_t ringOverflowCount_ = 0;
+
+    void enqueueAndDispatch(const ControlSurfaceEvent& event);
+
+    void dispatch(const ControlSurfaceEvent& event);
+
+    void compactEntries();
+
+    void updateListenedMask();
+  };
+}
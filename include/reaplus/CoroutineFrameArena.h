@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "util/BoundedQueue.h"
+
+namespace reaplus {
+  // Recycles coroutine frames (see Coroutines.h) so that starting a coroutine doesn't hit the heap once a frame of
+  // similar size has been freed before. Frames are grouped in power-of-two size classes, each one with a lock-free
+  // free list, so frames may be allocated in one thread and freed in another one (e.g. the audio thread).
+  class CoroutineFrameArena {
+  public:
+    static constexpr std::size_t MIN_BLOCK_SIZE = 128;
+    // Bigger frames are allocated and freed on the heap directly
+    static constexpr std::size_t MAX_BLOCK_SIZE = 4096;
+    static constexpr std::size_t DEFAULT_FREE_BLOCKS_PER_SIZE_CLASS = 64;
+
+    // Used by Coroutines.h. Never destroyed because frames could be freed at any time.
+    static CoroutineFrameArena& instance();
+
+    explicit CoroutineFrameArena(std::size_t freeBlocksPerSizeClass = DEFAULT_FREE_BLOCKS_PER_SIZE_CLASS);
+
+    // Must not be destroyed while blocks are in use
+    ~CoroutineFrameArena();
+
+    CoroutineFrameArena(const CoroutineFrameArena&) = delete;
+
+    CoroutineFrameArena& operator=(const CoroutineFrameArena&) = delete;
+
+    // Any thread. Throws std::bad_alloc if a new block is needed and the heap is exhausted.
+    void* allocate(std::size_t size);
+
+    // Any thread. Size must be the one passed to allocate(). Keeps the block for reuse unless the free list of its
+    // size class is full.
+    void deallocate(void* block, std::size_t size) noexcept;
+
+    // Number of allocate() calls which couldn't reuse a block
+    std::uint64_t heapAllocationCount() const;
+
+    std::uint64_t reuseCount() const;
+
+  private:
+    static constexpr std::size_t SIZE_CLASS_COUNT = 6;
+
+    std::array<std::unique_ptr<util::BoundedQueue<void*>>, SIZE_CLASS_COUNT> freeBlocks_;
+    std::atomic<std::uint64_t> heapAllocationCount_{0};
+    std::atomic<std::uint64_t> reuseCount_{0};
+
+    // SIZE_CLASS_COUNT if too big for pooling
+    static std::size_t sizeClassOf(std::size_t size);
+
+    static std::size_t blockSizeOf(std::size_t sizeClass);
+  };
+}
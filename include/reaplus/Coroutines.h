@@ -0,0 +1,57 @@
+#pragma once
+
+// Opt-in, needs C++20 in the including translation unit. ReaPlus itself is still built as C++17.
+#if !defined(__cpp_impl_coroutine)
+#error "reaplus/Coroutines.h requires C++20 coroutine support"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include "CoroutineFrameArena.h"
+#include "Awaitables.h"
+#include "util/log.h"
+
+namespace reaplus {
+  // Return type for fire-and-forget coroutines which hop between threads by awaiting the awaitables of Awaitables.h
+  // (e.g. Reaper::mainThread()). Starts running immediately in the calling thread and destroys itself when done.
+  // Exceptions which leave the coroutine are logged. Frames come from CoroutineFrameArena, so starting a coroutine
+  // doesn't allocate once a frame of similar size has been freed before.
+  //
+  //   AsyncTask flashTrackName(Track track) {
+  //     co_await Reaper::instance().mainThread();
+  //     track.setName("!");
+  //     co_await delay(std::chrono::milliseconds(500));
+  //     track.setName("");
+  //   }
+  class AsyncTask {
+  public:
+    struct promise_type {
+      static void* operator new(std::size_t size) {
+        return CoroutineFrameArena::instance().allocate(size);
+      }
+
+      static void operator delete(void* frame, std::size_t size) noexcept {
+        CoroutineFrameArena::instance().deallocate(frame, size);
+      }
+
+      AsyncTask get_return_object() noexcept {
+        return AsyncTask();
+      }
+
+      std::suspend_never initial_suspend() noexcept {
+        return {};
+      }
+
+      std::suspend_never final_suspend() noexcept {
+        return {};
+      }
+
+      void return_void() noexcept {
+      }
+
+      void unhandled_exception() noexcept {
+        util::logException();
+      }
+    };
+  };
+}
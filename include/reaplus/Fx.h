@@ -44,6 +44,7 @@ namespace reaplus {
   class Fx {
     friend class FxChain;
     friend class Track;
+    friend class HelperControlSurface;
   private:
     // TODO Save chain instead of track
     // DONE-rust
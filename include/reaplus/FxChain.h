@@ -2,6 +2,7 @@
 
 #include <boost/optional.hpp>
 #include <rxcpp/rx.hpp>
+#include <vector>
 #include "Track.h"
 #include "Chunk.h"
 
@@ -71,5 +72,17 @@ namespace reaplus {
     // DONE-rust
     boost::optional<ChunkRegion> findChunkRegion(Chunk trackChunk) const;
   };
-}
 
+  // Position change of one FX within its chain
+  struct FxMove {
+    int fromIndex;
+    int toIndex;
+  };
+
+  // Contains all FX whose position relative to the other FX changed. FX which merely shifted because of added or
+  // removed FX are not included.
+  struct FxChainReordering {
+    FxChain fxChain;
+    std::vector<FxMove> moves;
+  };
+}
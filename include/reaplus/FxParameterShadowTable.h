@@ -0,0 +1,84 @@
+#pragma once
+
+#include <reaper_plugin.h>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace reaplus {
+  // Last known values of FX parameters as reported to the control surface. Each actual value change gets a new
+  // sequence number, so consumers can ask for everything that changed since they last looked. Refers to FX by index,
+  // so entries of a chain are dropped whenever FX are added, removed or moved. Main thread only.
+  class FxParameterShadowTable {
+  public:
+    struct Entry {
+      MediaTrack* mediaTrack;
+      bool isInputFx;
+      int fxIndex;
+      int paramIndex;
+      double value;
+      std::uint64_t sequence;
+    };
+
+    // Returns false if the value equals the last known one
+    bool update(MediaTrack* mediaTrack, bool isInputFx, int fxIndex, int paramIndex, double value);
+
+    // Returns nullptr if no value known
+    const Entry* find(MediaTrack* mediaTrack, bool isInputFx, int fxIndex, int paramIndex) const;
+
+    // Sequence number of the latest change, 0 if none
+    std::uint64_t sequence() const;
+
+    // Newest first. Only visits entries which changed after the given sequence number.
+    void forEachChangedSince(std::uint64_t sequence, const std::function<void(const Entry&)>& consumer) const;
+
+    void removeFxChain(MediaTrack* mediaTrack, bool isInputFx);
+
+    void removeTracks(const std::function<bool(MediaTrack*)>& predicate);
+
+  private:
+    struct Key {
+      MediaTrack* mediaTrack;
+      bool isInputFx;
+      int fxIndex;
+      int paramIndex;
+
+      friend bool operator==(const Key& lhs, const Key& rhs) {
+        return lhs.mediaTrack == rhs.mediaTrack && lhs.isInputFx == rhs.isInputFx && lhs.fxIndex == rhs.fxIndex
+            && lhs.paramIndex == rhs.paramIndex;
+      }
+    };
+
+    struct KeyHash {
+      std::size_t operator()(const Key& key) const {
+        auto h = std::hash<MediaTrack*>()(key.mediaTrack);
+        h = h * 31 + std::hash<int>()(key.fxIndex);
+        h = h * 31 + std::hash<int>()(key.paramIndex);
+        return h * 2 + (key.isInputFx ? 1 : 0);
+      }
+    };
+
+    // Nodes form a doubly-linked list ordered by sequence number (head is oldest)
+    struct Node {
+      Entry entry;
+      int prev;
+      int next;
+    };
+
+    std::vector<Node> nodes_;
+    std::unordered_map<Key, int, KeyHash> nodeIndexByKey_;
+    int head_ = -1;
+    int tail_ = -1;
+    std::uint64_t sequence_ = 0;
+
+    static Key keyOf(const Entry& entry);
+
+    void unlink(int index);
+
+    void linkAtTail(int index);
+
+    void remove(int index);
+  };
+}
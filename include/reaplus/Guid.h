@@ -12,6 +12,10 @@ namespace reaplus {
     explicit Guid(GUID data);
     GUID data() const;
     std::string toString() const;
+    // Binary comparisons, much cheaper than comparing string representations
+    friend bool operator==(const Guid& lhs, const Guid& rhs);
+    friend bool operator!=(const Guid& lhs, const Guid& rhs);
+    friend bool operator<(const Guid& lhs, const Guid& rhs);
   };
 }
 
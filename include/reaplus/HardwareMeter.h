@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <reaper_plugin.h>
+#include "util/SeqLock.h"
+
+namespace reaplus {
+  // Linear amplitudes (1.0 = 0 dBFS)
+  struct HardwareMeterLevel {
+    // Highest absolute sample value, falling with the configured decay
+    double peak;
+    // RMS of the last audio block, falling with the configured decay
+    double rms;
+    // Highest peak within the hold time, after that it follows peak
+    double heldPeak;
+  };
+
+  // Peak and RMS levels of the hardware output channels, measured by the audio hook after REAPER has processed the
+  // block (post-FX, i.e. what goes to the audio device). Levels can be read from any thread without locking and
+  // without blocking the audio thread. Disabled by default because it costs a pass over all output buffers per block.
+  class HardwareMeter {
+  public:
+    static constexpr int MAX_CHANNEL_COUNT = 64;
+    static constexpr double DEFAULT_DECAY_IN_DB_PER_SECOND = 20;
+    static constexpr std::chrono::milliseconds DEFAULT_HOLD_TIME{1000};
+
+    HardwareMeter();
+
+    HardwareMeter(const HardwareMeter&) = delete;
+
+    HardwareMeter& operator=(const HardwareMeter&) = delete;
+
+    // Any thread
+    void setEnabled(bool enabled);
+
+    bool isEnabled() const;
+
+    // How fast peak and RMS fall when the signal gets quieter, 0 means they follow the signal immediately. Any thread.
+    void setDecay(double decibelsPerSecond);
+
+    // How long heldPeak stays at its maximum before following peak again. Any thread.
+    void setHoldTime(std::chrono::milliseconds holdTime);
+
+    // Lets peak, RMS and held peak start from silence again, with the next block. Any thread.
+    void reset();
+
+    // Audio thread only (post hook). Measures the output buffers of the given hook registration.
+    void process(const audio_hook_register_t& reg, int blockLength, double sampleRate);
+
+    // Number of output channels measured in the last block (at most MAX_CHANNEL_COUNT). Any thread.
+    int channelCount() const;
+
+    // Zero if the channel hasn't been measured (yet). Any thread.
+    HardwareMeterLevel level(int channelIndex) const;
+
+  private:
+    struct ChannelState {
+      HardwareMeterLevel level;
+      // Samples left until heldPeak follows peak again
+      double holdSamplesLeft;
+    };
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<double> decayInDbPerSecond_{DEFAULT_DECAY_IN_DB_PER_SECOND};
+    std::atomic<std::int64_t> holdTimeInMillis_{DEFAULT_HOLD_TIME.count()};
+    std::atomic<bool> resetRequested_{false};
+    std::atomic<int> channelCount_{0};
+    // Audio thread only
+    std::array<ChannelState, MAX_CHANNEL_COUNT> channelStates_{};
+    std::array<util::SeqLock<HardwareMeterLevel>, MAX_CHANNEL_COUNT> levels_;
+  };
+}
@@ -2,22 +2,34 @@
 
 #include <functional>
 #include <unordered_map>
-#include <set>
 #include <memory>
 #include <vector>
 #include <array>
 #include <string>
 #include <mutex>
+#include <chrono>
 #include <boost/optional.hpp>
 #include "reaper_plugin.h"
 #include "rxcpp/rx.hpp"
 #include "util/rx-relaxed-runloop.hpp"
 #include "Project.h"
 #include "Fx.h"
+#include "FxChain.h"
+#include "Guid.h"
 #include "FxParameter.h"
+#include "FxParameterShadowTable.h"
 #include "Parameter.h"
+#include "ParameterRef.h"
 #include "Track.h"
-#include <concurrentqueue/concurrentqueue.h>
+#include "TrackDataStore.h"
+#include "TrackSend.h"
+#include "ValueChange.h"
+#include "ControlSurfaceEvent.h"
+#include "ControlSurfaceEventBus.h"
+#include "util/ChangeCoalescer.h"
+#include "MainThreadTaskQueue.h"
+#include "MainThreadScheduler.h"
+#include "TimerWheel.h"
 
 namespace reaplus {
 
@@ -29,24 +41,24 @@ namespace reaplus {
 
   class Reaper;
 
-  // DONE-rust
-  struct TrackData {
-    double volume;
-    double pan;
-    bool selected;
-    bool mute;
-    bool solo;
-    bool recarm;
-    int number;
-    int recmonitor;
-    int recinput;
-    std::string guid;
+  // FX GUID together with the position of the FX in its chain
+  struct IndexedFxGuid {
+    Guid guid;
+    int index;
   };
 
   // DONE-rust
   struct FxChainPair {
-    std::set<std::string> inputFxGuids;
-    std::set<std::string> outputFxGuids;
+    // Sorted by GUID
+    std::vector<IndexedFxGuid> inputFxGuids;
+    std::vector<IndexedFxGuid> outputFxGuids;
+  };
+
+  // Where the TrackData of a track lives
+  struct TrackDataLocation {
+    ReaProject* reaProject = nullptr;
+    TrackDataStore* store = nullptr;
+    TrackDataStore::Slot slot = TrackDataStore::NO_SLOT;
   };
 
   class HelperControlSurface : public IReaperControlSurface {
@@ -65,68 +77,99 @@ namespace reaplus {
       PropagatingTrackSetChanges
     };
 
+    // Identifies the target of a coalesced change
+    struct ChangeTargetKey {
+      ControlSurfaceEventKind kind;
+      MediaTrack* mediaTrack;
+      int index;
+      int subIndex;
+      bool isInputFx;
+
+      explicit ChangeTargetKey(const ControlSurfaceEvent& event) : kind(event.kind), mediaTrack(event.mediaTrack),
+          index(event.index), subIndex(event.subIndex), isInputFx(event.isInputFx) {
+      }
+
+      friend bool operator==(const ChangeTargetKey& lhs, const ChangeTargetKey& rhs) {
+        return lhs.kind == rhs.kind && lhs.mediaTrack == rhs.mediaTrack && lhs.index == rhs.index
+            && lhs.subIndex == rhs.subIndex && lhs.isInputFx == rhs.isInputFx;
+      }
+    };
+
+    struct ChangeTargetKeyHash {
+      std::size_t operator()(const ChangeTargetKey& key) const {
+        const auto h = std::hash<MediaTrack*>()(key.mediaTrack);
+        return h ^ (std::size_t(key.index) * 0x9E3779B1u + (std::size_t(key.subIndex) << 16)
+            + (std::size_t(key.kind) << 1) + key.isInputFx);
+      }
+    };
+
     // DONE-rust
     static std::unique_ptr<HelperControlSurface> INSTANCE;
-    // DONE-rust
-    static constexpr int FAST_COMMAND_BUFFER_SIZE = 100;
+    // Run() is called ~30 times per second, so this leaves plenty of room for the rest of the main thread
+    static constexpr std::chrono::milliseconds FAST_COMMAND_BUDGET{10};
+    // Time per Run() for reconciling the track sets of background projects
+    static constexpr std::chrono::milliseconds BACKGROUND_PROJECT_BUDGET{2};
+    static constexpr std::size_t EVENT_RING_CAPACITY = 1024;
+    // REAPER doesn't notify about MIDI device changes. Run() is called ~30 times per second, so this is about 1 s.
+    static constexpr int MIDI_DEVICE_POLL_INTERVAL_IN_RUN_CYCLES = 30;
+    // Number of added tracks read between two budget checks when reconciling background projects
+    static constexpr std::size_t BACKGROUND_TRACK_CHUNK_SIZE = 32;
+    // Number of latest FX parameter changes which count as recent when attributing a parameter change to the normal
+    // or input FX chain before REAPER 5.95 (see isProbablyInputFx())
+    static constexpr std::uint64_t FX_PARAMETER_ATTRIBUTION_WINDOW = 32;
+    int runCyclesUntilMidiDevicePoll_ = MIDI_DEVICE_POLL_INTERVAL_IN_RUN_CYCLES;
     // DONE-rust
     int numTrackSetChangesLeftToBePropagated_ = 0;
     // DONE-rust
-    rxcpp::subjects::subject<FxParameter> fxParameterValueChangedSubject_;
-    // DONE-rust
-    rxcpp::subjects::subject<FxParameter> fxParameterTouchedSubject_;
-    // DONE-rust
     bool fxHasBeenTouchedJustAMomentAgo_ = false;
-    // DONE-rust ...
-    rxcpp::subjects::subject<Track> trackVolumeChangedSubject_;
-    rxcpp::subjects::subject<Track> trackVolumeTouchedSubject_;
-    rxcpp::subjects::subject<Track> trackPanChangedSubject_;
-    rxcpp::subjects::subject<Track> trackPanTouchedSubject_;
-    rxcpp::subjects::subject<TrackSend> trackSendVolumeChangedSubject_;
-    rxcpp::subjects::subject<TrackSend> trackSendVolumeTouchedSubject_;
-    rxcpp::subjects::subject<TrackSend> trackSendPanChangedSubject_;
-    rxcpp::subjects::subject<TrackSend> trackSendPanTouchedSubject_;
-    rxcpp::subjects::subject<Track> trackAddedSubject_;
-    rxcpp::subjects::subject<Track> trackRemovedSubject_;
-    rxcpp::subjects::subject<Project> tracksReorderedSubject_;
-    rxcpp::subjects::subject<Track> trackNameChangedSubject_;
-    rxcpp::subjects::subject<Track> trackInputChangedSubject_;
-    rxcpp::subjects::subject<Track> trackInputMonitoringChangedSubject_;
-    rxcpp::subjects::subject<Track> trackArmChangedSubject_;
-    rxcpp::subjects::subject<Track> trackMuteChangedSubject_;
-    rxcpp::subjects::subject<Track> trackMuteTouchedSubject_;
-    rxcpp::subjects::subject<Track> trackSoloChangedSubject_;
-    rxcpp::subjects::subject<Track> trackSelectedChangedSubject_;
-    rxcpp::subjects::subject<Fx> fxAddedSubject_;
-    rxcpp::subjects::subject<Fx> fxRemovedSubject_;
-    rxcpp::subjects::subject<Fx> fxEnabledChangedSubject_;
-    rxcpp::subjects::subject<Fx> fxOpenedSubject_;
-    rxcpp::subjects::subject<Fx> fxClosedSubject_;
-    rxcpp::subjects::subject<boost::optional<Fx>> fxFocusedSubject_;
-    rxcpp::subjects::subject<Track> fxReorderedSubject_;
-    rxcpp::subjects::subject<bool> masterTempoChangedSubject_;
-    rxcpp::subjects::subject<bool> masterTempoTouchedSubject_;
-    rxcpp::subjects::subject<bool> masterPlayrateChangedSubject_;
-    rxcpp::subjects::subject<bool> masterPlayrateTouchedSubject_;
-    rxcpp::subjects::subject<bool> mainThreadIdleSubject_;
-    rxcpp::subjects::subject<Project> projectClosedSubject_;
+    // Backs all change/touch observables
+    ControlSurfaceEventBus eventBus_{EVENT_RING_CAPACITY};
+    // Dirty set for the *Coalesced observables, flushed in Run()
+    util::ChangeCoalescer<ChangeTargetKey, ControlSurfaceEvent, ChangeTargetKeyHash> changeCoalescer_;
     // DONE-rust
     rxcpp::subjects::behavior<Project> activeProjectBehavior_;
     // DONE-rust
-    using TrackDataMap = std::unordered_map<MediaTrack*, TrackData>;
-    // DONE-rust
-    std::unordered_map<ReaProject*, TrackDataMap> trackDataByMediaTrackByReaProject_;
+    // One store for each open project. Background projects are reconciled in Run().
+    std::unordered_map<ReaProject*, TrackDataStore> trackDataStoreByReaProject_;
+    // Refreshed in SetTrackListChange only, so that SetSurfaceVolume etc. don't need to query the current project.
+    // Points into trackDataStoreByReaProject_ (unordered_map values don't move on rehash).
+    ReaProject* activeReaProject_ = nullptr;
+    TrackDataStore* activeTrackDataStore_ = nullptr;
+    // Incremented in order to invalidate all cached automation states at once
+    std::uint32_t automationEpoch_ = 1;
+    // Project index (as in EnumProjects) at which the next background reconciliation starts. Stays at a project whose
+    // reconciliation ran out of budget, so the next Run() continues with it.
+    int nextBackgroundProjectIndex_ = 0;
+    // Set while track set changes are reconciled. Listeners of the published events may change the track list, but
+    // the resulting SetTrackListChange() only marks the change as deferred. It's reconciled when the running
+    // reconciliation is done, so that the scratch buffers and the store being diffed stay intact.
+    bool reconcilingTrackSets_ = false;
+    bool trackListChangeDeferred_ = false;
     // DONE-rust
     std::unordered_map<MediaTrack*, FxChainPair> fxChainPairByMediaTrack_;
+    // Scratch buffers for FX chain diffing, kept in order to reuse their capacity
+    std::vector<IndexedFxGuid> newFxGuidsBuffer_;
+    std::vector<IndexedFxGuid> addedFxGuidsBuffer_;
+    // Pairs of old and new index
+    std::vector<std::pair<int, int>> survivingFxBuffer_;
+    // Scratch buffers for track set diffing
+    std::vector<MediaTrack*> mediaTracksBuffer_;
+    std::vector<char> trackSeenBuffer_;
+    std::vector<int> addedTrackIndexesBuffer_;
+    std::vector<std::pair<int, int>> survivingTracksBuffer_;
+    std::vector<MediaTrack*> removedMediaTracksBuffer_;
+    FxParameterShadowTable fxParameterShadowTable_;
+    // Used by forEachMove()
+    std::vector<int> oldRanksBuffer_;
     rxcpp::schedulers::relaxed_run_loop mainThreadRunLoop_;
     rxcpp::observe_on_one_worker mainThreadCoordination_ =
         rxcpp::observe_on_one_worker(rxcpp::schedulers::make_relaxed_run_loop(mainThreadRunLoop_));
     rxcpp::observe_on_one_worker::coordinator_type
         mainThreadCoordinator_ = mainThreadCoordination_.create_coordinator();
     // DONE-rust
-    moodycamel::ConcurrentQueue<std::function<void(void)>> fastCommandQueue_;
-    // DONE-rust
-    std::array<std::function<void(void)>, FAST_COMMAND_BUFFER_SIZE> fastCommandBuffer_;
+    MainThreadTaskQueue fastCommandQueue_;
+    MainThreadScheduler mainThreadScheduler_;
+    TimerWheel timerWheel_;
 
     // Capabilities depending on REAPER version
     // DONE-rust
@@ -162,6 +205,8 @@ namespace reaplus {
     // DONE-rust
     int Extended(int call, void* parm1, void* parm2, void* parm3) override;
 
+    void SetAutoMode(int mode) override;
+
     // DONE-rust
     void SetTrackTitle(MediaTrack* trackid, const char* title) override;
 
@@ -188,6 +233,10 @@ namespace reaplus {
     // DONE-rust
     static void destroyInstance();
 
+    rxcpp::observable<ParameterRef> parameterValueChanged() const;
+
+    rxcpp::observable<ParameterRef> parameterTouched() const;
+
     rxcpp::observable<Parameter*> parameterValueChangedUnsafe() const;
 
     rxcpp::observable<Parameter*> parameterTouchedUnsafe() const;
@@ -242,6 +291,8 @@ namespace reaplus {
 
     rxcpp::observable<Project> tracksReordered() const;
 
+    rxcpp::observable<TrackListReordering> trackListReordered() const;
+
     rxcpp::observable<Project> projectClosed() const;
 
     rxcpp::observable<Fx> fxAdded() const;
@@ -254,6 +305,8 @@ namespace reaplus {
 
     rxcpp::observable<Track> fxReordered() const;
 
+    rxcpp::observable<FxChainReordering> fxChainReordered() const;
+
     rxcpp::observable<Fx> fxOpened() const;
 
     rxcpp::observable<Fx> fxClosed() const;
@@ -270,12 +323,33 @@ namespace reaplus {
 
     rxcpp::observable<bool> mainThreadIdle() const;
 
+    // Coalesced variants: At most one notification per target and Run() cycle, carrying the latest value
+    rxcpp::observable<ValueChange<FxParameter>> fxParameterValueChangedCoalesced() const;
+
+    rxcpp::observable<ValueChange<Track>> trackVolumeChangedCoalesced() const;
+
+    rxcpp::observable<ValueChange<Track>> trackPanChangedCoalesced() const;
+
+    rxcpp::observable<ValueChange<TrackSend>> trackSendVolumeChangedCoalesced() const;
+
+    rxcpp::observable<ValueChange<TrackSend>> trackSendPanChangedCoalesced() const;
+
     rxcpp::composite_subscription enqueueCommand(std::function<void(void)> command);
 
-    void enqueueCommandFast(std::function<void(void)> command);
+    void enqueueCommandFast(MainThreadTask command);
+
+    const MainThreadTaskQueue& fastCommandQueue() const;
+
+    MainThreadScheduler& mainThreadScheduler();
+
+    TimerWheel& timerWheel();
 
     const rxcpp::observe_on_one_worker& mainThreadCoordination() const;
 
+    ControlSurfaceEventBus& eventBus();
+
+    const FxParameterShadowTable& fxParameterShadowTable() const;
+
   private:
     // DONE-rust
     HelperControlSurface();
@@ -286,52 +360,89 @@ namespace reaplus {
     // DONE-rust
     void removeInvalidReaProjects();
 
+    // Diffs the current track list of the project against the known tracks in one pass. Publishes TrackRemoved,
+    // TrackAdded, TrackMoved and TracksReordered events and updates the store. Snapshot and diff are cheap and always
+    // complete. Reading added tracks is expensive (e.g. a large project opened in the background), so it stops after
+    // the chunk of added tracks during which the deadline has passed. Returns false in that case, calling it again
+    // continues with the remaining added tracks.
     // DONE-rust
-    void detectTrackSetChanges();
+    bool detectTrackSetChanges(ReaProject* reaProject, TrackDataStore& trackDatas,
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
 
-    // DONE-rust
-    void removeInvalidMediaTracks(const Project& project, TrackDataMap& trackDatas);
+    // Runs the given reconciliation and afterwards the track list changes deferred in the meantime
+    template<typename Reconcile>
+    void reconcileTrackSets(Reconcile reconcile);
 
-    // DONE-rust
-    void addMissingMediaTracks(const Project& project, TrackDataMap& trackDatas);
+    // Switches to the current project (if changed) and reconciles its track set
+    void reconcileActiveProject();
 
-    // DONE-rust
-    void updateMediaTrackPositions(const Project& project, TrackDataMap& trackDatas);
+    // Sorts the given tracks
+    void removeFxParameterShadowsOf(std::vector<MediaTrack*>& mediaTracks);
 
     // DONE-rust
     void detectFxChangesOnTrack(Track track, bool notifyListenersAboutChanges,
         bool checkNormalFxChain, bool checkInputFxChain);
 
-    // Returns true if FX was added or removed
+    // Diffs the given chain against the known FX GUIDs in one pass, publishes FxRemoved, FxAdded, FxMoved and
+    // FxReordered events and updates the known FX GUIDs
     // DONE-rust
-    bool detectFxChangesOnTrack(Track track,
-        std::set<std::string>& oldFxGuids,
+    void detectFxChangesOnTrack(Track track,
+        std::vector<IndexedFxGuid>& oldFxGuids,
         bool isInputFx,
         bool notifyListenersAboutChanges);
 
-    // DONE-rust
-    void removeInvalidFx(Track track,
-        std::set<std::string>& oldFxGuids,
-        bool isInputFx,
-        bool notifyListenersAboutChanges);
+    // Publishes FxMoved for each surviving FX whose relative position changed, followed by FxReordered
+    void publishFxMoves(MediaTrack* mediaTrack, bool isInputFx);
 
-    // DONE-rust
-    void addMissingFx(Track track, std::set<std::string>& fxGuids, bool isInputFx, bool notifyListenersAboutChanges);
+    // Calls onMove(oldIndex, newIndex) for each survivor (ordered by new index) whose rank among the survivors changed.
+    // Returns true if there was at least one move. Linear.
+    template<typename OnMove>
+    bool forEachMove(const std::vector<std::pair<int, int>>& survivors, OnMove onMove);
 
-    // DONE-rust
-    std::set<std::string> fxGuidsOnTrack(Track track, bool isInputFx) const;
+    // Returns GUIDs sorted by GUID
+    void readFxGuids(Track track, bool isInputFx, std::vector<IndexedFxGuid>& fxGuids) const;
 
     // DONE-rust
     bool isProbablyInputFx(Track track, int fxIndex, int paramIndex, double fxValue) const;
 
+    // Served from the automation state cache in the track's TrackDataStore if the track is known there
     // DONE-rust
-    bool trackParameterIsAutomated(Track track, std::string parameterName) const;
+    bool trackParameterIsAutomated(MediaTrack* mediaTrack, const TrackDataLocation& location,
+        AutomatedParameter parameter);
+
+    // Returns bits of automated parameters (those with an envelope and an effective mode that plays it back)
+    std::uint8_t queryAutomatedParameters(MediaTrack* mediaTrack) const;
+
+    // Called on automation mode changes and after actions (which might have created envelopes)
+    void invalidateAutomationStates();
 
     // DONE-rust
     State state() const;
 
+    void flushCoalescedChanges();
+
+    // Publishes the event itself and - if somebody listens to coalescedKind - marks it for coalesced delivery
+    void publishAndCoalesce(ControlSurfaceEvent event, ControlSurfaceEventKind coalescedKind);
+
+    // Executes immediately if called in main thread, otherwise in next Run() cycle
+    void executeInMainThreadFast(MainThreadTask command);
+
+    // Thin rx adapter on top of the event bus. The mapper converts a matching event to an observable item or
+    // returns none if it can't be resolved (anymore).
+    template<typename T>
+    rxcpp::observable<T> observeEvents(ControlSurfaceEventMask mask,
+        std::function<boost::optional<T>(const ControlSurfaceEvent&)> map) const;
+
+    // Looks up the track in the active project first and then in the project which contains it. Returns a location
+    // without store if not found.
     // DONE-rust
-    TrackData* findTrackDataByTrack(MediaTrack* mediaTrack);
+    TrackDataLocation findTrackData(MediaTrack* mediaTrack);
+
+    // Reconciles background projects round-robin until the given time budget is used up, checked per project and per
+    // chunk of added tracks. So the budget can be exceeded by the work in between: Taking the snapshot of a project's
+    // track list (CountTracks/GetTrack) and matching it against the store always run to completion, which is linear
+    // in the number of tracks of that project even if none of them changed.
+    void detectTrackSetChangesInBackgroundProjects(std::chrono::steady_clock::duration budget);
 
     // DONE-rust
     // From REAPER > 5.95, parmFxIndex should be interpreted as query index. For earlier versions it's a normal index
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include "MidiCaptureRing.h"
+
+namespace reaplus {
+  // Keeps track of control change messages per input device and channel and assembles them into high-resolution
+  // events:
+  //
+  // - 14-bit control changes: MSB on CC 0-31 followed by the LSB on CC 32-63 (emitted when the LSB arrives)
+  // - NRPN (CC 99/98) and RPN (CC 101/100) parameter numbers: data entry MSB on CC 6 yields a 7-bit event, a subsequent
+  //   data entry LSB on CC 38 a 14-bit event. RPN 127/127 (null) deselects the parameter.
+  //
+  // Data increment/decrement (CC 96/97) is not interpreted. State is allocated at construction, so processing doesn't
+  // allocate. Devices with an ID >= MAX_DEVICE_COUNT are ignored.
+  class HighResolutionMidiAssembler {
+  public:
+    static constexpr int MAX_DEVICE_COUNT = 64;
+
+    HighResolutionMidiAssembler();
+
+    HighResolutionMidiAssembler(const HighResolutionMidiAssembler&) = delete;
+
+    HighResolutionMidiAssembler& operator=(const HighResolutionMidiAssembler&) = delete;
+
+    // Audio thread only. Returns true and fills the assembled event if the given raw event completed one.
+    bool process(const CapturedMidiEvent& event, CapturedMidiEvent& assembledEvent);
+
+    // Forgets everything received so far
+    void reset();
+
+  private:
+    static constexpr std::int8_t UNKNOWN = -1;
+
+    struct ChannelState {
+      std::int8_t controlMsbs[32];
+      // Raw if no parameter is selected
+      CapturedMidiEventKind parameterKind;
+      std::int8_t parameterMsb;
+      std::int8_t parameterLsb;
+      std::int8_t dataMsb;
+    };
+
+    std::unique_ptr<ChannelState[]> channelStates_;
+
+    void selectParameter(ChannelState& state, CapturedMidiEventKind kind, bool isMsb, std::int8_t value);
+  };
+}
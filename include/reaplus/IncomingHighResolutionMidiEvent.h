@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include "MidiInputDevice.h"
+
+namespace reaplus {
+  enum class HighResolutionMidiEventKind {
+    ControlChange14Bit,
+    Nrpn,
+    Rpn
+  };
+
+  // Value assembled from several incoming control change messages, see Reaper::incomingHighResolutionMidiEvents()
+  class IncomingHighResolutionMidiEvent {
+  private:
+    MidiInputDevice inputDevice_;
+    HighResolutionMidiEventKind kind_;
+    int channel_;
+    int number_;
+    int value_;
+    bool is14Bit_;
+    int frameOffset_;
+    std::uint64_t samplePosition_;
+    double sampleRate_;
+  public:
+    IncomingHighResolutionMidiEvent(MidiInputDevice inputDevice, HighResolutionMidiEventKind kind, int channel,
+        int number, int value, bool is14Bit, int frameOffset, std::uint64_t samplePosition, double sampleRate);
+    MidiInputDevice inputDevice() const;
+    HighResolutionMidiEventKind kind() const;
+    // 0 - 15
+    int channel() const;
+    // Controller number (0 - 31) for 14-bit control changes, 14-bit parameter number for (N)RPN
+    int number() const;
+    // 0 - 16383 if is14Bit(), otherwise 0 - 127 (data entry MSB without LSB)
+    int value() const;
+    bool is14Bit() const;
+    int getFrameOffset() const;
+    std::uint64_t samplePosition() const;
+    double sampleRate() const;
+  };
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <helgoboss-midi/MidiMessage.h>
 #include "MidiInputDevice.h"
 
@@ -10,11 +11,22 @@ namespace reaplus {
     MidiInputDevice inputDevice_;
     helgoboss::MidiMessage message_;
     int frameOffset_;
+    std::uint64_t samplePosition_;
+    double sampleRate_;
   public:
-    IncomingMidiEvent(MidiInputDevice inputDevice, helgoboss::MidiMessage message, int frameOffset);
+    IncomingMidiEvent(MidiInputDevice inputDevice, helgoboss::MidiMessage message, int frameOffset,
+        std::uint64_t samplePosition = 0, double sampleRate = 0);
     MidiInputDevice inputDevice() const;
     helgoboss::MidiMessage message() const;
+    // As reported by REAPER, in units of 1/1024000 of a second (not samples)
     int getFrameOffset() const;
+    // Position in samples since ReaPlus was initialized, comparable with Reaper::sampleCounter(). Allows measuring
+    // latency and ordering events of different devices.
+    std::uint64_t samplePosition() const;
+    // Sample rate of the audio block in which the event was captured, 0 if unknown
+    double sampleRate() const;
+    // Sample position converted to seconds, 0 if the sample rate is unknown
+    double timeInSeconds() const;
   };
 }
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "IncomingMidiEvent.h"
+
+namespace reaplus {
+  // Contiguous view on all incoming MIDI events which were captured within one audio block, in capture order. Only
+  // valid during the notification which delivers it because ReaPlus reuses the underlying storage. Copy the events
+  // if they are needed later.
+  class IncomingMidiEventBlock {
+  private:
+    std::uint64_t blockIndex_;
+    const IncomingMidiEvent* events_;
+    std::size_t size_;
+  public:
+    IncomingMidiEventBlock(std::uint64_t blockIndex, const IncomingMidiEvent* events, std::size_t size);
+
+    // Number of the audio block (counting since ReaPlus was initialized) in which the events were captured
+    std::uint64_t blockIndex() const;
+
+    std::size_t size() const;
+
+    bool empty() const;
+
+    const IncomingMidiEvent& operator[](std::size_t index) const;
+
+    const IncomingMidiEvent* begin() const;
+
+    const IncomingMidiEvent* end() const;
+  };
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "MidiInputDevice.h"
+
+namespace reaplus {
+  // Read-only view on a captured SysEx message (including F0 and F7), see Reaper::incomingSysExEvents(). The message
+  // stays in its pool buffer, which is released as soon as the last copy of this event is destroyed. So don't keep
+  // events longer than necessary, otherwise the pool runs dry. Must not outlive Reaper.
+  class IncomingSysExEvent {
+  private:
+    MidiInputDevice inputDevice_;
+    std::shared_ptr<const unsigned char> data_;
+    std::size_t size_;
+    int frameOffset_;
+    std::uint64_t samplePosition_;
+    double sampleRate_;
+  public:
+    IncomingSysExEvent(MidiInputDevice inputDevice, std::shared_ptr<const unsigned char> data, std::size_t size,
+        int frameOffset, std::uint64_t samplePosition, double sampleRate);
+    MidiInputDevice inputDevice() const;
+    const unsigned char* data() const;
+    std::size_t size() const;
+    int getFrameOffset() const;
+    std::uint64_t samplePosition() const;
+    double sampleRate() const;
+  };
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <concurrentqueue/concurrentqueue.h>
+#include "MainThreadTaskQueue.h"
+
+namespace reaplus {
+  enum class MainThreadPriority {
+    // Controller/UI feedback, should reach the user within one Run() cycle
+    Feedback,
+    // Reactions to user input, e.g. chunk edits triggered by a button press
+    UserAction,
+    // Anything which can wait, e.g. housekeeping or deferred logging
+    Background
+  };
+
+  // Executes tasks in HelperControlSurface::Run(), higher priority classes first. Work per Run() is limited by a budget
+  // which adapts to the measured interval between Run() calls. Tasks which have waited longer than the deadline of
+  // their class are executed even if the budget is used up, but never beyond MAX_BUDGET per Run() call.
+  //
+  // Feedback scheduled during a Run() call is executed in the next one, after the Run() interval and the work which
+  // precedes feedback there (see setWorkBeforeFeedback()). Background tasks are therefore stopped as soon as the Run()
+  // call has taken as long as the feedback latency target minus both. If the Run() interval alone exceeds the target,
+  // background tasks wait until it doesn't anymore.
+  //
+  // Any thread may schedule tasks, everything else except the setters is main thread only.
+  class MainThreadScheduler {
+  public:
+    static constexpr std::size_t PRIORITY_COUNT = 3;
+    // Fraction of the measured Run() interval available as budget, within MIN_BUDGET and MAX_BUDGET
+    static constexpr double BUDGET_FRACTION = 0.5;
+    static constexpr std::chrono::microseconds MIN_BUDGET{2000};
+    static constexpr std::chrono::microseconds MAX_BUDGET{50000};
+    static constexpr std::chrono::microseconds DEFAULT_FEEDBACK_LATENCY_TARGET{50000};
+
+    MainThreadScheduler();
+
+    MainThreadScheduler(const MainThreadScheduler&) = delete;
+
+    MainThreadScheduler& operator=(const MainThreadScheduler&) = delete;
+
+    // Any thread
+    template<typename F>
+    void schedule(MainThreadPriority priority, F&& task) {
+      inbound_[index(priority)].enqueue(Entry{MainThreadTask(std::forward<F>(task)), Clock::now()});
+    }
+
+    // Maximum waiting time after which a task is executed regardless of the budget. Defaults are 0 for feedback
+    // (always executed in the next Run() call), 100 ms for user actions and 1 s for background tasks. Any thread.
+    void setDeadline(MainThreadPriority priority, std::chrono::microseconds deadline);
+
+    std::chrono::microseconds deadline(MainThreadPriority priority) const;
+
+    // Any thread
+    void setFeedbackLatencyTarget(std::chrono::microseconds target);
+
+    std::chrono::microseconds feedbackLatencyTarget() const;
+
+    // Upper limit of the time spent in Run() before feedback tasks get executed (e.g. the fast command queue budget).
+    // Defaults to 0. Any thread.
+    void setWorkBeforeFeedback(std::chrono::microseconds duration);
+
+    std::chrono::microseconds workBeforeFeedback() const;
+
+    // Called at the beginning of Run(). Measures the interval since the last call and takes over scheduled tasks.
+    void beginRun();
+
+    // Executes pending tasks of the given class in schedule order as long as mayRun() allows. Exceptions are logged.
+    void runPending(MainThreadPriority priority);
+
+    // Whether work of the given class which has been waiting since the given time may still be done in the current
+    // Run() call. Also meant for work which isn't scheduled here (e.g. the rx run loop).
+    bool mayRun(MainThreadPriority priority, std::chrono::steady_clock::time_point waitingSince) const;
+
+    // Smoothed interval between beginRun() calls
+    std::chrono::microseconds runInterval() const;
+
+    // Budget of the current Run() call
+    std::chrono::microseconds budget() const;
+
+    // Tasks taken over by beginRun() but not executed yet
+    std::size_t pendingCount(MainThreadPriority priority) const;
+
+    std::uint64_t executedCount(MainThreadPriority priority) const;
+
+    // Longest time from schedule() to execution so far
+    std::chrono::microseconds maxLatency(MainThreadPriority priority) const;
+
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+      MainThreadTask task;
+      Clock::time_point scheduleTime;
+    };
+
+    struct Statistics {
+      std::uint64_t executedCount = 0;
+      std::chrono::microseconds maxLatency{0};
+    };
+
+    std::array<moodycamel::ConcurrentQueue<Entry>, PRIORITY_COUNT> inbound_;
+    std::array<std::atomic<std::int64_t>, PRIORITY_COUNT> deadlineMicros_;
+    std::atomic<std::int64_t> feedbackLatencyTargetMicros_{DEFAULT_FEEDBACK_LATENCY_TARGET.count()};
+    std::atomic<std::int64_t> workBeforeFeedbackMicros_{0};
+    // Main thread only from here on
+    std::array<std::deque<Entry>, PRIORITY_COUNT> pending_;
+    std::array<Statistics, PRIORITY_COUNT> statistics_;
+    // Receives dequeued entries before they are appended to pending_
+    std::array<Entry, MainThreadTaskQueue::BATCH_SIZE> batch_;
+    Clock::time_point runStart_;
+    bool hasRunBefore_ = false;
+    std::chrono::microseconds runInterval_;
+    std::chrono::microseconds budget_;
+
+    static std::size_t index(MainThreadPriority priority);
+  };
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <concurrentqueue/concurrentqueue.h>
+#include "util/InlineTask.h"
+
+namespace reaplus {
+  // Enough for an Fx or a Track plus an rx subscriber. Bigger captures are rejected at compile time, move them into a
+  // std::shared_ptr in that case.
+  using MainThreadTask = util::InlineTask<128>;
+
+  // Unbounded lock-free queue of tasks to be executed in the main thread. Any thread may push, only the main thread runs
+  // tasks. Tasks don't allocate by themselves, the queue allocates only when it needs to grow.
+  class MainThreadTaskQueue {
+  public:
+    // Tasks dequeued in one go
+    static constexpr std::size_t BATCH_SIZE = 32;
+
+    MainThreadTaskQueue();
+
+    // Preallocates room for about the given number of tasks
+    explicit MainThreadTaskQueue(std::size_t initialCapacity);
+
+    MainThreadTaskQueue(const MainThreadTaskQueue&) = delete;
+
+    MainThreadTaskQueue& operator=(const MainThreadTaskQueue&) = delete;
+
+    // Any thread
+    template<typename F>
+    void push(F&& task) {
+      tasks_.enqueue(Entry{MainThreadTask(std::forward<F>(task)), std::chrono::steady_clock::now()});
+    }
+
+    // Main thread only. Executes tasks in push order (per pushing thread) until the queue is empty or the budget is used
+    // up and returns the number of executed tasks. The budget is checked after each batch, so at least one batch is
+    // executed per call. Exceptions thrown by tasks are logged.
+    std::size_t runFor(std::chrono::microseconds budget);
+
+    // Approximate
+    std::size_t size() const;
+
+    std::uint64_t executedCount() const;
+
+    // Sum of the tasks which were still waiting when runFor() ran out of budget
+    std::uint64_t deferredCount() const;
+
+    // Time from push() to execution, averaged over all executed tasks
+    std::chrono::microseconds averageLatency() const;
+
+    std::chrono::microseconds maxLatency() const;
+
+  private:
+    struct Entry {
+      MainThreadTask task;
+      std::chrono::steady_clock::time_point pushTime;
+    };
+
+    moodycamel::ConcurrentQueue<Entry> tasks_;
+    // Main thread only, kept in order to avoid reallocating it on each run
+    std::array<Entry, BATCH_SIZE> batch_;
+    std::atomic<std::uint64_t> executedCount_{0};
+    std::atomic<std::uint64_t> deferredCount_{0};
+    std::atomic<std::int64_t> totalLatencyMicros_{0};
+    std::atomic<std::int64_t> maxLatencyMicros_{0};
+  };
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace reaplus {
+  enum class CapturedMidiEventKind : unsigned char {
+    // Short message as received
+    Raw,
+    // Assembled from several control change messages (see HighResolutionMidiAssembler)
+    ControlChange14Bit,
+    Nrpn7Bit,
+    Nrpn14Bit,
+    Rpn7Bit,
+    Rpn14Bit,
+    // Message is in a SysExPool buffer (number = buffer index, value = size)
+    SysEx
+  };
+
+  // Short MIDI message as captured in the audio thread
+  struct CapturedMidiEvent {
+    int inputDeviceId;
+    int frameOffset;
+    unsigned char status;
+    unsigned char data1;
+    unsigned char data2;
+    CapturedMidiEventKind kind;
+    // Only for assembled events: Controller or parameter number and value
+    std::uint16_t number;
+    std::uint16_t value;
+    // Audio block in which the event was captured, so consumers can regroup events by block
+    std::uint64_t blockIndex;
+    // Absolute position in samples since ReaPlus was initialized (block start + frame offset converted to samples)
+    std::uint64_t samplePosition;
+    // Sample rate of the block, 0 if unknown
+    double sampleRate;
+  };
+
+  static_assert(std::is_trivially_copyable<CapturedMidiEvent>::value, "Events are copied into a ring buffer");
+
+  // Bounded single-producer single-consumer ring of captured MIDI events. Producer is the audio hook, consumer is one
+  // other thread (by default the main thread). Storage is allocated at construction, so push() never allocates and
+  // completes in a bounded number of steps.
+  class MidiCaptureRing {
+  public:
+    // Capacity is rounded up to the next power of two
+    explicit MidiCaptureRing(std::size_t capacity);
+
+    MidiCaptureRing(const MidiCaptureRing&) = delete;
+
+    MidiCaptureRing& operator=(const MidiCaptureRing&) = delete;
+
+    // Producer only. Returns false and counts an overflow if the ring is full.
+    bool push(const CapturedMidiEvent& event) {
+      const auto writeIndex = writeIndex_.load(std::memory_order_relaxed);
+      const auto readIndex = readIndex_.load(std::memory_order_acquire);
+      const auto occupancy = writeIndex - readIndex;
+      if (occupancy > mask_) {
+        // Only the producer writes these, so no read-modify-write needed
+        overflowCount_.store(overflowCount_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+      }
+      slots_[writeIndex & mask_] = event;
+      writeIndex_.store(writeIndex + 1, std::memory_order_release);
+      if (occupancy + 1 > highWaterMark_.load(std::memory_order_relaxed)) {
+        highWaterMark_.store(occupancy + 1, std::memory_order_relaxed);
+      }
+      return true;
+    }
+
+    // Consumer only. Passes all events pushed so far to the consumer in push order and returns their number.
+    template<typename Consumer>
+    std::size_t drain(Consumer consume) {
+      auto readIndex = readIndex_.load(std::memory_order_relaxed);
+      const auto writeIndex = writeIndex_.load(std::memory_order_acquire);
+      const auto count = writeIndex - readIndex;
+      for (; readIndex != writeIndex; readIndex++) {
+        consume(slots_[readIndex & mask_]);
+      }
+      readIndex_.store(readIndex, std::memory_order_release);
+      return count;
+    }
+
+    std::size_t capacity() const;
+
+    // Exact only if called from producer or consumer
+    std::size_t size() const;
+
+    // Number of events dropped because the consumer didn't keep up
+    std::uint64_t overflowCount() const;
+
+    // Highest number of events which were waiting in the ring at once
+    std::size_t highWaterMark() const;
+
+  private:
+    std::vector<CapturedMidiEvent> slots_;
+    std::size_t mask_;
+    // Separate cache lines so producer and consumer don't invalidate each other's line on each access
+    alignas(64) std::atomic<std::size_t> writeIndex_{0};
+    std::atomic<std::uint64_t> overflowCount_{0};
+    std::atomic<std::size_t> highWaterMark_{0};
+    alignas(64) std::atomic<std::size_t> readIndex_{0};
+  };
+}
@@ -3,6 +3,8 @@
 #include <string>
 
 namespace reaplus {
+  struct MidiInputDeviceInfo;
+
   // DONE-rust
   class MidiInputDevice {
   private:
@@ -14,11 +16,12 @@ namespace reaplus {
     // DONE-rust
     int id() const;
 
+    // In the main thread this comes from the device snapshot (see Reaper::midiInputDeviceSnapshot())
     // DONE-rust
     std::string name() const;
 
     // For REAPER < 5.94 this is the same like isConnected(). For REAPER >=5.94 it returns true if the device ever
-    // existed, even if it's disconnected now.
+    // existed, even if it's disconnected now. In the main thread this consults the device snapshot first.
     // DONE-rust
     bool isAvailable() const;
 
@@ -31,6 +34,10 @@ namespace reaplus {
 
     // DONE-rust
     friend bool operator!=(const MidiInputDevice& lhs, const MidiInputDevice& rhs);
+
+  private:
+    // nullptr if not in the main thread or not in the snapshot
+    const MidiInputDeviceInfo* findInSnapshot() const;
   };
 }
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace reaplus {
+  struct MidiInputDeviceInfo {
+    int id;
+    std::string name;
+    bool connected;
+  };
+
+  // Immutable picture of the MIDI input devices which REAPER knows at a certain point in time. Taken in the main
+  // thread and handed to the audio hook, so the hook only has to look at devices which actually exist.
+  class MidiInputDeviceSnapshot {
+  public:
+    // Empty
+    MidiInputDeviceSnapshot() = default;
+
+    // Main thread only
+    static MidiInputDeviceSnapshot capture();
+
+    // Available devices (connected or known from earlier), ordered by ID
+    const std::vector<MidiInputDeviceInfo>& devices() const;
+
+    // IDs of the connected devices, ordered
+    const std::vector<int>& connectedDeviceIds() const;
+
+    // nullptr if the device is not available
+    const MidiInputDeviceInfo* findDevice(int id) const;
+
+    friend bool operator==(const MidiInputDeviceSnapshot& lhs, const MidiInputDeviceSnapshot& rhs);
+
+    friend bool operator!=(const MidiInputDeviceSnapshot& lhs, const MidiInputDeviceSnapshot& rhs);
+
+  private:
+    std::vector<MidiInputDeviceInfo> devices_;
+    std::vector<int> connectedDeviceIds_;
+  };
+}
@@ -2,6 +2,8 @@
 
 #include <reaper_plugin.h>
 #include <string>
+#include <cstddef>
+#include <cstdint>
 #include <helgoboss-midi/MidiMessage.h>
 
 namespace reaplus {
@@ -28,9 +30,17 @@ namespace reaplus {
     // DONE-rust
     bool isConnected() const;
 
+    // Sends immediately from the current thread
     // TODO-rust
     void send(const helgoboss::MidiMessage& message, int frameOffset) const;
 
+    // Sends from the audio hook in the block containing the given sample position (0 = as soon as possible). Returns
+    // false if the message was dropped. See MidiOutputScheduler.
+    bool schedule(const helgoboss::MidiMessage& message, std::uint64_t samplePosition = 0) const;
+
+    // Data must contain the complete message including F0 and F7
+    bool scheduleSysEx(const unsigned char* data, std::size_t size, std::uint64_t samplePosition = 0) const;
+
     // DONE-rust
     friend bool operator==(const MidiOutputDevice& lhs, const MidiOutputDevice& rhs);
 
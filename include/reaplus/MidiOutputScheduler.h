@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "util/BoundedQueue.h"
+
+namespace reaplus {
+  // Queues outgoing MIDI messages per output device and sends them from the audio hook, each one in the audio block
+  // which contains its sample position (same time base as Reaper::sampleCounter()). Any thread may schedule messages.
+  // Queues and SysEx buffers of a device are allocated when the first message for it is scheduled, after that neither
+  // scheduling nor sending allocates. Messages for one device should be scheduled in time order because a message
+  // which is not due yet holds back the ones behind it.
+  class MidiOutputScheduler {
+  public:
+    static constexpr int MAX_DEVICE_COUNT = 64;
+    static constexpr std::size_t QUEUE_CAPACITY_PER_DEVICE = 1024;
+    static constexpr std::size_t SYSEX_BUFFER_COUNT_PER_DEVICE = 16;
+    static constexpr std::size_t MAX_SYSEX_SIZE = 1024;
+    // Sample position for "as soon as possible"
+    static constexpr std::uint64_t NOW = 0;
+
+    MidiOutputScheduler();
+
+    ~MidiOutputScheduler();
+
+    MidiOutputScheduler(const MidiOutputScheduler&) = delete;
+
+    MidiOutputScheduler& operator=(const MidiOutputScheduler&) = delete;
+
+    // Returns false (and counts a drop) if the device ID is out of range or the device queue is full
+    bool scheduleShortMessage(int deviceId, unsigned char status, unsigned char data1, unsigned char data2,
+        std::uint64_t samplePosition = NOW);
+
+    // Data must contain the complete message including F0 and F7. Returns false (and counts a drop) if it's bigger than
+    // MAX_SYSEX_SIZE, all SysEx buffers of the device are in use or the device queue is full.
+    bool scheduleSysEx(int deviceId, const unsigned char* data, std::size_t size, std::uint64_t samplePosition = NOW);
+
+    // Limits the number of bytes sent to the device per second, 0 means unlimited (default). Slow devices (e.g. DIN
+    // MIDI at 3125 bytes per second) lose messages if they receive more than they can handle.
+    void setRateLimit(int deviceId, double bytesPerSecond);
+
+    // Audio thread only. Sends everything which is due within the given block and allowed by the rate limit.
+    void process(std::uint64_t blockStartSamplePosition, int blockLength, double sampleRate);
+
+    std::uint64_t sentCount() const;
+
+    std::uint64_t droppedCount() const;
+
+    // Number of times a device had due messages left at the end of a block because of its rate limit
+    std::uint64_t rateLimitedCount() const;
+
+  private:
+    struct OutgoingMessage {
+      std::uint64_t samplePosition;
+      // -1 for short messages
+      int sysExBufferIndex;
+      unsigned char status;
+      unsigned char data1;
+      unsigned char data2;
+    };
+
+    struct DeviceQueue;
+
+    std::array<std::atomic<DeviceQueue*>, MAX_DEVICE_COUNT> deviceQueues_;
+    std::atomic<std::uint64_t> sentCount_{0};
+    std::atomic<std::uint64_t> droppedCount_{0};
+    std::atomic<std::uint64_t> rateLimitedCount_{0};
+
+    DeviceQueue* getOrCreateDeviceQueue(int deviceId);
+
+    bool schedule(int deviceId, const OutgoingMessage& message);
+
+    void processDevice(int deviceId, DeviceQueue& queue, std::uint64_t blockStartSamplePosition, int blockLength,
+        double sampleRate);
+  };
+}
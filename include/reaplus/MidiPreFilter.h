@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace reaplus {
+  // Incoming MIDI events a subscriber wants to receive. The default matches everything.
+  struct MidiInterest {
+    static constexpr int ANY_DEVICE = -1;
+
+    int inputDeviceId = ANY_DEVICE;
+    // Status byte without channel for channel messages (e.g. 0xb0 for CC), complete status byte for system messages
+    unsigned char minType = 0x80;
+    unsigned char maxType = 0xff;
+    // Bit n set = channel n. Only applies to channel messages.
+    std::uint16_t channelMask = 0xffff;
+    unsigned char minData1 = 0;
+    unsigned char maxData1 = 127;
+
+    bool matches(int deviceId, unsigned char status, unsigned char data1) const;
+  };
+
+  // Lookup table compiled from the interests of all subscribers, evaluated by the audio hook before capturing an
+  // event. Conservative: Lets through every event which some interest matches, but might also let through events
+  // which combine the device of one interest with the data byte of another. Subscribers therefore still match
+  // exactly.
+  class MidiPreFilter {
+  public:
+    static constexpr int MAX_DEVICE_COUNT = 64;
+
+    // Matches nothing
+    MidiPreFilter();
+
+    static MidiPreFilter compile(const std::vector<MidiInterest>& interests);
+
+    bool matchesNothing() const;
+
+    // Called in the audio thread for each event, therefore inline
+    bool matches(int deviceId, unsigned char status, unsigned char data1) const {
+      const auto& entry = entries_[status];
+      const bool deviceMatches = deviceId >= 0 && deviceId < MAX_DEVICE_COUNT
+                                 ? ((entry.deviceMask >> deviceId) & 1) != 0
+                                 : entry.matchesOtherDevices;
+      return deviceMatches && ((entry.data1Mask[(data1 >> 6) & 1] >> (data1 & 63)) & 1) != 0;
+    }
+
+  private:
+    struct Entry {
+      std::uint64_t deviceMask;
+      // Devices with an ID >= MAX_DEVICE_COUNT
+      bool matchesOtherDevices;
+      std::uint64_t data1Mask[2];
+    };
+    // Indexed by status byte
+    std::array<Entry, 256> entries_;
+    bool matchesNothing_;
+
+    void add(const MidiInterest& interest);
+  };
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <reaper_plugin.h>
+#include <memory>
+#include "Parameter.h"
+
+namespace reaplus {
+  // Small value-type reference to a parameter of any ParameterType. Creating and copying it never allocates, which
+  // makes it suitable for high-frequency change notifications. Like index-based Fx and TrackSend objects, it refers
+  // to FX and sends by position, so it's meant to be consumed right away. Use toParameter() to get a full Parameter.
+  class ParameterRef {
+  public:
+    static ParameterRef fxParameter(MediaTrack* mediaTrack, bool isInputFx, int fxIndex, int paramIndex);
+
+    static ParameterRef fxEnable(MediaTrack* mediaTrack, bool isInputFx, int fxIndex);
+
+    static ParameterRef fxPreset(MediaTrack* mediaTrack, bool isInputFx, int fxIndex);
+
+    // For TrackVolume, TrackPan, TrackArm, TrackSelection, TrackMute and TrackSolo
+    static ParameterRef trackParameter(ParameterType type, MediaTrack* mediaTrack);
+
+    // For TrackSendVolume and TrackSendPan
+    static ParameterRef trackSendParameter(ParameterType type, MediaTrack* mediaTrack, int sendIndex);
+
+    static ParameterRef masterTempo();
+
+    static ParameterRef masterPlayrate();
+
+    // Action in main section
+    static ParameterRef action(int commandId);
+
+    ParameterType parameterType() const;
+
+    bool isTrackParameter() const;
+
+    // nullptr if not a track parameter
+    MediaTrack* mediaTrack() const;
+
+    bool isInputFx() const;
+
+    // -1 if not an FX-related parameter
+    int fxIndex() const;
+
+    // -1 if not an FX parameter
+    int paramIndex() const;
+
+    // -1 if not a send parameter
+    int sendIndex() const;
+
+    // 0 if not an action
+    int commandId() const;
+
+    // Allocates. Returns nullptr if the referenced FX doesn't exist (anymore).
+    std::unique_ptr<Parameter> toParameter() const;
+
+    friend bool operator==(const ParameterRef& lhs, const ParameterRef& rhs);
+
+    friend bool operator!=(const ParameterRef& lhs, const ParameterRef& rhs);
+
+  private:
+    ParameterType type_;
+    bool isInputFx_;
+    // FX index, send index or command ID
+    int index_;
+    // FX parameter index
+    int subIndex_;
+    MediaTrack* mediaTrack_;
+
+    ParameterRef(ParameterType type, MediaTrack* mediaTrack, bool isInputFx, int index, int subIndex);
+  };
+}
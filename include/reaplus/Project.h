@@ -4,6 +4,7 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <rxcpp/rx.hpp>
 #include <boost/optional.hpp>
 #include <helgoboss-learn/Tempo.h>
@@ -94,5 +95,17 @@ namespace reaplus {
     // DONE-rust
     void complainIfNotAvailable() const;
   };
-}
 
+  // Position change of one track within its project
+  struct TrackMove {
+    int fromIndex;
+    int toIndex;
+  };
+
+  // Contains all tracks whose position relative to the other tracks changed. Tracks which merely shifted because of
+  // added or removed tracks are not included.
+  struct TrackListReordering {
+    Project project;
+    std::vector<TrackMove> moves;
+  };
+}
@@ -6,6 +6,11 @@
 #include <thread>
 #include <memory>
 #include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
 #include <reaper_plugin.h>
 #include <rxcpp/rx.hpp>
 #include <boost/optional.hpp>
@@ -13,19 +18,42 @@
 #include "AutomationMode.h"
 #include <helgoboss-midi/MidiMessage.h>
 #include "Guid.h"
+#include "ValueChange.h"
+#include "ControlSurfaceEventBus.h"
+#include "FxParameterShadowTable.h"
+#include "MidiCaptureRing.h"
+#include "MidiPreFilter.h"
+#include "MidiInputDeviceSnapshot.h"
+#include "IncomingMidiEventBlock.h"
+#include "IncomingHighResolutionMidiEvent.h"
+#include "HighResolutionMidiAssembler.h"
+#include "IncomingSysExEvent.h"
+#include "SysExPool.h"
+#include "AudioTaskQueue.h"
+#include "MainThreadTaskQueue.h"
+#include "MainThreadScheduler.h"
+#include "TimerWheel.h"
+#include "Awaitables.h"
+#include "WorkerPool.h"
+#include "MidiOutputScheduler.h"
+#include "HardwareMeter.h"
 #include "util/rx-relaxed-runloop.hpp"
+#include "util/RcuCell.h"
 
 namespace reaplus {
   class Action;
   class FxParameter;
   class Project;
+  struct TrackListReordering;
   class Section;
   class MidiInputDevice;
   class MidiOutputDevice;
   class IncomingMidiEvent;
   class Parameter;
+  class ParameterRef;
   class TrackSend;
   class Fx;
+  struct FxChainReordering;
   class Track;
 
   // DONE-rust
@@ -66,6 +94,7 @@ namespace reaplus {
 
   class Reaper {
     friend class RegisteredAction;
+    friend class HelperControlSurface;
 
   private:
     // TODO-rust
@@ -124,11 +153,41 @@ namespace reaplus {
     // TODO-rust
     std::vector<ProjectConfigExtension> projectConfigExtensions_;
     // DONE-rust
-    rxcpp::subjects::subject<IncomingMidiEvent> incomingMidiEventsSubject_;
+    rxcpp::subjects::subject<CapturedMidiEvent> capturedMidiEventsSubject_;
+    rxcpp::subjects::subject<IncomingMidiEventBlock> incomingMidiEventBlocksSubject_;
+    rxcpp::subjects::subject<IncomingHighResolutionMidiEvent> incomingHighResolutionMidiEventsSubject_;
+    // Audio thread only, active while there are incomingHighResolutionMidiEvents() subscriptions
+    HighResolutionMidiAssembler highResolutionMidiAssembler_;
+    mutable std::atomic<int> highResolutionMidiSubscriptionCount_{0};
+    rxcpp::subjects::subject<IncomingSysExEvent> incomingSysExEventsSubject_;
+    // Filled by the audio hook while there are incomingSysExEvents() subscriptions
+    SysExPool sysExPool_;
+    mutable std::atomic<int> sysExSubscriptionCount_{0};
+    // Reused for each emitted block
+    std::vector<IncomingMidiEvent> midiEventBlockBuffer_;
+    // Filled by the audio hook, drained in the main thread
+    MidiCaptureRing midiCaptureRing_;
+    // Compiled from the interests of all incomingMidiEvents() subscriptions, read by the audio hook
+    mutable util::RcuCell<MidiPreFilter> midiPreFilter_;
+    // Guards the interests and publishing of the pre-filter (subscriptions could be made from any thread)
+    mutable std::mutex midiInterestsMutex_;
+    mutable std::unordered_map<std::uint64_t, std::vector<MidiInterest>> midiInterestsBySubscription_;
+    mutable std::uint64_t nextMidiInterestsSubscriptionId_ = 0;
+    // Replaced by the main thread whenever the devices change, read by the audio hook
+    util::RcuCell<MidiInputDeviceSnapshot> midiInputDeviceSnapshot_;
     // DONE-rust
     rxcpp::subjects::subject<Action> actionInvokedSubject_;
     // TODO-rust
-    uint64_t sampleCounter_ = 0;
+    // Written by the audio hook, read by any thread (e.g. for MidiOutputScheduler positions)
+    std::atomic<std::uint64_t> sampleCounter_{0};
+    std::uint64_t audioBlockCounter_ = 0;
+    AudioTaskQueue audioTaskQueue_;
+    std::atomic<std::int64_t> audioTaskBudgetMicros_;
+    MidiOutputScheduler midiOutputScheduler_;
+    // Fed by the post audio hook
+    HardwareMeter hardwareMeter_;
+    // Shut down first thing on destruction, so workers can't deliver results to a half-destroyed instance
+    WorkerPool workerPool_;
     rxcpp::schedulers::relaxed_run_loop audioThreadRunLoop_;
     rxcpp::observe_on_one_worker audioThreadCoordination_ =
         rxcpp::observe_on_one_worker(rxcpp::schedulers::make_relaxed_run_loop(audioThreadRunLoop_));
@@ -199,9 +258,39 @@ namespace reaplus {
     // DONE-rust
     Guid generateGuid() const;
 
+    // Events are captured in the audio thread but emitted in the main thread (once per control surface Run() cycle)
     // DONE-rust
     rxcpp::observable<IncomingMidiEvent> incomingMidiEvents() const;
 
+    // Only emits events matching at least one of the given interests. Events which no subscription is interested in
+    // are already rejected in the audio thread.
+    rxcpp::observable<IncomingMidiEvent> incomingMidiEvents(std::vector<MidiInterest> interests) const;
+
+    // Like incomingMidiEvents() but emits all events of one audio block at once, which is cheaper than emitting them
+    // one by one if there's a lot of traffic. Blocks without events are not emitted.
+    rxcpp::observable<IncomingMidiEventBlock> incomingMidiEventBlocks() const;
+
+    // 14-bit control changes, NRPN and RPN values assembled in the audio thread from incoming control change messages.
+    // Emitted in the main thread in addition to (not instead of) the raw messages in incomingMidiEvents().
+    rxcpp::observable<IncomingHighResolutionMidiEvent> incomingHighResolutionMidiEvents() const;
+
+    // Complete SysEx messages, emitted in the main thread. They are not part of incomingMidiEvents(). Messages which
+    // don't fit into a pool buffer or arrive while all buffers are in use are dropped (see sysExPool()).
+    rxcpp::observable<IncomingSysExEvent> incomingSysExEvents() const;
+
+    // For statistics (free buffers, dropped messages)
+    const SysExPool& sysExPool() const;
+
+    // Devices as of the last refresh. Main thread only.
+    const MidiInputDeviceSnapshot& midiInputDeviceSnapshot() const;
+
+    // Re-reads the MIDI input devices from REAPER and hands them to the audio hook if they changed. Happens
+    // automatically about once per second. Main thread only.
+    void refreshMidiInputDevices();
+
+    // For statistics (overflows, high-water mark). Don't drain it, ReaPlus does that for incomingMidiEvents().
+    const MidiCaptureRing& midiCaptureRing() const;
+
     // It's correct that this method returns an optional because the index isn't a stable identifier of a project.
     // The project could move. So this should do a runtime lookup of the project and return a stable ReaProject-backed
     // Project object if a project exists at that index.
@@ -244,10 +333,19 @@ namespace reaplus {
     // DONE-rust
     Action actionByCommandName(std::string commandName) const;
 
+    // Allocation-free notification of parameter changes
+    rxcpp::observable<ParameterRef> parameterValueChanged() const;
+
+    rxcpp::observable<ParameterRef> parameterTouched() const;
+
+    // Caller takes ownership of the emitted Parameter. Prefer parameterValueChanged(), which doesn't allocate.
     rxcpp::observable<Parameter*> parameterValueChangedUnsafe() const;
 
+    // Caller takes ownership of the emitted Parameter. Prefer parameterTouched(), which doesn't allocate.
     rxcpp::observable<Parameter*> parameterTouchedUnsafe() const;
 
+    // Also fires if REAPER reports a value which didn't change. parameterValueChanged() and
+    // fxParameterValueChangedCoalesced() only fire for actual changes.
     rxcpp::observable<FxParameter> fxParameterValueChanged() const;
 
     rxcpp::observable<FxParameter> fxParameterTouched() const;
@@ -303,6 +401,9 @@ namespace reaplus {
     // TODO-rust
     rxcpp::observable<Project> tracksReordered() const;
 
+    // Like tracksReordered() but tells which tracks moved where
+    rxcpp::observable<TrackListReordering> trackListReordered() const;
+
     // DONE-rust
     rxcpp::observable<Fx> fxAdded() const;
 
@@ -318,6 +419,9 @@ namespace reaplus {
     // TODO-rust
     rxcpp::observable<Track> fxReordered() const;
 
+    // Like fxReordered() but tells which FX moved where
+    rxcpp::observable<FxChainReordering> fxChainReordered() const;
+
     // DONE-rust
     rxcpp::observable<Track> trackInputMonitoringChanged() const;
 
@@ -366,18 +470,101 @@ namespace reaplus {
     // TODO-rust
     rxcpp::observable<bool> mainThreadIdle() const;
 
+    // The following are opt-in alternatives to the corresponding *Changed() observables. Changes are gathered per
+    // target and delivered at most once per control surface Run() cycle (in the main thread), carrying the latest
+    // value. Nothing is gathered as long as nobody subscribes.
+
+    // Value is normalized
+    rxcpp::observable<ValueChange<FxParameter>> fxParameterValueChangedCoalesced() const;
+
+    // Value is the REAPER volume value (as passed to SetSurfaceVolume)
+    rxcpp::observable<ValueChange<Track>> trackVolumeChangedCoalesced() const;
+
+    // Value is the REAPER pan value (as passed to SetSurfacePan)
+    rxcpp::observable<ValueChange<Track>> trackPanChangedCoalesced() const;
+
+    // Value is the REAPER send volume value
+    rxcpp::observable<ValueChange<TrackSend>> trackSendVolumeChangedCoalesced() const;
+
+    // Value is the REAPER send pan value
+    rxcpp::observable<ValueChange<TrackSend>> trackSendPanChangedCoalesced() const;
+
+    // Low-level access to the events behind all of the above observables. Main thread only. Listeners receive compact
+    // events and should resolve tracks, FX etc. lazily if at all.
+    ControlSurfaceEventBus& controlSurfaceEventBus();
+
+    // Last reported FX parameter values. Feedback engines can remember sequence() and later ask for everything that
+    // changed since then via forEachChangedSince(). Main thread only.
+    const FxParameterShadowTable& fxParameterShadowTable() const;
+
     rxcpp::composite_subscription executeLaterInMainThread(std::function<void(void)> command);
 
+    // Captures are stored inline (see MainThreadTask), so this doesn't allocate unless the queue needs to grow
     // DONE-rust
-    void executeLaterInMainThreadFast(std::function<void(void)> command);
+    void executeLaterInMainThreadFast(MainThreadTask command);
+
+    // For statistics (queue depth, latency from enqueue to execution)
+    const MainThreadTaskQueue& mainThreadTaskQueue() const;
+
+    // Executes the task in one of the next Run() cycles of the main thread, depending on its priority. See
+    // MainThreadScheduler.
+    void executeLaterInMainThread(MainThreadPriority priority, MainThreadTask task);
+
+    // For configuring deadlines and the feedback latency target and for statistics
+    MainThreadScheduler& mainThreadScheduler();
+
+    // Executes the task in the main thread as soon as the delay has passed (1 ms resolution, rounded up to the next
+    // Run() cycle). Cheap enough for thousands of short timeouts. The handle can be passed to timerWheel().cancel().
+    // Not real-time safe, so not from the audio thread.
+    TimerHandle executeLaterInMainThread(std::chrono::steady_clock::duration delay, MainThreadTask task);
+
+    TimerWheel& timerWheel();
+
+    // For C++20 coroutines: co_await mainThread() continues in the main thread (immediately if already there)
+    MainThreadAwaitable mainThread() const;
+
+    // co_await nextRunCycle() continues in the main thread at the beginning of the next Run() cycle
+    NextRunCycleAwaitable nextRunCycle() const;
+
+    // co_await audioBlock() continues in the audio thread at the beginning of the next audio block
+    AudioBlockAwaitable audioBlock() const;
+
+    // Executes pure CPU work in a worker thread, e.g. parsing a chunk which has been fetched before. The work must not
+    // call REAPER functions. The result is delivered to the main thread via the returned future.
+    template<typename F>
+    WorkerFuture<std::invoke_result_t<F>> executeInWorkerThread(F&& work) {
+      return workerPool_.submit(std::forward<F>(work));
+    }
+
+    WorkerPool& workerPool();
 
     // DONE-rust (without subscription)
     rxcpp::composite_subscription executeWhenInMainThread(std::function<void(void)> command);
 
     const rxcpp::observe_on_one_worker& mainThreadCoordination() const;
 
+    // Executes at most one scheduled item per audio block and skips the block if the run loop is busy. Use
+    // executeLaterInAudioThread() for anything real-time relevant.
     const rxcpp::observe_on_one_worker& audioThreadCoordination() const;
 
+    // Executes the task in the audio thread at the beginning of one of the next audio blocks, in push order. Doesn't
+    // lock or allocate, so it can be called from any thread. Returns false if the task queue is full, in which case
+    // the task is dropped.
+    bool executeLaterInAudioThread(AudioTask task);
+
+    // Time the audio hook may spend executing tasks per audio block. At least one task is executed per block anyway.
+    void setAudioTaskBudget(std::chrono::microseconds budget);
+
+    // For statistics (dropped, deferred, executed tasks)
+    const AudioTaskQueue& audioTaskQueue() const;
+
+    // Sends MIDI from the audio hook, rate-limited per device if desired. See also MidiOutputDevice::schedule().
+    MidiOutputScheduler& midiOutputScheduler();
+
+    // Peak/RMS levels of the hardware outputs, measured in the audio hook after REAPER's processing. Needs to be
+    // enabled first.
+    HardwareMeter& hardwareMeter();
+
     // Attention: Returns normal fx only, not input fx!
     // This is not reliable! After REAPER start no focused Fx can be found!
     // TODO-rust
@@ -395,6 +582,8 @@ namespace reaplus {
     // DONE-rust
     HWND mainWindow() const;
 
+    // Number of samples processed by the audio hook so far, the time base of IncomingMidiEvent::samplePosition().
+    // Any thread.
     // TODO-rust
     uint64_t sampleCounter() const;
 
@@ -424,7 +613,25 @@ namespace reaplus {
     static void beginLoadProjectState(bool isUndo, struct project_config_extension_t* reg);
     static void saveExtensionConfig(ProjectStateContext* ctx, bool isUndo, struct project_config_extension_t* reg);
     
-    static helgoboss::MidiMessage createMidiMessageFromEvent(const MIDI_event_t& event);
+    static helgoboss::MidiMessage createMidiMessageFromEvent(const CapturedMidiEvent& event);
+
+    static IncomingMidiEvent createIncomingMidiEvent(const CapturedMidiEvent& event);
+
+    static IncomingHighResolutionMidiEvent createIncomingHighResolutionMidiEvent(const CapturedMidiEvent& event);
+
+    IncomingSysExEvent createIncomingSysExEvent(const CapturedMidiEvent& event);
+
+    void emitMidiEventBlock(std::uint64_t blockIndex);
+
+    // Called by HelperControlSurface in the main thread
+    void emitCapturedMidiEvents();
+
+    std::uint64_t addMidiInterests(std::vector<MidiInterest> interests) const;
+
+    void removeMidiInterests(std::uint64_t subscriptionId) const;
+
+    // Requires midiInterestsMutex_
+    void publishMidiPreFilter() const;
   };
 }
 
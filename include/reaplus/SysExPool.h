@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "util/BoundedQueue.h"
+
+namespace reaplus {
+  // Fixed number of equally sized buffers for SysEx messages captured in the audio thread. The audio hook copies a
+  // message into a free buffer once, consumers read it from there and release the buffer when done. Storage is
+  // allocated at construction, so neither acquiring nor releasing allocates.
+  class SysExPool {
+  public:
+    SysExPool(std::size_t bufferCount, std::size_t bufferSize);
+
+    SysExPool(const SysExPool&) = delete;
+
+    SysExPool& operator=(const SysExPool&) = delete;
+
+    // Copies the message into a free buffer and returns its index. Returns -1 and counts it if the message doesn't
+    // fit into a buffer or all buffers are in use.
+    int acquire(const unsigned char* message, std::size_t size);
+
+    // Any thread. The buffer must have been acquired before.
+    void release(int bufferIndex);
+
+    const unsigned char* buffer(int bufferIndex) const;
+
+    std::size_t bufferCount() const;
+
+    std::size_t bufferSize() const;
+
+    // Approximate if called while other threads acquire or release
+    std::size_t freeBufferCount() const;
+
+    // Number of messages dropped because all buffers were in use
+    std::uint64_t exhaustedCount() const;
+
+    // Number of messages dropped because they were bigger than bufferSize()
+    std::uint64_t oversizedCount() const;
+
+  private:
+    std::size_t bufferCount_;
+    std::size_t bufferSize_;
+    std::unique_ptr<unsigned char[]> storage_;
+    util::BoundedQueue<int> freeBuffers_;
+    std::atomic<std::uint64_t> exhaustedCount_{0};
+    std::atomic<std::uint64_t> oversizedCount_{0};
+  };
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "MainThreadTaskQueue.h"
+
+namespace reaplus {
+  // Identifies a scheduled timer for cancellation. Stays invalid after the timer has fired or has been cancelled, even
+  // if its storage is reused.
+  class TimerHandle {
+  public:
+    TimerHandle() = default;
+
+  private:
+    friend class TimerWheel;
+
+    static constexpr std::uint32_t NO_INDEX = 0xffffffff;
+
+    std::uint32_t index_ = NO_INDEX;
+    // Unique across all timer wheels, 0 means invalid
+    std::uint64_t generation_ = 0;
+
+    TimerHandle(std::uint32_t index, std::uint64_t generation) : index_(index), generation_(generation) {
+    }
+  };
+
+  // Hierarchical timer wheel with 1 ms ticks: 4 levels of 64 slots each, so timers up to about 4.6 hours are placed
+  // directly and longer ones are placed again when their slot comes up. Scheduling and cancelling are O(1), advance()
+  // does constant work per elapsed tick plus the fired timers. Timer storage is reused, so nothing allocates once the
+  // wheel has seen the maximum number of pending timers.
+  //
+  // Any thread may schedule and cancel, but both lock and scheduling may allocate, so not from the audio thread. Tasks
+  // are executed by advance(), which in ReaPlus is called by HelperControlSurface::Run() in the main thread.
+  class TimerWheel {
+  public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr std::size_t LEVEL_COUNT = 4;
+    static constexpr std::size_t SLOT_COUNT_PER_LEVEL = 64;
+
+    explicit TimerWheel(Clock::time_point start = Clock::now());
+
+    TimerWheel(const TimerWheel&) = delete;
+
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    TimerHandle schedule(Clock::duration delay, MainThreadTask task);
+
+    // Timers which are already due fire with the next advance()
+    TimerHandle scheduleAt(Clock::time_point dueTime, MainThreadTask task);
+
+    // Returns false if the timer has already fired or has been cancelled
+    bool cancel(TimerHandle handle);
+
+    bool isPending(TimerHandle handle) const;
+
+    // Executes all timers due at the given time, in due order (timers of the same tick in schedule order). Exceptions
+    // are logged. Returns the number of fired timers. Must not be called concurrently with itself.
+    std::size_t advance(Clock::time_point now);
+
+    // Number of pending timers
+    std::size_t size() const;
+
+  private:
+    static constexpr std::uint32_t NO_INDEX = TimerHandle::NO_INDEX;
+    // Holds timers which were already due when scheduled
+    static constexpr std::size_t OVERDUE_SLOT = LEVEL_COUNT * SLOT_COUNT_PER_LEVEL;
+    static constexpr std::size_t SLOT_COUNT = OVERDUE_SLOT + 1;
+
+    struct Node {
+      MainThreadTask task;
+      std::uint64_t dueTick = 0;
+      // 0 if free
+      std::uint64_t generation = 0;
+      std::uint32_t slot = 0;
+      std::uint32_t previous = NO_INDEX;
+      std::uint32_t next = NO_INDEX;
+    };
+
+    Clock::time_point start_;
+    mutable std::mutex mutex_;
+    std::uint64_t currentTick_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> freeIndexes_;
+    std::array<std::uint32_t, SLOT_COUNT> heads_;
+    std::array<std::uint32_t, SLOT_COUNT> tails_;
+    std::size_t size_ = 0;
+    // Fired tasks are executed after releasing the lock, so they may schedule and cancel timers
+    std::vector<MainThreadTask> firedTasks_;
+
+    std::uint64_t tickOf(Clock::time_point time) const;
+
+    // The node must not be in a slot
+    void place(std::uint32_t index);
+
+    void append(std::size_t slot, std::uint32_t index);
+
+    void unlink(std::uint32_t index);
+
+    // Places all timers of the given slot again, they end up in lower levels
+    void cascade(std::size_t level, std::size_t slotInLevel);
+
+    void fire(std::size_t slot);
+  };
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <reaper_plugin.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace reaplus {
+
+  // Track parameters whose automation state is cached in TrackDataStore::automatedParameters (one bit each)
+  enum class AutomatedParameter : std::uint8_t {
+    Volume,
+    Pan,
+    Mute,
+    SendVolume,
+    SendPan
+  };
+
+  inline std::uint8_t automatedParameterBit(AutomatedParameter parameter) {
+    return static_cast<std::uint8_t>(1u << static_cast<unsigned>(parameter));
+  }
+
+  // Last known state of a track, used by HelperControlSurface to find out whether a callback reports an actual change
+  struct TrackData {
+    double volume;
+    double pan;
+    bool selected;
+    bool mute;
+    bool solo;
+    bool recarm;
+    int number;
+    int recmonitor;
+    int recinput;
+    GUID guid;
+    // 0 means not cached yet
+    std::uint32_t automationEpoch;
+    std::uint8_t automatedParameters;
+  };
+
+  // Dense struct-of-arrays store of the TrackData of all tracks in one project. The columns are indexed by slot.
+  // Slots are contiguous: Removing a track moves the track in the last slot into the freed one. So a slot is only
+  // valid until the next removal.
+  class TrackDataStore {
+  public:
+    using Slot = int;
+    static constexpr Slot NO_SLOT = -1;
+
+    // Columns
+    std::vector<MediaTrack*> mediaTracks;
+    std::vector<double> volumes;
+    std::vector<double> pans;
+    std::vector<char> selecteds;
+    std::vector<char> mutes;
+    std::vector<char> solos;
+    std::vector<char> recarms;
+    std::vector<int> numbers;
+    std::vector<int> recmonitors;
+    std::vector<int> recinputs;
+    std::vector<GUID> guids;
+    // Cached automation state. Only valid if the epoch equals the current automation epoch of HelperControlSurface.
+    std::vector<std::uint32_t> automationEpochs;
+    std::vector<std::uint8_t> automatedParameters;
+
+    TrackDataStore();
+
+    int size() const;
+
+    bool empty() const;
+
+    // Hot path (called from SetSurfaceVolume etc.), therefore inline
+    Slot slotOf(MediaTrack* mediaTrack) const {
+      for (std::size_t i = bucketIndexOf(mediaTrack);; i = (i + 1) & mask_) {
+        const auto& bucket = buckets_[i];
+        if (bucket.mediaTrack == mediaTrack) {
+          return bucket.slot;
+        }
+        if (bucket.mediaTrack == nullptr) {
+          return NO_SLOT;
+        }
+      }
+    }
+
+    // Precondition: mediaTrack must not be in the store yet
+    Slot add(MediaTrack* mediaTrack, const TrackData& data);
+
+    // Moves the last slot into the given one. Iterate backwards if you remove while iterating.
+    void remove(Slot slot);
+
+    TrackData get(Slot slot) const;
+
+    void clear();
+
+  private:
+    // Flat MediaTrack* -> slot map (open addressing with linear probing, capacity always a power of two)
+    struct Bucket {
+      MediaTrack* mediaTrack;
+      Slot slot;
+    };
+    std::vector<Bucket> buckets_;
+    std::size_t mask_;
+
+    std::size_t bucketIndexOf(MediaTrack* mediaTrack) const {
+      // Fibonacci hashing. Lower bits of heap pointers are mostly zero, upper bits of the product are well mixed.
+      const auto h = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(mediaTrack))
+          * UINT64_C(0x9E3779B97F4A7C15);
+      return static_cast<std::size_t>(h >> 32) & mask_;
+    }
+
+    std::size_t findBucket(MediaTrack* mediaTrack) const;
+
+    void insertIntoBuckets(MediaTrack* mediaTrack, Slot slot);
+
+    void eraseFromBuckets(MediaTrack* mediaTrack);
+
+    void rehash(std::size_t capacity);
+  };
+}
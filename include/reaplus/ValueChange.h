@@ -0,0 +1,10 @@
+#pragma once
+
+namespace reaplus {
+  // Change notification which carries the latest value of the changed target
+  template<typename Target>
+  struct ValueChange {
+    Target target;
+    double value;
+  };
+}
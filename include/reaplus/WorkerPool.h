@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <boost/optional.hpp>
+#include "MainThreadTaskQueue.h"
+#include "util/log.h"
+
+namespace reaplus {
+  // Same inline capture storage as main thread tasks
+  using WorkerTask = util::InlineTask<128>;
+
+  template<typename T>
+  class WorkerFuture;
+
+  // Small pool of worker threads for pure CPU work which doesn't need REAPER (e.g. parsing a chunk which has already
+  // been fetched). Each worker has its own task deque: it takes its own tasks LIFO and steals from the others FIFO when
+  // it runs out of work. Tasks submitted by a worker go into its own deque, others are distributed round-robin. Threads
+  // are started with the first submission.
+  class WorkerPool {
+  public:
+    // Posts a task to the main thread, results of WorkerFuture are delivered that way
+    using MainThreadPoster = std::function<void(MainThreadTask)>;
+
+    // Thread count 0 means half the hardware threads, at least 1 and at most 4
+    WorkerPool(std::size_t threadCount, MainThreadPoster postToMainThread);
+
+    // Shuts down
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Any thread. Executes the work in a worker thread. Its result (or exception) is delivered to the main thread via
+    // the returned future. Throws std::logic_error after shutdown(), except when called by a task of this pool.
+    template<typename F>
+    WorkerFuture<std::invoke_result_t<F>> submit(F&& work);
+
+    // Lets the workers finish the already submitted tasks and joins them. Results which are ready by then are still
+    // posted to the main thread. Idempotent.
+    void shutdown();
+
+    std::size_t threadCount() const;
+
+    // Number of tasks taken from another worker's deque
+    std::uint64_t stolenCount() const;
+
+  private:
+    struct Worker {
+      std::mutex mutex;
+      std::deque<WorkerTask> tasks;
+      std::thread thread;
+    };
+
+    std::size_t threadCount_;
+    MainThreadPoster postToMainThread_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex stateMutex_;
+    std::condition_variable wakeUp_;
+    // Guarded by stateMutex_ when incremented, so that sleeping workers don't miss a submission
+    std::atomic<std::size_t> pendingCount_{0};
+    bool started_ = false;
+    bool stopping_ = false;
+    bool stopped_ = false;
+    std::atomic<std::size_t> nextWorkerIndex_{0};
+    std::atomic<std::uint64_t> stolenCount_{0};
+
+    void push(WorkerTask task);
+
+    void run(std::size_t workerIndex);
+
+    bool tryTake(std::size_t workerIndex, WorkerTask& task);
+
+    template<typename T>
+    friend class WorkerFuture;
+  };
+
+  // Result of WorkerPool::submit(). Either register callbacks via then() or co_await it from a C++20 coroutine (see
+  // Coroutines.h). Both continue in the main thread. Single consumer: then() or co_await, once.
+  template<typename T>
+  class WorkerFuture {
+  private:
+    struct State {
+      std::mutex mutex;
+      bool done = false;
+      std::conditional_t<std::is_void<T>::value, bool, boost::optional<T>> value;
+      std::exception_ptr error;
+      std::function<void()> continuation;
+      WorkerPool::MainThreadPoster postToMainThread;
+    };
+
+    std::shared_ptr<State> state_;
+
+    explicit WorkerFuture(std::shared_ptr<State> state) : state_(std::move(state)) {
+    }
+
+    void setContinuation(std::function<void()> continuation) const {
+      bool done;
+      {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        done = state_->done;
+        if (!done) {
+          state_->continuation = std::move(continuation);
+        }
+      }
+      if (done) {
+        // Consistently asynchronous
+        state_->postToMainThread(MainThreadTask([continuation = std::move(continuation)] {
+          continuation();
+        }));
+      }
+    }
+
+    friend class WorkerPool;
+
+  public:
+    // Whether the result is available
+    bool isReady() const {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      return state_->done;
+    }
+
+    // onSuccess gets the result (nothing for void work). If the work threw, onError gets the exception or - if not
+    // given - it's logged.
+    template<typename F>
+    void then(F onSuccess, std::function<void(std::exception_ptr)> onError = nullptr) const {
+      const auto state = state_;
+      setContinuation([state, onSuccess = std::move(onSuccess), onError = std::move(onError)]() mutable {
+        if (state->error) {
+          if (onError) {
+            onError(state->error);
+          } else {
+            try {
+              std::rethrow_exception(state->error);
+            } catch (...) {
+              util::logException();
+            }
+          }
+          return;
+        }
+        if constexpr (std::is_void<T>::value) {
+          onSuccess();
+        } else {
+          onSuccess(std::move(*state->value));
+        }
+      });
+    }
+
+    bool await_ready() const {
+      return false;
+    }
+
+    template<typename Handle>
+    void await_suspend(Handle handle) const {
+      setContinuation([handle] {
+        handle.resume();
+      });
+    }
+
+    T await_resume() const {
+      if (state_->error) {
+        std::rethrow_exception(state_->error);
+      }
+      if constexpr (!std::is_void<T>::value) {
+        return std::move(*state_->value);
+      }
+    }
+  };
+
+  template<typename F>
+  WorkerFuture<std::invoke_result_t<F>> WorkerPool::submit(F&& work) {
+    using T = std::invoke_result_t<F>;
+    using State = typename WorkerFuture<T>::State;
+    const auto state = std::make_shared<State>();
+    state->postToMainThread = postToMainThread_;
+    push(WorkerTask([state, work = std::forward<F>(work)]() mutable {
+      try {
+        if constexpr (std::is_void<T>::value) {
+          work();
+          state->value = true;
+        } else {
+          state->value = work();
+        }
+      } catch (...) {
+        state->error = std::current_exception();
+      }
+      std::function<void()> continuation;
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->done = true;
+        continuation = std::move(state->continuation);
+      }
+      if (continuation) {
+        state->postToMainThread(MainThreadTask([continuation = std::move(continuation)] {
+          continuation();
+        }));
+      }
+    }));
+    return WorkerFuture<T>(state);
+  }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace reaplus::util {
+  // Bounded lock-free multi-producer multi-consumer queue (per-slot sequence numbers). Storage is allocated at
+  // construction, so pushing and popping never allocates, which makes it usable from the audio thread. T must be
+  // default-constructible and move-assignable.
+  template<typename T>
+  class BoundedQueue {
+  private:
+    struct Slot {
+      std::atomic<std::size_t> sequence;
+      T value;
+    };
+
+    std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    // Separate cache lines so producers and consumers don't invalidate each other's line on each access
+    alignas(64) std::atomic<std::size_t> enqueuePosition_{0};
+    alignas(64) std::atomic<std::size_t> dequeuePosition_{0};
+
+    static std::size_t nextPowerOfTwo(std::size_t n) {
+      std::size_t result = 1;
+      while (result < n) {
+        result <<= 1;
+      }
+      return result;
+    }
+
+  public:
+    // Capacity is rounded up to the next power of two
+    explicit BoundedQueue(std::size_t capacity) : mask_(nextPowerOfTwo(capacity) - 1), slots_(new Slot[mask_ + 1]) {
+      for (std::size_t i = 0; i <= mask_; i++) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Returns false if the queue is full
+    template<typename U>
+    bool tryPush(U&& value) {
+      auto position = enqueuePosition_.load(std::memory_order_relaxed);
+      while (true) {
+        auto& slot = slots_[position & mask_];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+        if (difference == 0) {
+          // Slot is free, try to claim it
+          if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+            slot.value = std::forward<U>(value);
+            slot.sequence.store(position + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (difference < 0) {
+          // Slot still occupied by a value from the previous round
+          return false;
+        } else {
+          // Another producer claimed it
+          position = enqueuePosition_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    // Returns false if the queue is empty (or the next producer hasn't finished writing yet)
+    bool tryPop(T& value) {
+      auto position = dequeuePosition_.load(std::memory_order_relaxed);
+      while (true) {
+        auto& slot = slots_[position & mask_];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+        if (difference == 0) {
+          if (dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+            value = std::move(slot.value);
+            // Hand the slot back to the producers
+            slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (difference < 0) {
+          return false;
+        } else {
+          // Another consumer took it
+          position = dequeuePosition_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    std::size_t capacity() const {
+      return mask_ + 1;
+    }
+
+    // Approximate if called while other threads push or pop
+    std::size_t size() const {
+      const auto enqueuePosition = enqueuePosition_.load(std::memory_order_acquire);
+      const auto dequeuePosition = dequeuePosition_.load(std::memory_order_acquire);
+      return enqueuePosition > dequeuePosition ? enqueuePosition - dequeuePosition : 0;
+    }
+  };
+}
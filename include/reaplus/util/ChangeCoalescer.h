@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace reaplus::util {
+  // Gathers changes in a dirty set keyed by change target. Marking a target which is already dirty just overwrites
+  // its value, so each target is delivered at most once per flush - with the latest value. Delivery order is the
+  // order in which targets became dirty.
+  //
+  // The index is an open-addressing table whose storage is kept between flushes, so marking doesn't allocate once the
+  // coalescer has seen the maximum number of dirty targets per flush.
+  template<typename Key, typename Value, typename Hash = std::hash<Key>>
+  class ChangeCoalescer {
+  private:
+    static constexpr std::size_t INITIAL_BUCKET_COUNT = 64;
+
+    // A bucket is occupied if its epoch is the current one, so clearing the index after a flush is O(1)
+    struct Bucket {
+      std::uint32_t index;
+      std::uint32_t epoch;
+    };
+
+    std::vector<Bucket> buckets_ = std::vector<Bucket>(INITIAL_BUCKET_COUNT, Bucket{0, 0});
+    std::size_t mask_ = INITIAL_BUCKET_COUNT - 1;
+    std::uint32_t epoch_ = 1;
+    std::vector<Key> pendingKeys_;
+    std::vector<Value> pendingValues_;
+    std::vector<Value> flushingValues_;
+
+    std::size_t bucketIndexOf(const Key& key) const {
+      // Fibonacci hashing spreads weak hashes (e.g. pointers) over the upper bits
+      const auto h = static_cast<std::uint64_t>(Hash()(key)) * UINT64_C(0x9E3779B97F4A7C15);
+      return static_cast<std::size_t>(h >> 32) & mask_;
+    }
+
+    void rehash(std::size_t capacity) {
+      buckets_.assign(capacity, Bucket{0, 0});
+      mask_ = capacity - 1;
+      epoch_ = 1;
+      for (std::size_t index = 0; index < pendingKeys_.size(); index++) {
+        auto i = bucketIndexOf(pendingKeys_[index]);
+        while (buckets_[i].epoch == epoch_) {
+          i = (i + 1) & mask_;
+        }
+        buckets_[i] = Bucket{static_cast<std::uint32_t>(index), epoch_};
+      }
+    }
+
+  public:
+    void mark(const Key& key, const Value& value) {
+      auto i = bucketIndexOf(key);
+      while (buckets_[i].epoch == epoch_) {
+        const auto index = buckets_[i].index;
+        if (pendingKeys_[index] == key) {
+          pendingValues_[index] = value;
+          return;
+        }
+        i = (i + 1) & mask_;
+      }
+      buckets_[i] = Bucket{static_cast<std::uint32_t>(pendingKeys_.size()), epoch_};
+      pendingKeys_.push_back(key);
+      pendingValues_.push_back(value);
+      // Keep load factor <= 0.5 so probe sequences stay short
+      if (pendingKeys_.size() * 2 > buckets_.size()) {
+        rehash(buckets_.size() * 2);
+      }
+    }
+
+    bool empty() const {
+      return pendingValues_.empty();
+    }
+
+    // Changes marked while consuming end up in the next flush
+    template<typename Consumer>
+    void flush(Consumer consume) {
+      if (pendingValues_.empty()) {
+        return;
+      }
+      flushingValues_.clear();
+      flushingValues_.swap(pendingValues_);
+      pendingKeys_.clear();
+      if (++epoch_ == 0) {
+        // Wrapped around, so old epochs could look current again
+        rehash(buckets_.size());
+      }
+      for (const auto& value : flushingValues_) {
+        consume(value);
+      }
+      flushingValues_.clear();
+      // Hand the grown buffer back, so the next cycle doesn't need to grow the other one
+      if (pendingValues_.empty()) {
+        pendingValues_.swap(flushingValues_);
+      }
+    }
+  };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace reaplus::util {
+  // Move-only callable without arguments which stores its captures inline instead of on the heap. Callables with
+  // captures bigger than Capacity are rejected at compile time, so creating, moving and invoking a task never
+  // allocates.
+  template<std::size_t Capacity>
+  class InlineTask {
+  private:
+    alignas(std::max_align_t) unsigned char storage_[Capacity];
+    void (* invoke_)(void*) = nullptr;
+    // Move-constructs the callable at target (if not null) and destroys the source
+    void (* relocate_)(void* target, void* source) = nullptr;
+
+  public:
+    static constexpr std::size_t CAPACITY = Capacity;
+
+    InlineTask() = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InlineTask>::value>>
+    InlineTask(F&& f) {
+      using Callable = std::decay_t<F>;
+      static_assert(sizeof(Callable) <= Capacity, "Captures too big for inline task storage");
+      static_assert(alignof(Callable) <= alignof(std::max_align_t), "Captures over-aligned");
+      static_assert(std::is_nothrow_move_constructible<Callable>::value, "Captures must be nothrow movable");
+      new(storage_) Callable(std::forward<F>(f));
+      invoke_ = [](void* callable) {
+        (*static_cast<Callable*>(callable))();
+      };
+      relocate_ = [](void* target, void* source) {
+        const auto sourceCallable = static_cast<Callable*>(source);
+        if (target != nullptr) {
+          new(target) Callable(std::move(*sourceCallable));
+        }
+        sourceCallable->~Callable();
+      };
+    }
+
+    InlineTask(InlineTask&& other) noexcept {
+      takeFrom(other);
+    }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+      if (this != &other) {
+        reset();
+        takeFrom(other);
+      }
+      return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask() {
+      reset();
+    }
+
+    explicit operator bool() const {
+      return invoke_ != nullptr;
+    }
+
+    void operator()() {
+      invoke_(storage_);
+    }
+
+    void reset() {
+      if (relocate_ != nullptr) {
+        relocate_(nullptr, storage_);
+        invoke_ = nullptr;
+        relocate_ = nullptr;
+      }
+    }
+
+  private:
+    void takeFrom(InlineTask& other) {
+      if (other.relocate_ != nullptr) {
+        other.relocate_(storage_, other.storage_);
+        invoke_ = other.invoke_;
+        relocate_ = other.relocate_;
+        other.invoke_ = nullptr;
+        other.relocate_ = nullptr;
+      }
+    }
+  };
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <reaper_plugin.h>
+
+namespace reaplus::util {
+  struct PeakAndSumOfSquares {
+    // Highest absolute sample value
+    double peak;
+    double sumOfSquares;
+  };
+
+  // Measures a buffer of samples in one pass, using SSE2 or NEON where available. Doesn't allocate.
+  PeakAndSumOfSquares measurePeakAndSumOfSquares(const ReaSample* samples, int count);
+}
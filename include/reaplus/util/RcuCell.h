@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace reaplus::util {
+  // Holds an immutable value which one writer thread replaces from time to time and one reader thread (typically the
+  // audio thread) reads without locking, allocating or waiting. Replaced values are reclaimed by the writer as soon as
+  // the reader can't see them anymore (quiescent-state based reclamation). Writer operations must not run
+  // concurrently with each other.
+  template<typename T>
+  class RcuCell {
+  private:
+    std::atomic<T*> current_;
+    std::atomic<std::uint64_t> writerEpoch_{1};
+    // Epoch at the time the reader started reading, 0 if not reading
+    std::atomic<std::uint64_t> readerEpoch_{0};
+    std::vector<std::pair<std::uint64_t, std::unique_ptr<T>>> retired_;
+
+  public:
+    explicit RcuCell(std::unique_ptr<T> initialValue) : current_(initialValue.release()) {
+    }
+
+    RcuCell(const RcuCell&) = delete;
+
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ~RcuCell() {
+      delete current_.load();
+    }
+
+    // Reader only. The value stays valid until endRead().
+    const T& beginRead() {
+      readerEpoch_.store(writerEpoch_.load());
+      return *current_.load();
+    }
+
+    // Reader only
+    void endRead() {
+      readerEpoch_.store(0);
+    }
+
+    // Writer only. Only valid until the next publish() because it's not protected against reclamation.
+    const T& get() const {
+      return *current_.load();
+    }
+
+    // Writer only
+    void publish(std::unique_ptr<T> value) {
+      const auto old = current_.exchange(value.release());
+      const auto epoch = writerEpoch_.fetch_add(1) + 1;
+      retired_.emplace_back(epoch, std::unique_ptr<T>(old));
+      collect();
+    }
+
+    // Writer only. Frees replaced values which the reader can't see anymore. Should be called regularly.
+    void collect() {
+      if (retired_.empty()) {
+        return;
+      }
+      const auto readerEpoch = readerEpoch_.load();
+      auto it = retired_.begin();
+      while (it != retired_.end()) {
+        if (readerEpoch == 0 || readerEpoch >= it->first) {
+          it = retired_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+  };
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace reaplus::util {
+  // Holds a small trivially copyable value which one writer thread (typically the audio thread) replaces often and
+  // any number of reader threads copy out. Writing never waits, reading retries while a write is in progress, so
+  // readers always see a consistent value.
+  template<typename T>
+  class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+
+  private:
+    static constexpr std::size_t WORD_COUNT = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+    // Odd while a write is in progress
+    std::atomic<std::uint64_t> sequence_{0};
+    // Accessed as atomics so that overlapping reads and writes are no data race
+    std::array<std::atomic<std::uint64_t>, WORD_COUNT> words_{};
+
+  public:
+    SeqLock() = default;
+
+    SeqLock(const SeqLock&) = delete;
+
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // Writer only
+    void store(const T& value) {
+      std::uint64_t words[WORD_COUNT] = {};
+      std::memcpy(words, &value, sizeof(T));
+      const auto sequence = sequence_.load(std::memory_order_relaxed);
+      sequence_.store(sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      for (std::size_t i = 0; i < WORD_COUNT; i++) {
+        words_[i].store(words[i], std::memory_order_relaxed);
+      }
+      sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Any thread
+    T load() const {
+      std::uint64_t words[WORD_COUNT];
+      std::uint64_t before;
+      std::uint64_t after;
+      do {
+        before = sequence_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < WORD_COUNT; i++) {
+          words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence_.load(std::memory_order_relaxed);
+      } while (before != after || (before & 1) != 0);
+      T value;
+      std::memcpy(&value, words, sizeof(T));
+      return value;
+    }
+  };
+}
@@ -66,6 +66,24 @@ public:
 
     void dispatch() const {
         std::unique_lock<std::mutex> guard(state->lock);
+        dispatch_locked(guard);
+    }
+
+    // like dispatch() but returns immediately if another thread holds the lock
+    void try_dispatch() const {
+        std::unique_lock<std::mutex> guard(state->lock, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            return;
+        }
+        dispatch_locked(guard);
+    }
+
+    scheduler get_scheduler() const {
+        return make_scheduler(sc);
+    }
+
+private:
+    void dispatch_locked(std::unique_lock<std::mutex>& guard) const {
         if (state->q.empty()) {
             return;
         }
@@ -83,10 +101,6 @@ public:
         guard.unlock();
         what(state->r.get_recurse());
     }
-
-    scheduler get_scheduler() const {
-        return make_scheduler(sc);
-    }
 };
 
 inline scheduler make_relaxed_run_loop(const relaxed_run_loop& r) {
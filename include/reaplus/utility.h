@@ -19,6 +19,9 @@ namespace reaplus {
   // DONE-rust
   std::string convertGuidToString(const GUID& guid);
 
+  // Accepts the brace-less format produced by convertGuidToString
+  GUID convertStringToGuid(const std::string& guidString);
+
   /**
    * Executes the given fillBuffer function and converts the filled buffer to a string.
    */
@@ -0,0 +1,47 @@
+#include <reaplus/AudioTaskQueue.h>
+
+namespace reaplus {
+  AudioTaskQueue::AudioTaskQueue(std::size_t capacity) : tasks_(capacity) {
+  }
+
+  std::size_t AudioTaskQueue::runFor(std::chrono::microseconds budget) {
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t executed = 0;
+    AudioTask task;
+    while (true) {
+      if (executed > 0 && std::chrono::steady_clock::now() - start >= budget) {
+        deferredCount_.fetch_add(tasks_.size(), std::memory_order_relaxed);
+        break;
+      }
+      if (!tasks_.tryPop(task)) {
+        break;
+      }
+      executed++;
+      executedCount_.fetch_add(1, std::memory_order_relaxed);
+      // Slot is already free again, so the task might push
+      task();
+      task.reset();
+    }
+    return executed;
+  }
+
+  std::size_t AudioTaskQueue::capacity() const {
+    return tasks_.capacity();
+  }
+
+  std::size_t AudioTaskQueue::size() const {
+    return tasks_.size();
+  }
+
+  std::uint64_t AudioTaskQueue::droppedCount() const {
+    return droppedCount_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t AudioTaskQueue::deferredCount() const {
+    return deferredCount_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t AudioTaskQueue::executedCount() const {
+    return executedCount_.load(std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,44 @@
+#include <reaplus/Awaitables.h>
+#include <reaplus/Reaper.h>
+
+namespace reaplus {
+  bool MainThreadAwaitable::await_ready() const {
+    return Reaper::instance().currentThreadIsMainThread();
+  }
+
+  void MainThreadAwaitable::scheduleInMainThread(MainThreadTask task) {
+    Reaper::instance().executeLaterInMainThreadFast(std::move(task));
+  }
+
+  void NextRunCycleAwaitable::scheduleInNextRunCycle(MainThreadTask task) {
+    Reaper::instance().executeLaterInMainThread(MainThreadPriority::Feedback, std::move(task));
+  }
+
+  bool AudioBlockAwaitable::scheduleInAudioThread(AudioTask task) {
+    return Reaper::instance().executeLaterInAudioThread(std::move(task));
+  }
+
+  DelayAwaitable::DelayAwaitable(std::chrono::steady_clock::duration duration) :
+      dueTime_(std::chrono::steady_clock::now() + duration) {
+  }
+
+  bool DelayAwaitable::await_ready() const {
+    return std::chrono::steady_clock::now() >= dueTime_;
+  }
+
+  bool DelayAwaitable::isInMainThread() {
+    return Reaper::instance().currentThreadIsMainThread();
+  }
+
+  void DelayAwaitable::scheduleInMainThread(MainThreadTask task) {
+    Reaper::instance().executeLaterInMainThreadFast(std::move(task));
+  }
+
+  void DelayAwaitable::scheduleAt(std::chrono::steady_clock::time_point dueTime, MainThreadTask task) {
+    Reaper::instance().timerWheel().scheduleAt(dueTime, std::move(task));
+  }
+
+  DelayAwaitable delay(std::chrono::steady_clock::duration duration) {
+    return DelayAwaitable(duration);
+  }
+}
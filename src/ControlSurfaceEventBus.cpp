@@ -0,0 +1,98 @@
+#include <reaplus/ControlSurfaceEventBus.h>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+namespace reaplus {
+  ControlSurfaceEventBus::ControlSurfaceEventBus(std::size_t ringCapacity) : ring_(ringCapacity) {
+  }
+
+  ControlSurfaceEventBus::ListenerId ControlSurfaceEventBus::addListener(ControlSurfaceEventMask mask,
+      Listener listener) {
+    const auto id = nextListenerId_++;
+    auto& entries = isDispatching_ ? addedEntries_ : entries_;
+    entries.push_back(Entry{id, mask, std::move(listener), false});
+    listenedMask_ |= mask;
+    return id;
+  }
+
+  void ControlSurfaceEventBus::removeListener(ListenerId id) {
+    for (auto* entries : {&entries_, &addedEntries_}) {
+      for (auto& entry : *entries) {
+        if (entry.id == id) {
+          entry.removed = true;
+          hasRemovedEntries_ = true;
+        }
+      }
+    }
+    if (!isDispatching_) {
+      compactEntries();
+    }
+  }
+
+  std::uint64_t ControlSurfaceEventBus::ringOverflowCount() const {
+    return ringOverflowCount_;
+  }
+
+  void ControlSurfaceEventBus::enqueueAndDispatch(const ControlSurfaceEvent& event) {
+    if (isDispatching_) {
+      if (ringSize_ < ring_.size()) {
+        ring_[(ringHead_ + ringSize_) % ring_.size()] = event;
+        ringSize_++;
+      } else {
+        ringOverflowCount_++;
+        dispatch(event);
+      }
+      return;
+    }
+    isDispatching_ = true;
+    try {
+      dispatch(event);
+      while (ringSize_ > 0) {
+        const auto queuedEvent = ring_[ringHead_];
+        ringHead_ = (ringHead_ + 1) % ring_.size();
+        ringSize_--;
+        dispatch(queuedEvent);
+      }
+    } catch (...) {
+      ringSize_ = 0;
+      isDispatching_ = false;
+      compactEntries();
+      throw;
+    }
+    isDispatching_ = false;
+    compactEntries();
+  }
+
+  void ControlSurfaceEventBus::dispatch(const ControlSurfaceEvent& event) {
+    const auto mask = eventMask(event.kind);
+    // entries_ is not modified structurally during dispatch (see addedEntries_ and Entry::removed)
+    for (const auto& entry : entries_) {
+      if (!entry.removed && (entry.mask & mask) != 0) {
+        entry.listener(event);
+      }
+    }
+  }
+
+  void ControlSurfaceEventBus::compactEntries() {
+    if (!addedEntries_.empty()) {
+      std::move(addedEntries_.begin(), addedEntries_.end(), std::back_inserter(entries_));
+      addedEntries_.clear();
+    }
+    if (hasRemovedEntries_) {
+      entries_.erase(
+          std::remove_if(entries_.begin(), entries_.end(), [](const Entry& e) { return e.removed; }),
+          entries_.end()
+      );
+      hasRemovedEntries_ = false;
+      updateListenedMask();
+    }
+  }
+
+  void ControlSurfaceEventBus::updateListenedMask() {
+    listenedMask_ = 0;
+    for (const auto& entry : entries_) {
+      listenedMask_ |= entry.mask;
+    }
+  }
+}
@@ -0,0 +1,69 @@
+#include <reaplus/CoroutineFrameArena.h>
+#include <new>
+
+namespace reaplus {
+  static_assert(CoroutineFrameArena::MIN_BLOCK_SIZE << 5 == CoroutineFrameArena::MAX_BLOCK_SIZE,
+      "SIZE_CLASS_COUNT doesn't match block sizes");
+
+  CoroutineFrameArena& CoroutineFrameArena::instance() {
+    static const auto INSTANCE = new CoroutineFrameArena();
+    return *INSTANCE;
+  }
+
+  CoroutineFrameArena::CoroutineFrameArena(std::size_t freeBlocksPerSizeClass) {
+    for (auto& freeBlocks : freeBlocks_) {
+      freeBlocks.reset(new util::BoundedQueue<void*>(freeBlocksPerSizeClass));
+    }
+  }
+
+  CoroutineFrameArena::~CoroutineFrameArena() {
+    for (auto& freeBlocks : freeBlocks_) {
+      void* block;
+      while (freeBlocks->tryPop(block)) {
+        ::operator delete(block);
+      }
+    }
+  }
+
+  void* CoroutineFrameArena::allocate(std::size_t size) {
+    const auto sizeClass = sizeClassOf(size);
+    if (sizeClass == SIZE_CLASS_COUNT) {
+      heapAllocationCount_.fetch_add(1, std::memory_order_relaxed);
+      return ::operator new(size);
+    }
+    void* block;
+    if (freeBlocks_[sizeClass]->tryPop(block)) {
+      reuseCount_.fetch_add(1, std::memory_order_relaxed);
+      return block;
+    }
+    heapAllocationCount_.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(blockSizeOf(sizeClass));
+  }
+
+  void CoroutineFrameArena::deallocate(void* block, std::size_t size) noexcept {
+    const auto sizeClass = sizeClassOf(size);
+    if (sizeClass == SIZE_CLASS_COUNT || !freeBlocks_[sizeClass]->tryPush(block)) {
+      ::operator delete(block);
+    }
+  }
+
+  std::uint64_t CoroutineFrameArena::heapAllocationCount() const {
+    return heapAllocationCount_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t CoroutineFrameArena::reuseCount() const {
+    return reuseCount_.load(std::memory_order_relaxed);
+  }
+
+  std::size_t CoroutineFrameArena::sizeClassOf(std::size_t size) {
+    std::size_t sizeClass = 0;
+    while (sizeClass < SIZE_CLASS_COUNT && blockSizeOf(sizeClass) < size) {
+      sizeClass++;
+    }
+    return sizeClass;
+  }
+
+  std::size_t CoroutineFrameArena::blockSizeOf(std::size_t sizeClass) {
+    return MIN_BLOCK_SIZE << sizeClass;
+  }
+}
@@ -0,0 +1,116 @@
+#include <reaplus/FxParameterShadowTable.h>
+
+namespace reaplus {
+  bool FxParameterShadowTable::update(MediaTrack* mediaTrack, bool isInputFx, int fxIndex, int paramIndex,
+      double value) {
+    const Key key{mediaTrack, isInputFx, fxIndex, paramIndex};
+    const auto it = nodeIndexByKey_.find(key);
+    if (it == nodeIndexByKey_.end()) {
+      const auto index = (int) nodes_.size();
+      nodes_.push_back(Node{Entry{mediaTrack, isInputFx, fxIndex, paramIndex, value, ++sequence_}, -1, -1});
+      nodeIndexByKey_.emplace(key, index);
+      linkAtTail(index);
+      return true;
+    }
+    const auto index = it->second;
+    auto& entry = nodes_[index].entry;
+    if (entry.value == value) {
+      return false;
+    }
+    entry.value = value;
+    entry.sequence = ++sequence_;
+    unlink(index);
+    linkAtTail(index);
+    return true;
+  }
+
+  const FxParameterShadowTable::Entry* FxParameterShadowTable::find(MediaTrack* mediaTrack, bool isInputFx,
+      int fxIndex, int paramIndex) const {
+    const auto it = nodeIndexByKey_.find(Key{mediaTrack, isInputFx, fxIndex, paramIndex});
+    return it == nodeIndexByKey_.end() ? nullptr : &nodes_[it->second].entry;
+  }
+
+  std::uint64_t FxParameterShadowTable::sequence() const {
+    return sequence_;
+  }
+
+  void FxParameterShadowTable::forEachChangedSince(std::uint64_t sequence,
+      const std::function<void(const Entry&)>& consumer) const {
+    for (auto i = tail_; i != -1 && nodes_[i].entry.sequence > sequence; i = nodes_[i].prev) {
+      consumer(nodes_[i].entry);
+    }
+  }
+
+  void FxParameterShadowTable::removeFxChain(MediaTrack* mediaTrack, bool isInputFx) {
+    // Backwards because removing a node moves the last node into it
+    for (auto i = (int) nodes_.size() - 1; i >= 0; i--) {
+      const auto& entry = nodes_[i].entry;
+      if (entry.mediaTrack == mediaTrack && entry.isInputFx == isInputFx) {
+        remove(i);
+      }
+    }
+  }
+
+  void FxParameterShadowTable::removeTracks(const std::function<bool(MediaTrack*)>& predicate) {
+    for (auto i = (int) nodes_.size() - 1; i >= 0; i--) {
+      if (predicate(nodes_[i].entry.mediaTrack)) {
+        remove(i);
+      }
+    }
+  }
+
+  FxParameterShadowTable::Key FxParameterShadowTable::keyOf(const Entry& entry) {
+    return Key{entry.mediaTrack, entry.isInputFx, entry.fxIndex, entry.paramIndex};
+  }
+
+  void FxParameterShadowTable::unlink(int index) {
+    auto& node = nodes_[index];
+    if (node.prev == -1) {
+      head_ = node.next;
+    } else {
+      nodes_[node.prev].next = node.next;
+    }
+    if (node.next == -1) {
+      tail_ = node.prev;
+    } else {
+      nodes_[node.next].prev = node.prev;
+    }
+    node.prev = -1;
+    node.next = -1;
+  }
+
+  void FxParameterShadowTable::linkAtTail(int index) {
+    auto& node = nodes_[index];
+    node.prev = tail_;
+    node.next = -1;
+    if (tail_ == -1) {
+      head_ = index;
+    } else {
+      nodes_[tail_].next = index;
+    }
+    tail_ = index;
+  }
+
+  void FxParameterShadowTable::remove(int index) {
+    unlink(index);
+    nodeIndexByKey_.erase(keyOf(nodes_[index].entry));
+    const auto lastIndex = (int) nodes_.size() - 1;
+    if (index != lastIndex) {
+      // Move last node into the hole and repoint everything which referred to it
+      nodes_[index] = nodes_[lastIndex];
+      auto& moved = nodes_[index];
+      if (moved.prev == -1) {
+        head_ = index;
+      } else {
+        nodes_[moved.prev].next = index;
+      }
+      if (moved.next == -1) {
+        tail_ = index;
+      } else {
+        nodes_[moved.next].prev = index;
+      }
+      nodeIndexByKey_[keyOf(moved.entry)] = index;
+    }
+    nodes_.pop_back();
+  }
+}
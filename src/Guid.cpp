@@ -1,5 +1,6 @@
 #include <reaplus/Guid.h>
 #include <reaplus/utility.h>
+#include <cstring>
 
 namespace reaplus {
   Guid::Guid(GUID data) : data_(data) {
@@ -12,4 +13,16 @@ namespace reaplus {
   std::string Guid::toString() const {
     return convertGuidToString(data_);
   }
+
+  bool operator==(const Guid& lhs, const Guid& rhs) {
+    return std::memcmp(&lhs.data_, &rhs.data_, sizeof(GUID)) == 0;
+  }
+
+  bool operator!=(const Guid& lhs, const Guid& rhs) {
+    return !(lhs == rhs);
+  }
+
+  bool operator<(const Guid& lhs, const Guid& rhs) {
+    return std::memcmp(&lhs.data_, &rhs.data_, sizeof(GUID)) < 0;
+  }
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <reaplus/HardwareMeter.h>
+#include <reaplus/util/MeterKernels.h>
+#include <algorithm>
+#include <cmath>
+
+namespace reaplus {
+  constexpr std::chrono::milliseconds HardwareMeter::DEFAULT_HOLD_TIME;
+
+  HardwareMeter::HardwareMeter() {
+    for (auto& level : levels_) {
+      level.store(HardwareMeterLevel{0, 0, 0});
+    }
+  }
+
+  void HardwareMeter::setEnabled(bool enabled) {
+    enabled_.store(enabled);
+  }
+
+  bool HardwareMeter::isEnabled() const {
+    return enabled_.load();
+  }
+
+  void HardwareMeter::setDecay(double decibelsPerSecond) {
+    decayInDbPerSecond_.store(std::max(0.0, decibelsPerSecond));
+  }
+
+  void HardwareMeter::setHoldTime(std::chrono::milliseconds holdTime) {
+    holdTimeInMillis_.store(std::max<std::int64_t>(0, holdTime.count()));
+  }
+
+  void HardwareMeter::reset() {
+    resetRequested_.store(true);
+  }
+
+  void HardwareMeter::process(const audio_hook_register_t& reg, int blockLength, double sampleRate) {
+    if (!enabled_.load(std::memory_order_relaxed) || reg.GetBuffer == nullptr || blockLength <= 0 || sampleRate <= 0) {
+      return;
+    }
+    if (resetRequested_.exchange(false)) {
+      channelStates_.fill(ChannelState{});
+    }
+    const auto decayInDbPerSecond = decayInDbPerSecond_.load(std::memory_order_relaxed);
+    // Factor by which a level falls within this block (1 = doesn't fall, 0 = falls immediately)
+    const auto decayFactor = decayInDbPerSecond > 0
+                             ? std::pow(10.0, -decayInDbPerSecond * blockLength / sampleRate / 20)
+                             : 0.0;
+    const auto holdSamples = holdTimeInMillis_.load(std::memory_order_relaxed) * sampleRate / 1000;
+    const auto channelCount = std::min(std::max(reg.output_nch, 0), MAX_CHANNEL_COUNT);
+    for (int i = 0; i < channelCount; i++) {
+      const auto buffer = reg.GetBuffer(true, i);
+      const auto measurement = buffer == nullptr
+                               ? util::PeakAndSumOfSquares{0, 0}
+                               : util::measurePeakAndSumOfSquares(buffer, blockLength);
+      auto& state = channelStates_[i];
+      auto& level = state.level;
+      level.peak = std::max(measurement.peak, level.peak * decayFactor);
+      level.rms = std::max(std::sqrt(measurement.sumOfSquares / blockLength), level.rms * decayFactor);
+      if (level.peak >= level.heldPeak) {
+        level.heldPeak = level.peak;
+        state.holdSamplesLeft = holdSamples;
+      } else if (state.holdSamplesLeft > 0) {
+        state.holdSamplesLeft -= blockLength;
+      } else {
+        level.heldPeak = level.peak;
+      }
+      levels_[i].store(level);
+    }
+    channelCount_.store(channelCount, std::memory_order_release);
+  }
+
+  int HardwareMeter::channelCount() const {
+    return channelCount_.load(std::memory_order_acquire);
+  }
+
+  HardwareMeterLevel HardwareMeter::level(int channelIndex) const {
+    if (channelIndex < 0 || channelIndex >= MAX_CHANNEL_COUNT) {
+      return HardwareMeterLevel{0, 0, 0};
+    }
+    return levels_[channelIndex].load();
+  }
+}
@@ -1,5 +1,6 @@
 #include <reaplus/HelperControlSurface.h>
 #include <utility>
+#include <algorithm>
 #include <reaplus/TrackSend.h>
 #include <reaplus/Reaper.h>
 #include <reaplus/TrackVolume.h>
@@ -24,12 +25,153 @@ using std::function;
 using std::mutex;
 using std::pair;
 using std::string;
-using std::set;
+using std::vector;
 using std::unique_ptr;
 using boost::none;
 using reaplus::util::logException;
 
 namespace reaplus {
+  namespace {
+    ControlSurfaceEvent makeEvent(ControlSurfaceEventKind kind, MediaTrack* mediaTrack = nullptr) {
+      ControlSurfaceEvent event;
+      event.kind = kind;
+      event.mediaTrack = mediaTrack;
+      return event;
+    }
+
+    ControlSurfaceEvent makeFxEvent(ControlSurfaceEventKind kind, const Fx& fx) {
+      auto event = makeEvent(kind, fx.track().mediaTrack());
+      event.isInputFx = fx.isInputFx();
+      event.index = fx.index();
+      return event;
+    }
+
+    TrackData readTrackData(MediaTrack* mediaTrack, int number) {
+      TrackData d;
+      d.recarm = reaper::GetMediaTrackInfo_Value(mediaTrack, "I_RECARM") != 0;
+      d.mute = reaper::GetMediaTrackInfo_Value(mediaTrack, "B_MUTE") != 0;
+      d.number = number;
+      d.pan = reaper::GetMediaTrackInfo_Value(mediaTrack, "D_PAN");
+      d.volume = reaper::GetMediaTrackInfo_Value(mediaTrack, "D_VOL");
+      d.selected = reaper::GetMediaTrackInfo_Value(mediaTrack, "I_SELECTED") != 0;
+      d.solo = reaper::GetMediaTrackInfo_Value(mediaTrack, "I_SOLO") != 0;
+      d.recmonitor = (int) reaper::GetMediaTrackInfo_Value(mediaTrack, "I_RECMON");
+      d.recinput = (int) reaper::GetMediaTrackInfo_Value(mediaTrack, "I_RECINPUT");
+      d.guid = *(GUID*) reaper::GetSetMediaTrackInfo(mediaTrack, "GUID", nullptr);
+      d.automationEpoch = 0;
+      d.automatedParameters = 0;
+      return d;
+    }
+
+    boost::optional<Track> trackOf(const ControlSurfaceEvent& event) {
+      return Track(event.mediaTrack, nullptr);
+    }
+
+    boost::optional<Project> projectOf(const ControlSurfaceEvent& event) {
+      return Project(event.reaProject);
+    }
+
+    boost::optional<TrackSend> trackSendOf(const ControlSurfaceEvent& event) {
+      return Track(event.mediaTrack, nullptr).indexBasedSendByIndex(event.index);
+    }
+
+    FxChain fxChainOf(const ControlSurfaceEvent& event) {
+      const Track track(event.mediaTrack, nullptr);
+      return event.isInputFx ? track.inputFxChain() : track.normalFxChain();
+    }
+
+    boost::optional<Fx> fxOf(const ControlSurfaceEvent& event) {
+      return fxChainOf(event).fxByIndex(event.index);
+    }
+
+    boost::optional<FxParameter> fxParameterOf(const ControlSurfaceEvent& event) {
+      if (const auto fx = fxOf(event)) {
+        return fx->parameterByIndex(event.subIndex);
+      } else {
+        return none;
+      }
+    }
+
+    boost::optional<bool> trueOf(const ControlSurfaceEvent&) {
+      return true;
+    }
+
+    boost::optional<ParameterRef> parameterRefOf(const ControlSurfaceEvent& event) {
+      switch (event.kind) {
+        case ControlSurfaceEventKind::FxParameterValueChanged:
+        case ControlSurfaceEventKind::FxParameterValueUnchanged:
+        case ControlSurfaceEventKind::FxParameterTouched:
+          return ParameterRef::fxParameter(event.mediaTrack, event.isInputFx, event.index, event.subIndex);
+        case ControlSurfaceEventKind::FxEnabledChanged:
+          return ParameterRef::fxEnable(event.mediaTrack, event.isInputFx, event.index);
+        case ControlSurfaceEventKind::TrackVolumeChanged:
+        case ControlSurfaceEventKind::TrackVolumeTouched:
+          return ParameterRef::trackParameter(ParameterType::TrackVolume, event.mediaTrack);
+        case ControlSurfaceEventKind::TrackPanChanged:
+        case ControlSurfaceEventKind::TrackPanTouched:
+          return ParameterRef::trackParameter(ParameterType::TrackPan, event.mediaTrack);
+        case ControlSurfaceEventKind::TrackArmChanged:
+          return ParameterRef::trackParameter(ParameterType::TrackArm, event.mediaTrack);
+        case ControlSurfaceEventKind::TrackMuteChanged:
+        case ControlSurfaceEventKind::TrackMuteTouched:
+          return ParameterRef::trackParameter(ParameterType::TrackMute, event.mediaTrack);
+        case ControlSurfaceEventKind::TrackSoloChanged:
+          return ParameterRef::trackParameter(ParameterType::TrackSolo, event.mediaTrack);
+        case ControlSurfaceEventKind::TrackSelectedChanged:
+          return ParameterRef::trackParameter(ParameterType::TrackSelection, event.mediaTrack);
+        case ControlSurfaceEventKind::MasterTempoChanged:
+        case ControlSurfaceEventKind::MasterTempoTouched:
+          return ParameterRef::masterTempo();
+        case ControlSurfaceEventKind::MasterPlayrateChanged:
+        case ControlSurfaceEventKind::MasterPlayrateTouched:
+          return ParameterRef::masterPlayrate();
+        case ControlSurfaceEventKind::TrackSendVolumeChanged:
+        case ControlSurfaceEventKind::TrackSendVolumeTouched:
+          return ParameterRef::trackSendParameter(ParameterType::TrackSendVolume, event.mediaTrack, event.index);
+        case ControlSurfaceEventKind::TrackSendPanChanged:
+        case ControlSurfaceEventKind::TrackSendPanTouched:
+          return ParameterRef::trackSendParameter(ParameterType::TrackSendPan, event.mediaTrack, event.index);
+        default:
+          return none;
+      }
+    }
+
+    constexpr ControlSurfaceEventMask PARAMETER_VALUE_CHANGED_MASK = eventMask(
+        ControlSurfaceEventKind::FxParameterValueChanged,
+        ControlSurfaceEventKind::FxEnabledChanged,
+        ControlSurfaceEventKind::TrackVolumeChanged,
+        ControlSurfaceEventKind::TrackPanChanged,
+        ControlSurfaceEventKind::TrackArmChanged,
+        ControlSurfaceEventKind::TrackMuteChanged,
+        ControlSurfaceEventKind::TrackSoloChanged,
+        ControlSurfaceEventKind::TrackSelectedChanged,
+        ControlSurfaceEventKind::MasterTempoChanged,
+        ControlSurfaceEventKind::MasterPlayrateChanged,
+        ControlSurfaceEventKind::TrackSendPanChanged,
+        ControlSurfaceEventKind::TrackSendVolumeChanged
+    );
+
+    Parameter* toParameterUnsafe(const ParameterRef& parameterRef) {
+      return parameterRef.toParameter().release();
+    }
+
+    bool isNotNull(Parameter* parameter) {
+      return parameter != nullptr;
+    }
+
+    template<typename T>
+    std::function<boost::optional<ValueChange<T>>(const ControlSurfaceEvent&)> valueChangeOf(
+        boost::optional<T> (* targetOf)(const ControlSurfaceEvent&)) {
+      return [targetOf](const ControlSurfaceEvent& event) -> boost::optional<ValueChange<T>> {
+        if (const auto target = targetOf(event)) {
+          return ValueChange<T>{*target, event.value};
+        } else {
+          return none;
+        }
+      };
+    }
+  }
+
   std::unique_ptr<HelperControlSurface> HelperControlSurface::INSTANCE = nullptr;
 
   HelperControlSurface::HelperControlSurface() :
@@ -39,6 +181,9 @@ namespace reaplus {
     const string reaperVersion = reaper::GetAppVersion();
     supportsDetectionOfInputFx_ = reaperVersion >= "5.95"; // since pre1
     supportsDetectionOfInputFxInSetFxChange_ = reaperVersion >= "5.95"; // since pre2 to be accurate but so what
+    // The fast command queue runs before feedback in Run(). Background reconciliation runs after it, so feedback
+    // scheduled until then waits for it, too.
+    mainThreadScheduler_.setWorkBeforeFeedback(FAST_COMMAND_BUDGET + BACKGROUND_PROJECT_BUDGET);
 
     // Register
     reaper::plugin_register("csurf_inst", this);
@@ -69,8 +214,75 @@ namespace reaplus {
     return subscription;
   }
 
-  void HelperControlSurface::enqueueCommandFast(std::function<void(void)> command) {
-    fastCommandQueue_.enqueue(std::move(command));
+  void HelperControlSurface::enqueueCommandFast(MainThreadTask command) {
+    fastCommandQueue_.push(std::move(command));
+  }
+
+  const MainThreadTaskQueue& HelperControlSurface::fastCommandQueue() const {
+    return fastCommandQueue_;
+  }
+
+  MainThreadScheduler& HelperControlSurface::mainThreadScheduler() {
+    return mainThreadScheduler_;
+  }
+
+  TimerWheel& HelperControlSurface::timerWheel() {
+    return timerWheel_;
+  }
+
+  void HelperControlSurface::executeInMainThreadFast(MainThreadTask command) {
+    if (Reaper::instance().currentThreadIsMainThread()) {
+      command();
+    } else {
+      enqueueCommandFast(std::move(command));
+    }
+  }
+
+  template<typename T>
+  rx::observable<T> HelperControlSurface::observeEvents(ControlSurfaceEventMask mask,
+      function<boost::optional<T>(const ControlSurfaceEvent&)> map) const {
+    // The event bus lives in the main thread, so (un)registration is marshalled to it. We go via INSTANCE instead of
+    // capturing this because the subscription might outlive this control surface.
+    return rx::observable<>::create<T>([mask, map](rx::subscriber<T> subscriber) {
+      // Subscribers aren't nothrow-movable, so they can't be captured by a main thread task directly
+      const auto sharedSubscriber = std::make_shared<rx::subscriber<T>>(std::move(subscriber));
+      HelperControlSurface::instance().executeInMainThreadFast([mask, map, sharedSubscriber] {
+        const auto& s = *sharedSubscriber;
+        if (INSTANCE == nullptr || !s.is_subscribed()) {
+          return;
+        }
+        const auto listenerId = INSTANCE->eventBus_.addListener(mask, [map, s](const ControlSurfaceEvent& event) {
+          if (const auto item = map(event)) {
+            s.on_next(*item);
+          }
+        });
+        s.add([listenerId] {
+          if (INSTANCE != nullptr) {
+            INSTANCE->executeInMainThreadFast([listenerId] {
+              if (INSTANCE != nullptr) {
+                INSTANCE->eventBus_.removeListener(listenerId);
+              }
+            });
+          }
+        });
+      });
+    });
+  }
+
+  ControlSurfaceEventBus& HelperControlSurface::eventBus() {
+    return eventBus_;
+  }
+
+  const FxParameterShadowTable& HelperControlSurface::fxParameterShadowTable() const {
+    return fxParameterShadowTable_;
+  }
+
+  void HelperControlSurface::publishAndCoalesce(ControlSurfaceEvent event, ControlSurfaceEventKind coalescedKind) {
+    eventBus_.publish(event);
+    if (eventBus_.hasListeners(coalescedKind)) {
+      event.kind = coalescedKind;
+      changeCoalescer_.mark(ChangeTargetKey(event), event);
+    }
   }
 
   const char* HelperControlSurface::GetTypeString() {
@@ -87,21 +299,35 @@ namespace reaplus {
 
   void HelperControlSurface::Run() {
     try {
+      mainThreadScheduler_.beginRun();
       // Invoke custom idle code
-      mainThreadIdleSubject_.get_subscriber().on_next(true);
-      // Process items from fast queue
-      const auto count = fastCommandQueue_.try_dequeue_bulk(fastCommandBuffer_.begin(), FAST_COMMAND_BUFFER_SIZE);
-      for (auto i = 0; i < count; i++) {
-        fastCommandBuffer_.at(i)();
+      eventBus_.publish(makeEvent(ControlSurfaceEventKind::MainThreadIdle));
+      // Deliver changes gathered since last cycle
+      flushCoalescedChanges();
+      // Deliver MIDI events captured in the audio thread
+      Reaper::instance().emitCapturedMidiEvents();
+      if (--runCyclesUntilMidiDevicePoll_ == 0) {
+        runCyclesUntilMidiDevicePoll_ = MIDI_DEVICE_POLL_INTERVAL_IN_RUN_CYCLES;
+        Reaper::instance().refreshMidiInputDevices();
       }
-      // Process items from slow queue
+      // Process items from fast queue
+      fastCommandQueue_.runFor(FAST_COMMAND_BUDGET);
+      // Fire due timers (LED blinking, touch timeouts, ...)
+      timerWheel_.advance(std::chrono::steady_clock::now());
+      mainThreadScheduler_.runPending(MainThreadPriority::Feedback);
+      mainThreadScheduler_.runPending(MainThreadPriority::UserAction);
+      // Process items from slow queue, they are treated like user actions
       const auto fixedNow = mainThreadRunLoop_.now();
-      const auto maxExecutionTime = std::chrono::milliseconds(50);
-      while (mainThreadRunLoop_.now() - fixedNow <= maxExecutionTime
-          && !mainThreadRunLoop_.empty()
-          && mainThreadRunLoop_.peek().when <= fixedNow) {
+      while (!mainThreadRunLoop_.empty()
+          && mainThreadRunLoop_.peek().when <= fixedNow
+          && mainThreadScheduler_.mayRun(MainThreadPriority::UserAction, mainThreadRunLoop_.peek().when)) {
         mainThreadRunLoop_.dispatch();
       }
+      // Keep track of background projects
+      reconcileTrackSets([this] {
+        detectTrackSetChangesInBackgroundProjects(BACKGROUND_PROJECT_BUDGET);
+      });
+      mainThreadScheduler_.runPending(MainThreadPriority::Background);
     } catch (...) {
       logException();
     }
@@ -110,13 +336,18 @@ namespace reaplus {
   void HelperControlSurface::SetSurfaceVolume(MediaTrack* trackid, double volume) {
     try {
       if (state() != State::PropagatingTrackSetChanges) {
-        if (auto td = findTrackDataByTrack(trackid)) {
-          if (td->volume != volume) {
-            td->volume = volume;
-            Track track(trackid, nullptr);
-            trackVolumeChangedSubject_.get_subscriber().on_next(track);
-            if (!trackParameterIsAutomated(track, "Volume")) {
-              trackVolumeTouchedSubject_.get_subscriber().on_next(track);
+        const auto location = findTrackData(trackid);
+        if (location.store != nullptr) {
+          auto& oldVolume = location.store->volumes[location.slot];
+          if (oldVolume != volume) {
+            oldVolume = volume;
+            auto event = makeEvent(ControlSurfaceEventKind::TrackVolumeChanged, trackid);
+            event.value = volume;
+            publishAndCoalesce(event, ControlSurfaceEventKind::TrackVolumeChangedCoalesced);
+            if (eventBus_.hasListeners(ControlSurfaceEventKind::TrackVolumeTouched)
+                && !trackParameterIsAutomated(trackid, location, AutomatedParameter::Volume)) {
+              event.kind = ControlSurfaceEventKind::TrackVolumeTouched;
+              eventBus_.publish(event);
             }
           }
         }
@@ -129,13 +360,18 @@ namespace reaplus {
   void HelperControlSurface::SetSurfacePan(MediaTrack* trackid, double pan) {
     try {
       if (state() != State::PropagatingTrackSetChanges) {
-        if (auto td = findTrackDataByTrack(trackid)) {
-          if (td->pan != pan) {
-            td->pan = pan;
-            Track track(trackid, nullptr);
-            trackPanChangedSubject_.get_subscriber().on_next(track);
-            if (!trackParameterIsAutomated(track, "Pan")) {
-              trackPanTouchedSubject_.get_subscriber().on_next(track);
+        const auto location = findTrackData(trackid);
+        if (location.store != nullptr) {
+          auto& oldPan = location.store->pans[location.slot];
+          if (oldPan != pan) {
+            oldPan = pan;
+            auto event = makeEvent(ControlSurfaceEventKind::TrackPanChanged, trackid);
+            event.value = pan;
+            publishAndCoalesce(event, ControlSurfaceEventKind::TrackPanChangedCoalesced);
+            if (eventBus_.hasListeners(ControlSurfaceEventKind::TrackPanTouched)
+                && !trackParameterIsAutomated(trackid, location, AutomatedParameter::Pan)) {
+              event.kind = ControlSurfaceEventKind::TrackPanTouched;
+              eventBus_.publish(event);
             }
           }
         }
@@ -164,7 +400,10 @@ namespace reaplus {
   }
 
   rx::observable<FxParameter> HelperControlSurface::fxParameterValueChanged() const {
-    return fxParameterValueChangedSubject_.get_observable();
+    return observeEvents<FxParameter>(
+        eventMask(ControlSurfaceEventKind::FxParameterValueChanged, ControlSurfaceEventKind::FxParameterValueUnchanged),
+        fxParameterOf
+    );
   }
 
   void HelperControlSurface::SetTrackTitle(MediaTrack* trackid, const char*) {
@@ -172,7 +411,7 @@ namespace reaplus {
       if (state() == State::PropagatingTrackSetChanges) {
         numTrackSetChangesLeftToBePropagated_--;
       } else {
-        trackNameChangedSubject_.get_subscriber().on_next(Track(trackid, nullptr));
+        eventBus_.publish(makeEvent(ControlSurfaceEventKind::TrackNameChanged, trackid));
       }
     } catch (...) {
       logException();
@@ -180,7 +419,7 @@ namespace reaplus {
   }
 
   rxcpp::observable<Fx> HelperControlSurface::fxEnabledChanged() const {
-    return fxEnabledChangedSubject_.get_observable();
+    return observeEvents<Fx>(eventMask(ControlSurfaceEventKind::FxEnabledChanged), fxOf);
   }
 
   rxcpp::observable<Fx> HelperControlSurface::fxEnabledTouched() const {
@@ -205,19 +444,26 @@ namespace reaplus {
         case CSURF_EXT_SETINPUTMONITOR: {
           if (state() != State::PropagatingTrackSetChanges) {
             const auto mediaTrack = (MediaTrack*) parm1;
-            if (auto td = findTrackDataByTrack(mediaTrack)) {
+            const auto location = findTrackData(mediaTrack);
+            if (location.store != nullptr) {
               {
                 const auto recmonitor = (int*) parm2;
-                if (td->recmonitor != *recmonitor) {
-                  td->recmonitor = *recmonitor;
-                  trackInputMonitoringChangedSubject_.get_subscriber().on_next(Track(mediaTrack, nullptr));
+                auto& oldRecmonitor = location.store->recmonitors[location.slot];
+                if (oldRecmonitor != *recmonitor) {
+                  oldRecmonitor = *recmonitor;
+                  auto event = makeEvent(ControlSurfaceEventKind::TrackInputMonitoringChanged, mediaTrack);
+                  event.value = oldRecmonitor;
+                  eventBus_.publish(event);
                 }
               }
               {
                 const auto recinput = (int) reaper::GetMediaTrackInfo_Value(mediaTrack, "I_RECINPUT");
-                if (td->recinput != recinput) {
-                  td->recinput = recinput;
-                  trackInputChangedSubject_.get_subscriber().on_next(Track(mediaTrack, nullptr));
+                auto& oldRecinput = location.store->recinputs[location.slot];
+                if (oldRecinput != recinput) {
+                  oldRecinput = recinput;
+                  auto event = makeEvent(ControlSurfaceEventKind::TrackInputChanged, mediaTrack);
+                  event.value = oldRecinput;
+                  eventBus_.publish(event);
                 }
               }
             }
@@ -250,7 +496,9 @@ namespace reaplus {
           // Unfortunately, we don't have a ReaProject* here. Therefore we pass a nullptr.
           const Track track(mediaTrack, nullptr);
           if (const auto fx = getFxFromParmFxIndex(track, parmFxIndex)) {
-            fxEnabledChangedSubject_.get_subscriber().on_next(*fx);
+            auto event = makeFxEvent(ControlSurfaceEventKind::FxEnabledChanged, *fx);
+            event.value = parm3 != nullptr;
+            eventBus_.publish(event);
           }
           return 0;
         }
@@ -258,20 +506,33 @@ namespace reaplus {
         case CSURF_EXT_SETSENDVOLUME:
         case CSURF_EXT_SETSENDPAN: {
           const auto mediaTrack = (MediaTrack*) parm1;
-          const int sendIdx = *(int*) parm2;
-          const Track track(mediaTrack, nullptr);
-          const auto trackSend = track.indexBasedSendByIndex(sendIdx);
+          auto event = makeEvent(ControlSurfaceEventKind::TrackSendVolumeChanged, mediaTrack);
+          event.index = *(int*) parm2;
+          event.value = parm3 ? *(double*) parm3 : 0;
           if (call == CSURF_EXT_SETSENDVOLUME) {
-            trackSendVolumeChangedSubject_.get_subscriber().on_next(trackSend);
+            if (parm3) {
+              publishAndCoalesce(event, ControlSurfaceEventKind::TrackSendVolumeChangedCoalesced);
+            } else {
+              eventBus_.publish(event);
+            }
             // Send volume touch event only if not automated
-            if (!trackParameterIsAutomated(track, "Send Volume")) {
-              trackSendVolumeTouchedSubject_.get_subscriber().on_next(trackSend);
+            if (eventBus_.hasListeners(ControlSurfaceEventKind::TrackSendVolumeTouched)
+                && !trackParameterIsAutomated(mediaTrack, findTrackData(mediaTrack), AutomatedParameter::SendVolume)) {
+              event.kind = ControlSurfaceEventKind::TrackSendVolumeTouched;
+              eventBus_.publish(event);
             }
           } else if (call == CSURF_EXT_SETSENDPAN) {
-            trackSendPanChangedSubject_.get_subscriber().on_next(trackSend);
+            event.kind = ControlSurfaceEventKind::TrackSendPanChanged;
+            if (parm3) {
+              publishAndCoalesce(event, ControlSurfaceEventKind::TrackSendPanChangedCoalesced);
+            } else {
+              eventBus_.publish(event);
+            }
             // Send pan touch event only if not automated
-            if (!trackParameterIsAutomated(track, "Send Pan")) {
-              trackSendPanTouchedSubject_.get_subscriber().on_next(trackSend);
+            if (eventBus_.hasListeners(ControlSurfaceEventKind::TrackSendPanTouched)
+                && !trackParameterIsAutomated(mediaTrack, findTrackData(mediaTrack), AutomatedParameter::SendPan)) {
+              event.kind = ControlSurfaceEventKind::TrackSendPanTouched;
+              eventBus_.publish(event);
             }
           }
           return 0;
@@ -280,7 +541,7 @@ namespace reaplus {
         case CSURF_EXT_SETFOCUSEDFX: {
           if (!parm1 || parm2 || !parm3) {
             // Clear focused FX
-            fxFocusedSubject_.get_subscriber().on_next(none);
+            eventBus_.publish(makeEvent(ControlSurfaceEventKind::FxFocused));
             return 0;
           }
           const auto mediaTrack = (MediaTrack*) parm1;
@@ -290,7 +551,7 @@ namespace reaplus {
           if (const auto fx = getFxFromParmFxIndex(track, parmFxIndex)) {
             // Because CSURF_EXT_SETFXCHANGE doesn't fire if FX pasted in REAPER < 5.95-pre2 and on chunk manipulations
             detectFxChangesOnTrack(Track(mediaTrack, nullptr), true, !fx->isInputFx(), fx->isInputFx());
-            fxFocusedSubject_.get_subscriber().on_next(*fx);
+            eventBus_.publish(makeFxEvent(ControlSurfaceEventKind::FxFocused, *fx));
           }
           return 0;
         }
@@ -306,11 +567,8 @@ namespace reaplus {
           if (const auto fx = getFxFromParmFxIndex(track, parmFxIndex)) {
             // Because CSURF_EXT_SETFXCHANGE doesn't fire if FX pasted in REAPER < 5.95-pre2 and on chunk manipulations
             detectFxChangesOnTrack(Track(mediaTrack, nullptr), true, !fx->isInputFx(), fx->isInputFx());
-            if (parm3 == 0) {
-              fxClosedSubject_.get_subscriber().on_next(*fx);
-            } else {
-              fxOpenedSubject_.get_subscriber().on_next(*fx);
-            }
+            const auto kind = parm3 == 0 ? ControlSurfaceEventKind::FxClosed : ControlSurfaceEventKind::FxOpened;
+            eventBus_.publish(makeFxEvent(kind, *fx));
           }
           return 0;
         }
@@ -338,16 +596,22 @@ namespace reaplus {
           // DONE-rust
         case CSURF_EXT_SETBPMANDPLAYRATE: {
           if (parm1) {
-            masterTempoChangedSubject_.get_subscriber().on_next(true);
+            auto event = makeEvent(ControlSurfaceEventKind::MasterTempoChanged);
+            event.value = *(double*) parm1;
+            eventBus_.publish(event);
             // If there's a tempo envelope, there are just tempo notifications when the tempo is actually changed.
             // So that's okay for "touched".
             // TODO What about gradual tempo changes?
-            masterTempoTouchedSubject_.get_subscriber().on_next(true);
+            event.kind = ControlSurfaceEventKind::MasterTempoTouched;
+            eventBus_.publish(event);
           }
           if (parm2) {
-            masterPlayrateChangedSubject_.get_subscriber().on_next(true);
+            auto event = makeEvent(ControlSurfaceEventKind::MasterPlayrateChanged);
+            event.value = *(double*) parm2;
+            eventBus_.publish(event);
             // FIXME What about playrate automation?
-            masterPlayrateTouchedSubject_.get_subscriber().on_next(true);
+            event.kind = ControlSurfaceEventKind::MasterPlayrateTouched;
+            eventBus_.publish(event);
           }
           return 0;
         }
@@ -362,57 +626,66 @@ namespace reaplus {
     const auto fxAndParamIndex = *static_cast<int*>(parm2);
     const int fxIndex = (fxAndParamIndex >> 16) & 0xffff;
     const int paramIndex = fxAndParamIndex & 0xffff;
-    // Unfortunately, we don't have a ReaProject* here. Therefore we pass a nullptr.
-    const Track track(mediaTrack, nullptr);
     const double paramValue = *(double*) parm3;
+    // Unfortunately, we don't have a ReaProject* here. Therefore we pass a nullptr.
     const bool isInputFx = supportsDetectionOfInputFx_
                            ? isInputFxIfSupported
-                           : isProbablyInputFx(track, fxIndex, paramIndex, paramValue);
-    const auto fxChain = isInputFx ? track.inputFxChain() : track.normalFxChain();
-    if (const auto fx = fxChain.fxByIndex(fxIndex)) {
-      const auto fxParam = fx->parameterByIndex(paramIndex);
-      fxParameterValueChangedSubject_.get_subscriber().on_next(fxParam);
-      if (fxHasBeenTouchedJustAMomentAgo_) {
-        fxHasBeenTouchedJustAMomentAgo_ = false;
-        fxParameterTouchedSubject_.get_subscriber().on_next(fxParam);
-      }
+                           : isProbablyInputFx(Track(mediaTrack, nullptr), fxIndex, paramIndex, paramValue);
+    const bool changed = fxParameterShadowTable_.update(mediaTrack, isInputFx, fxIndex, paramIndex, paramValue);
+    auto event = makeEvent(
+        changed ? ControlSurfaceEventKind::FxParameterValueChanged : ControlSurfaceEventKind::FxParameterValueUnchanged,
+        mediaTrack
+    );
+    event.isInputFx = isInputFx;
+    event.index = fxIndex;
+    event.subIndex = paramIndex;
+    event.value = paramValue;
+    if (changed) {
+      publishAndCoalesce(event, ControlSurfaceEventKind::FxParameterValueChangedCoalesced);
+    } else {
+      eventBus_.publish(event);
+    }
+    if (fxHasBeenTouchedJustAMomentAgo_) {
+      fxHasBeenTouchedJustAMomentAgo_ = false;
+      event.kind = ControlSurfaceEventKind::FxParameterTouched;
+      eventBus_.publish(event);
     }
   }
 
   rxcpp::observable<bool> HelperControlSurface::masterTempoChanged() const {
-    return masterTempoChangedSubject_.get_observable();
+    return observeEvents<bool>(eventMask(ControlSurfaceEventKind::MasterTempoChanged), trueOf);
   }
 
   rxcpp::observable<bool> HelperControlSurface::masterTempoTouched() const {
-    return masterTempoTouchedSubject_.get_observable();
+    return observeEvents<bool>(eventMask(ControlSurfaceEventKind::MasterTempoTouched), trueOf);
   }
 
   rxcpp::observable<bool> HelperControlSurface::masterPlayrateChanged() const {
-    return masterPlayrateChangedSubject_.get_observable();
+    return observeEvents<bool>(eventMask(ControlSurfaceEventKind::MasterPlayrateChanged), trueOf);
   }
 
   rxcpp::observable<bool> HelperControlSurface::masterPlayrateTouched() const {
-    return masterPlayrateTouchedSubject_.get_observable();
+    return observeEvents<bool>(eventMask(ControlSurfaceEventKind::MasterPlayrateTouched), trueOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackInputMonitoringChanged() const {
-    return trackInputMonitoringChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackInputMonitoringChanged), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackArmChanged() const {
-    return trackArmChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackArmChanged), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackMuteChanged() const {
-    return trackMuteChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackMuteChanged), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackMuteTouched() const {
-    return trackMuteTouchedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackMuteTouched), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackSoloChanged() const {
-    return trackSoloChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackSoloChanged), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackSoloTouched() const {
@@ -421,7 +694,7 @@ namespace reaplus {
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackSelectedChanged() const {
-    return trackSelectedChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackSelectedChanged), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackSelectedTouched() const {
@@ -435,107 +708,217 @@ namespace reaplus {
   }
 
   rxcpp::observable<Project> HelperControlSurface::projectClosed() const {
-    return projectClosedSubject_.get_observable();
+    return observeEvents<Project>(eventMask(ControlSurfaceEventKind::ProjectClosed), projectOf);
   }
 
   void HelperControlSurface::SetTrackListChange() {
     try {
-      // FIXME Not multi-project compatible!
-      const auto newActiveProject = Reaper::instance().currentProject();
-      if (newActiveProject != activeProjectBehavior_.get_value()) {
-        activeProjectBehavior_.get_subscriber().on_next(newActiveProject);
-      }
+      // REAPER reports the title of each track right after this, even if the reconciliation is deferred
       numTrackSetChangesLeftToBePropagated_ = reaper::CountTracks(nullptr) + 1;
-      removeInvalidReaProjects();
-      detectTrackSetChanges();
+      if (reconcilingTrackSets_) {
+        // Caused by a listener of a track set event
+        trackListChangeDeferred_ = true;
+        return;
+      }
+      reconcileTrackSets([this] {
+        reconcileActiveProject();
+      });
     } catch (...) {
       logException();
     }
   }
 
+  template<typename Reconcile>
+  void HelperControlSurface::reconcileTrackSets(Reconcile reconcile) {
+    reconcilingTrackSets_ = true;
+    try {
+      reconcile();
+      while (trackListChangeDeferred_) {
+        trackListChangeDeferred_ = false;
+        reconcileActiveProject();
+      }
+    } catch (...) {
+      reconcilingTrackSets_ = false;
+      throw;
+    }
+    reconcilingTrackSets_ = false;
+  }
+
+  void HelperControlSurface::reconcileActiveProject() {
+    const auto newActiveProject = Reaper::instance().currentProject();
+    if (newActiveProject != activeProjectBehavior_.get_value()) {
+      activeProjectBehavior_.get_subscriber().on_next(newActiveProject);
+    }
+    removeInvalidReaProjects();
+    invalidateAutomationStates();
+    activeReaProject_ = newActiveProject.reaProject();
+    activeTrackDataStore_ = &trackDataStoreByReaProject_[activeReaProject_];
+    detectTrackSetChanges(activeReaProject_, *activeTrackDataStore_);
+  }
+
   HelperControlSurface::State HelperControlSurface::state() const {
     return numTrackSetChangesLeftToBePropagated_ == 0 ? State::Normal : State::PropagatingTrackSetChanges;
   }
 
-  void HelperControlSurface::detectTrackSetChanges() {
-    const auto project = Reaper::instance().currentProject();
-    auto& oldTrackDatas = trackDataByMediaTrackByReaProject_[project.reaProject()];
-    const auto oldTrackCount = (int) oldTrackDatas.size();
-    const int newTrackCount = project.trackCount();
-    if (newTrackCount < oldTrackCount) {
-      removeInvalidMediaTracks(project, oldTrackDatas);
-    } else if (newTrackCount > oldTrackCount) {
-      addMissingMediaTracks(project, oldTrackDatas);
-    } else {
-      updateMediaTrackPositions(project, oldTrackDatas);
-    }
-  }
-
-  void HelperControlSurface::addMissingMediaTracks(const Project& project, TrackDataMap& trackDatas) {
-    project.tracks().subscribe(
-        [this, &trackDatas](Track track) {
-          auto mediaTrack = track.mediaTrack();
-          if (trackDatas.count(mediaTrack) == 0) {
-            TrackData d;
-            d.recarm = reaper::GetMediaTrackInfo_Value(mediaTrack, "I_RECARM") != 0;
-            d.mute = reaper::GetMediaTrackInfo_Value(mediaTrack, "B_MUTE") != 0;
-            d.number = (int) (size_t) reaper::GetSetMediaTrackInfo(mediaTrack, "IP_TRACKNUMBER", nullptr);
-            d.pan = reaper::GetMediaTrackInfo_Value(mediaTrack, "D_PAN");
-            d.volume = reaper::GetMediaTrackInfo_Value(mediaTrack, "D_VOL");
-            d.selected = reaper::GetMediaTrackInfo_Value(mediaTrack, "I_SELECTED") != 0;
-            d.solo = reaper::GetMediaTrackInfo_Value(mediaTrack, "I_SOLO") != 0;
-            d.recmonitor = (int) reaper::GetMediaTrackInfo_Value(mediaTrack, "I_RECMON");
-            d.recinput = (int) reaper::GetMediaTrackInfo_Value(mediaTrack, "I_RECINPUT");
-            d.guid = Track::getMediaTrackGuid(mediaTrack);
-            trackDatas[mediaTrack] = d;
-            trackAddedSubject_.get_subscriber().on_next(track);
-            detectFxChangesOnTrack(track, false, true, true);
-          }
-        },
-        util::getLoggingErrorHandler()
-    );
+  template<typename OnMove>
+  bool HelperControlSurface::forEachMove(const vector<pair<int, int>>& survivors, OnMove onMove) {
+    // Rank of each survivor in old order, indexed by old index. Old indexes are dense, so no sorting required.
+    auto& oldRanks = oldRanksBuffer_;
+    oldRanks.clear();
+    for (const auto& survivor : survivors) {
+      if (survivor.first >= (int) oldRanks.size()) {
+        oldRanks.resize((size_t) survivor.first + 1, -1);
+      }
+      oldRanks[survivor.first] = 0;
+    }
+    int rank = 0;
+    for (auto& oldRank : oldRanks) {
+      if (oldRank == 0) {
+        oldRank = rank++;
+      }
+    }
+    bool moved = false;
+    for (int newRank = 0; newRank < (int) survivors.size(); newRank++) {
+      const auto& survivor = survivors[newRank];
+      if (oldRanks[survivor.first] != newRank) {
+        moved = true;
+        onMove(survivor.first, survivor.second);
+      }
+    }
+    return moved;
   }
 
-  void HelperControlSurface::updateMediaTrackPositions(const Project& project,
-      HelperControlSurface::TrackDataMap& trackDatas) {
-    bool tracksHaveBeenReordered = false;
-    for (auto it = trackDatas.begin(); it != trackDatas.end();) {
-      const auto mediaTrack = it->first;
-      if (reaper::ValidatePtr2(project.reaProject(), (void*) mediaTrack, "MediaTrack*")) {
-        auto& trackData = it->second;
-        const auto newNumber = (int) (size_t) reaper::GetSetMediaTrackInfo(mediaTrack, "IP_TRACKNUMBER", nullptr);
-        if (newNumber != trackData.number) {
-          tracksHaveBeenReordered = true;
-          trackData.number = newNumber;
-        }
+  bool HelperControlSurface::detectTrackSetChanges(ReaProject* reaProject, TrackDataStore& trackDatas,
+      std::chrono::steady_clock::time_point deadline) {
+    // Snapshot of the current track list
+    auto& mediaTracks = mediaTracksBuffer_;
+    mediaTracks.clear();
+    const int trackCount = reaper::CountTracks(reaProject);
+    for (int i = 0; i < trackCount; i++) {
+      mediaTracks.push_back(reaper::GetTrack(reaProject, i));
+    }
+    // Match it against the known tracks
+    trackSeenBuffer_.assign((size_t) trackDatas.size(), 0);
+    addedTrackIndexesBuffer_.clear();
+    survivingTracksBuffer_.clear();
+    removedMediaTracksBuffer_.clear();
+    for (int i = 0; i < trackCount; i++) {
+      const auto slot = trackDatas.slotOf(mediaTracks[i]);
+      if (slot == TrackDataStore::NO_SLOT) {
+        addedTrackIndexesBuffer_.push_back(i);
+      } else {
+        trackSeenBuffer_[slot] = 1;
+        survivingTracksBuffer_.emplace_back(trackDatas.numbers[slot] - 1, i);
+        trackDatas.numbers[slot] = i + 1;
       }
-      it++;
     }
-    if (tracksHaveBeenReordered) {
-      tracksReorderedSubject_.get_subscriber().on_next(project);
+    // Backwards because removing a slot moves the last slot into it (which has been visited already)
+    for (auto slot = trackDatas.size() - 1; slot >= 0; slot--) {
+      if (!trackSeenBuffer_[slot]) {
+        fxChainPairByMediaTrack_.erase(trackDatas.mediaTracks[slot]);
+        removedMediaTracksBuffer_.push_back(trackDatas.mediaTracks[slot]);
+        auto event = makeEvent(ControlSurfaceEventKind::TrackRemoved);
+        event.reaProject = reaProject;
+        event.guid = trackDatas.guids[slot];
+        trackDatas.remove(slot);
+        eventBus_.publish(event);
+      }
     }
+    removeFxParameterShadowsOf(removedMediaTracksBuffer_);
+    bool complete = true;
+    for (std::size_t k = 0; k < addedTrackIndexesBuffer_.size(); k++) {
+      if (k > 0 && k % BACKGROUND_TRACK_CHUNK_SIZE == 0 && std::chrono::steady_clock::now() >= deadline) {
+        // The rest shows up as added again next time. Moves among the known tracks don't depend on it.
+        complete = false;
+        break;
+      }
+      const auto i = addedTrackIndexesBuffer_[k];
+      const auto mediaTrack = mediaTracks[i];
+      trackDatas.add(mediaTrack, readTrackData(mediaTrack, i + 1));
+      eventBus_.publish(makeEvent(ControlSurfaceEventKind::TrackAdded, mediaTrack));
+      detectFxChangesOnTrack(Track(mediaTrack, reaProject), false, true, true);
+    }
+    if (eventBus_.hasListeners(ControlSurfaceEventKind::TrackMoved)
+        || eventBus_.hasListeners(ControlSurfaceEventKind::TracksReordered)) {
+      const bool moved = forEachMove(survivingTracksBuffer_, [this, reaProject](int oldIndex, int newIndex) {
+        auto event = makeEvent(ControlSurfaceEventKind::TrackMoved, mediaTracksBuffer_[newIndex]);
+        event.reaProject = reaProject;
+        event.index = oldIndex;
+        event.subIndex = newIndex;
+        eventBus_.publish(event);
+      });
+      if (moved) {
+        auto event = makeEvent(ControlSurfaceEventKind::TracksReordered);
+        event.reaProject = reaProject;
+        eventBus_.publish(event);
+      }
+    }
+    return complete;
   }
 
-  TrackData* HelperControlSurface::findTrackDataByTrack(MediaTrack* mediaTrack) {
-    const auto project = Reaper::instance().currentProject();
-    auto& trackDatas = trackDataByMediaTrackByReaProject_[project.reaProject()];
-    if (trackDatas.count(mediaTrack) == 0) {
-      return nullptr;
-    } else {
-      return &trackDatas.at(mediaTrack);
+  TrackDataLocation HelperControlSurface::findTrackData(MediaTrack* mediaTrack) {
+    if (activeTrackDataStore_ != nullptr) {
+      const auto slot = activeTrackDataStore_->slotOf(mediaTrack);
+      if (slot != TrackDataStore::NO_SLOT) {
+        return TrackDataLocation{activeReaProject_, activeTrackDataStore_, slot};
+      }
+    }
+    // Track in background project. In REAPER < 5.95 this returns nullptr, so we only support the active project there.
+    const auto reaProject = (ReaProject*) reaper::GetSetMediaTrackInfo(mediaTrack, "P_PROJECT", nullptr);
+    if (reaProject == nullptr || reaProject == activeReaProject_) {
+      return TrackDataLocation();
+    }
+    const auto it = trackDataStoreByReaProject_.find(reaProject);
+    if (it == trackDataStoreByReaProject_.end()) {
+      return TrackDataLocation();
+    }
+    const auto slot = it->second.slotOf(mediaTrack);
+    if (slot == TrackDataStore::NO_SLOT) {
+      return TrackDataLocation();
+    }
+    return TrackDataLocation{reaProject, &it->second, slot};
+  }
+
+  void HelperControlSurface::detectTrackSetChangesInBackgroundProjects(std::chrono::steady_clock::duration budget) {
+    if (activeReaProject_ == nullptr) {
+      // Wait for the first SetTrackListChange
+      return;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    int projectCount = 0;
+    while (reaper::EnumProjects(projectCount, nullptr, 0) != nullptr) {
+      projectCount++;
+    }
+    for (int i = 0; i < projectCount && std::chrono::steady_clock::now() < deadline; i++) {
+      if (nextBackgroundProjectIndex_ >= projectCount) {
+        nextBackgroundProjectIndex_ = 0;
+      }
+      const auto reaProject = reaper::EnumProjects(nextBackgroundProjectIndex_, nullptr, 0);
+      if (reaProject != activeReaProject_
+          && !detectTrackSetChanges(reaProject, trackDataStoreByReaProject_[reaProject], deadline)) {
+        // Continue with this project in the next Run()
+        return;
+      }
+      nextBackgroundProjectIndex_++;
     }
   }
 
+
   void HelperControlSurface::SetSurfaceMute(MediaTrack* trackid, bool mute) {
     try {
       if (state() != State::PropagatingTrackSetChanges) {
-        if (auto td = findTrackDataByTrack(trackid)) {
-          if (td->mute != mute) {
-            td->mute = mute;
-            Track track(trackid, nullptr);
-            trackMuteChangedSubject_.get_subscriber().on_next(track);
-            if (!trackParameterIsAutomated(track, "Mute")) {
-              trackMuteTouchedSubject_.get_subscriber().on_next(track);
+        const auto location = findTrackData(trackid);
+        if (location.store != nullptr) {
+          auto& oldMute = location.store->mutes[location.slot];
+          if (oldMute != mute) {
+            oldMute = mute;
+            auto event = makeEvent(ControlSurfaceEventKind::TrackMuteChanged, trackid);
+            event.value = mute;
+            eventBus_.publish(event);
+            if (eventBus_.hasListeners(ControlSurfaceEventKind::TrackMuteTouched)
+                && !trackParameterIsAutomated(trackid, location, AutomatedParameter::Mute)) {
+              event.kind = ControlSurfaceEventKind::TrackMuteTouched;
+              eventBus_.publish(event);
             }
           }
         }
@@ -548,11 +931,14 @@ namespace reaplus {
   void HelperControlSurface::SetSurfaceSelected(MediaTrack* trackid, bool selected) {
     try {
       if (state() != State::PropagatingTrackSetChanges) {
-        if (auto td = findTrackDataByTrack(trackid)) {
-          if (td->selected != selected) {
-            td->selected = selected;
-            Track track(trackid, nullptr);
-            trackSelectedChangedSubject_.get_subscriber().on_next(track);
+        const auto location = findTrackData(trackid);
+        if (location.store != nullptr) {
+          auto& oldSelected = location.store->selecteds[location.slot];
+          if (oldSelected != selected) {
+            oldSelected = selected;
+            auto event = makeEvent(ControlSurfaceEventKind::TrackSelectedChanged, trackid);
+            event.value = selected;
+            eventBus_.publish(event);
           }
         }
       }
@@ -564,11 +950,14 @@ namespace reaplus {
   void HelperControlSurface::SetSurfaceSolo(MediaTrack* trackid, bool solo) {
     try {
       if (state() != State::PropagatingTrackSetChanges) {
-        if (auto td = findTrackDataByTrack(trackid)) {
-          if (td->solo != solo) {
-            td->solo = solo;
-            Track track(trackid, nullptr);
-            trackSoloChangedSubject_.get_subscriber().on_next(track);
+        const auto location = findTrackData(trackid);
+        if (location.store != nullptr) {
+          auto& oldSolo = location.store->solos[location.slot];
+          if (oldSolo != solo) {
+            oldSolo = solo;
+            auto event = makeEvent(ControlSurfaceEventKind::TrackSoloChanged, trackid);
+            event.value = solo;
+            eventBus_.publish(event);
           }
         }
       }
@@ -580,11 +969,14 @@ namespace reaplus {
   void HelperControlSurface::SetSurfaceRecArm(MediaTrack* trackid, bool recarm) {
     try {
       if (state() != State::PropagatingTrackSetChanges) {
-        if (auto td = findTrackDataByTrack(trackid)) {
-          if (td->recarm != recarm) {
-            td->recarm = recarm;
-            Track track(trackid, nullptr);
-            trackArmChangedSubject_.get_subscriber().on_next(track);
+        const auto location = findTrackData(trackid);
+        if (location.store != nullptr) {
+          auto& oldRecarm = location.store->recarms[location.slot];
+          if (oldRecarm != recarm) {
+            oldRecarm = recarm;
+            auto event = makeEvent(ControlSurfaceEventKind::TrackArmChanged, trackid);
+            event.value = recarm;
+            eventBus_.publish(event);
           }
         }
       }
@@ -593,67 +985,75 @@ namespace reaplus {
     }
   }
 
-  void HelperControlSurface::removeInvalidMediaTracks(const Project& project, TrackDataMap& trackDatas) {
-    for (auto it = trackDatas.begin(); it != trackDatas.end();) {
-      const auto mediaTrack = it->first;
-      const auto trackData = it->second;
-      if (reaper::ValidatePtr2(project.reaProject(), (void*) mediaTrack, "MediaTrack*")) {
+  void HelperControlSurface::removeInvalidReaProjects() {
+    for (auto it = trackDataStoreByReaProject_.begin(); it != trackDataStoreByReaProject_.end();) {
+      const auto project = it->first;
+      if (reaper::ValidatePtr2(nullptr, (void*) project, "ReaProject*")) {
         it++;
       } else {
-        fxChainPairByMediaTrack_.erase(mediaTrack);
-        trackRemovedSubject_.get_subscriber().on_next(project.trackByGuid(trackData.guid));
-        it = trackDatas.erase(it);
+        // MediaTrack pointers of a closed project could be reused for new tracks
+        auto mediaTracks = it->second.mediaTracks;
+        for (const auto mediaTrack : mediaTracks) {
+          fxChainPairByMediaTrack_.erase(mediaTrack);
+        }
+        removeFxParameterShadowsOf(mediaTracks);
+        auto event = makeEvent(ControlSurfaceEventKind::ProjectClosed);
+        event.reaProject = project;
+        eventBus_.publish(event);
+        it = trackDataStoreByReaProject_.erase(it);
       }
     }
   }
 
-  void HelperControlSurface::removeInvalidReaProjects() {
-    for (auto it = trackDataByMediaTrackByReaProject_.begin(); it != trackDataByMediaTrackByReaProject_.end();) {
-      const auto pair = *it;
-      const auto project = pair.first;
-      if (reaper::ValidatePtr2(nullptr, (void*) project, "ReaProject*")) {
-        it++;
-      } else {
-        projectClosedSubject_.get_subscriber().on_next(Project(project));
-        it = trackDataByMediaTrackByReaProject_.erase(it);
-      }
+  void HelperControlSurface::removeFxParameterShadowsOf(vector<MediaTrack*>& mediaTracks) {
+    if (mediaTracks.empty()) {
+      return;
     }
+    std::sort(mediaTracks.begin(), mediaTracks.end());
+    fxParameterShadowTable_.removeTracks([&mediaTracks](MediaTrack* mediaTrack) {
+      return std::binary_search(mediaTracks.begin(), mediaTracks.end(), mediaTrack);
+    });
   }
 
   rx::observable<Track> HelperControlSurface::trackRemoved() const {
-    return trackRemovedSubject_.get_observable();
+    return observeEvents<Track>(
+        eventMask(ControlSurfaceEventKind::TrackRemoved),
+        [](const ControlSurfaceEvent& event) -> boost::optional<Track> {
+          return Project(event.reaProject).trackByGuid(convertGuidToString(event.guid));
+        }
+    );
   }
 
   rx::observable<Track> HelperControlSurface::trackAdded() const {
-    return trackAddedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackAdded), trackOf);
   }
 
   rx::observable<Track> HelperControlSurface::trackVolumeChanged() const {
-    return trackVolumeChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackVolumeChanged), trackOf);
   }
 
   rx::observable<Track> HelperControlSurface::trackPanChanged() const {
-    return trackPanChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackPanChanged), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackNameChanged() const {
-    return trackNameChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackNameChanged), trackOf);
   }
 
   rxcpp::observable<Track> HelperControlSurface::trackInputChanged() const {
-    return trackInputChangedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackInputChanged), trackOf);
   }
 
   rx::observable<TrackSend> HelperControlSurface::trackSendVolumeChanged() const {
-    return trackSendVolumeChangedSubject_.get_observable();
+    return observeEvents<TrackSend>(eventMask(ControlSurfaceEventKind::TrackSendVolumeChanged), trackSendOf);
   }
 
   rxcpp::observable<TrackSend> HelperControlSurface::trackSendPanChanged() const {
-    return trackSendPanChangedSubject_.get_observable();
+    return observeEvents<TrackSend>(eventMask(ControlSurfaceEventKind::TrackSendPanChanged), trackSendOf);
   }
 
   rxcpp::observable<TrackSend> HelperControlSurface::trackSendPanTouched() const {
-    return trackSendPanTouchedSubject_.get_observable();
+    return observeEvents<TrackSend>(eventMask(ControlSurfaceEventKind::TrackSendPanTouched), trackSendOf);
   }
 
   const rxcpp::observe_on_one_worker& HelperControlSurface::mainThreadCoordination() const {
@@ -665,112 +1065,197 @@ namespace reaplus {
   }
 
   rx::observable<Track> HelperControlSurface::fxReordered() const {
-    return fxReorderedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::FxReordered), trackOf);
+  }
+
+  rx::observable<FxChainReordering> HelperControlSurface::fxChainReordered() const {
+    // The moves of one chain are published as FxMoved events right before its FxReordered event. Accumulate them per
+    // subscription.
+    return rx::observable<>::defer([this] {
+      auto moves = std::make_shared<vector<FxMove>>();
+      return observeEvents<FxChainReordering>(
+          eventMask(ControlSurfaceEventKind::FxMoved, ControlSurfaceEventKind::FxReordered),
+          [moves](const ControlSurfaceEvent& event) -> boost::optional<FxChainReordering> {
+            if (event.kind == ControlSurfaceEventKind::FxMoved) {
+              moves->push_back(FxMove{event.index, event.subIndex});
+              return none;
+            }
+            FxChainReordering reordering{fxChainOf(event), std::move(*moves)};
+            moves->clear();
+            return reordering;
+          }
+      );
+    });
   }
   rxcpp::observable<Fx> HelperControlSurface::fxOpened() const {
-    return fxOpenedSubject_.get_observable();
+    return observeEvents<Fx>(eventMask(ControlSurfaceEventKind::FxOpened), fxOf);
   }
   rxcpp::observable<Fx> HelperControlSurface::fxClosed() const {
-    return fxClosedSubject_.get_observable();
+    return observeEvents<Fx>(eventMask(ControlSurfaceEventKind::FxClosed), fxOf);
   }
   rxcpp::observable<boost::optional<Fx>> HelperControlSurface::fxFocused() const {
-    return fxFocusedSubject_.get_observable();
+    return observeEvents<boost::optional<Fx>>(
+        eventMask(ControlSurfaceEventKind::FxFocused),
+        [](const ControlSurfaceEvent& event) -> boost::optional<boost::optional<Fx>> {
+          if (event.mediaTrack == nullptr) {
+            // No FX focused anymore
+            return boost::make_optional(boost::optional<Fx>());
+          }
+          if (const auto fx = fxOf(event)) {
+            return boost::make_optional(fx);
+          } else {
+            return none;
+          }
+        }
+    );
   }
 
   void HelperControlSurface::detectFxChangesOnTrack(Track track, bool notifyListenersAboutChanges,
       bool checkNormalFxChain, bool checkInputFxChain) {
     if (track.isAvailable()) {
-      MediaTrack* mediaTrack = track.mediaTrack();
-      auto& fxChainPair = fxChainPairByMediaTrack_[mediaTrack];
-      const bool addedOrRemovedOutputFx =
-          checkNormalFxChain
-          ? detectFxChangesOnTrack(track, fxChainPair.outputFxGuids, false, notifyListenersAboutChanges)
-          : false;
-      const bool addedOrRemovedInputFx =
-          checkInputFxChain
-          ? detectFxChangesOnTrack(track, fxChainPair.inputFxGuids, true, notifyListenersAboutChanges)
-          : false;
-      if (notifyListenersAboutChanges && !addedOrRemovedInputFx && !addedOrRemovedOutputFx) {
-        fxReorderedSubject_.get_subscriber().on_next(track);
+      auto& fxChainPair = fxChainPairByMediaTrack_[track.mediaTrack()];
+      if (checkNormalFxChain) {
+        detectFxChangesOnTrack(track, fxChainPair.outputFxGuids, false, notifyListenersAboutChanges);
+      }
+      if (checkInputFxChain) {
+        detectFxChangesOnTrack(track, fxChainPair.inputFxGuids, true, notifyListenersAboutChanges);
       }
     }
   }
 
-  bool HelperControlSurface::detectFxChangesOnTrack(Track track,
-      set<string>& oldFxGuids,
-      bool isInputFx,
-      bool notifyListenersAboutChanges) {
-    const auto oldFxCount = (int) oldFxGuids.size();
-    const int newFxCount = (isInputFx ? track.inputFxChain() : track.normalFxChain()).fxCount();
-    if (newFxCount < oldFxCount) {
-      removeInvalidFx(track, oldFxGuids, isInputFx, notifyListenersAboutChanges);
-      return true;
-    } else if (newFxCount > oldFxCount) {
-      addMissingFx(track, oldFxGuids, isInputFx, notifyListenersAboutChanges);
-      return true;
-    } else {
-      // Reordering (or nothing)
-      return false;
-    }
-  }
-
-  void HelperControlSurface::removeInvalidFx(Track track,
-      std::set<string>& oldFxGuids,
+  void HelperControlSurface::detectFxChangesOnTrack(Track track,
+      vector<IndexedFxGuid>& oldFxGuids,
       bool isInputFx,
       bool notifyListenersAboutChanges) {
-    const auto newFxGuids = fxGuidsOnTrack(track, isInputFx);
-    for (auto it = oldFxGuids.begin(); it != oldFxGuids.end();) {
-      const string oldFxGuid = *it;
-      if (newFxGuids.count(oldFxGuid)) {
-        it++;
-      } else {
+    const auto mediaTrack = track.mediaTrack();
+    auto& newFxGuids = newFxGuidsBuffer_;
+    readFxGuids(track, isInputFx, newFxGuids);
+    addedFxGuidsBuffer_.clear();
+    survivingFxBuffer_.clear();
+    // Walk both GUID-sorted lists in parallel
+    auto oldIt = oldFxGuids.begin();
+    auto newIt = newFxGuids.begin();
+    bool indexesChanged = false;
+    while (oldIt != oldFxGuids.end() || newIt != newFxGuids.end()) {
+      if (newIt == newFxGuids.end() || (oldIt != oldFxGuids.end() && oldIt->guid < newIt->guid)) {
         if (notifyListenersAboutChanges) {
-          const auto fxChain = isInputFx ? track.inputFxChain() : track.normalFxChain();
-          fxRemovedSubject_.get_subscriber().on_next(fxChain.fxByGuid(oldFxGuid));
+          auto event = makeEvent(ControlSurfaceEventKind::FxRemoved, mediaTrack);
+          event.isInputFx = isInputFx;
+          event.guid = oldIt->guid.data();
+          eventBus_.publish(event);
         }
-        it = oldFxGuids.erase(it);
+        indexesChanged = true;
+        ++oldIt;
+      } else if (oldIt == oldFxGuids.end() || newIt->guid < oldIt->guid) {
+        addedFxGuidsBuffer_.push_back(*newIt);
+        indexesChanged = true;
+        ++newIt;
+      } else {
+        survivingFxBuffer_.emplace_back(oldIt->index, newIt->index);
+        indexesChanged = indexesChanged || oldIt->index != newIt->index;
+        ++oldIt;
+        ++newIt;
+      }
+    }
+    if (notifyListenersAboutChanges) {
+      // Added FX in chain order
+      std::sort(addedFxGuidsBuffer_.begin(), addedFxGuidsBuffer_.end(),
+          [](const IndexedFxGuid& lhs, const IndexedFxGuid& rhs) {
+            return lhs.index < rhs.index;
+          });
+      for (const auto& added : addedFxGuidsBuffer_) {
+        auto event = makeEvent(ControlSurfaceEventKind::FxAdded, mediaTrack);
+        event.isInputFx = isInputFx;
+        event.index = added.index;
+        event.guid = added.guid.data();
+        eventBus_.publish(event);
       }
+      publishFxMoves(mediaTrack, isInputFx);
+    }
+    if (indexesChanged) {
+      // Shadow values are keyed by FX index
+      fxParameterShadowTable_.removeFxChain(mediaTrack, isInputFx);
     }
+    oldFxGuids.swap(newFxGuids);
   }
 
-  void HelperControlSurface::addMissingFx(Track track,
-      std::set<string>& fxGuids,
-      bool isInputFx,
-      bool notifyListenersAboutChanges) {
-    const auto fxChain = isInputFx ? track.inputFxChain() : track.normalFxChain();
-    fxChain.fxs().subscribe(
-        [this, &fxGuids, notifyListenersAboutChanges](Fx fx) {
-          bool wasInserted = fxGuids.insert(fx.guid()).second;
-          if (wasInserted && notifyListenersAboutChanges) {
-            fxAddedSubject_.get_subscriber().on_next(fx);
-          }
-        },
-        util::getLoggingErrorHandler()
-    );
+  void HelperControlSurface::publishFxMoves(MediaTrack* mediaTrack, bool isInputFx) {
+    if (!eventBus_.hasListeners(ControlSurfaceEventKind::FxMoved)
+        && !eventBus_.hasListeners(ControlSurfaceEventKind::FxReordered)) {
+      return;
+    }
+    // Survivors are still in GUID order
+    auto& survivingFx = survivingFxBuffer_;
+    std::sort(survivingFx.begin(), survivingFx.end(), [](const pair<int, int>& lhs, const pair<int, int>& rhs) {
+      return lhs.second < rhs.second;
+    });
+    const bool moved = forEachMove(survivingFx, [this, mediaTrack, isInputFx](int oldIndex, int newIndex) {
+      auto event = makeEvent(ControlSurfaceEventKind::FxMoved, mediaTrack);
+      event.isInputFx = isInputFx;
+      event.index = oldIndex;
+      event.subIndex = newIndex;
+      eventBus_.publish(event);
+    });
+    if (moved) {
+      auto event = makeEvent(ControlSurfaceEventKind::FxReordered, mediaTrack);
+      event.isInputFx = isInputFx;
+      eventBus_.publish(event);
+    }
   }
 
-  std::set<string> HelperControlSurface::fxGuidsOnTrack(Track track, bool isInputFx) const {
+  void HelperControlSurface::readFxGuids(Track track, bool isInputFx, vector<IndexedFxGuid>& fxGuids) const {
+    fxGuids.clear();
     const auto fxChain = isInputFx ? track.inputFxChain() : track.normalFxChain();
-    std::set<string> fxGuids;
-    fxChain.fxs().subscribe(
-        [&fxGuids](Fx fx) {
-          fxGuids.insert(fx.guid());
-        },
-        util::getLoggingErrorHandler()
-    );
-    return fxGuids;
+    const int fxCount = fxChain.fxCount();
+    for (int i = 0; i < fxCount; i++) {
+      if (const auto guid = reaper::TrackFX_GetFXGUID(track.mediaTrack(), Fx::queryIndex(i, isInputFx))) {
+        fxGuids.push_back(IndexedFxGuid{Guid(*guid), i});
+      }
+    }
+    std::sort(fxGuids.begin(), fxGuids.end(), [](const IndexedFxGuid& lhs, const IndexedFxGuid& rhs) {
+      return lhs.guid < rhs.guid;
+    });
   }
 
   rx::observable<Fx> HelperControlSurface::fxAdded() const {
-    return fxAddedSubject_.get_observable();
+    return observeEvents<Fx>(
+        eventMask(ControlSurfaceEventKind::FxAdded),
+        [](const ControlSurfaceEvent& event) -> boost::optional<Fx> {
+          return fxChainOf(event).fxByGuidAndIndex(convertGuidToString(event.guid), event.index);
+        }
+    );
   }
 
   rx::observable<Fx> HelperControlSurface::fxRemoved() const {
-    return fxRemovedSubject_.get_observable();
+    return observeEvents<Fx>(
+        eventMask(ControlSurfaceEventKind::FxRemoved),
+        [](const ControlSurfaceEvent& event) -> boost::optional<Fx> {
+          return fxChainOf(event).fxByGuid(convertGuidToString(event.guid));
+        }
+    );
   }
 
   rx::observable<Project> HelperControlSurface::tracksReordered() const {
-    return tracksReorderedSubject_.get_observable();
+    return observeEvents<Project>(eventMask(ControlSurfaceEventKind::TracksReordered), projectOf);
+  }
+
+  rx::observable<TrackListReordering> HelperControlSurface::trackListReordered() const {
+    // Like fxChainReordered()
+    return rx::observable<>::defer([this] {
+      auto moves = std::make_shared<vector<TrackMove>>();
+      return observeEvents<TrackListReordering>(
+          eventMask(ControlSurfaceEventKind::TrackMoved, ControlSurfaceEventKind::TracksReordered),
+          [moves](const ControlSurfaceEvent& event) -> boost::optional<TrackListReordering> {
+            if (event.kind == ControlSurfaceEventKind::TrackMoved) {
+              moves->push_back(TrackMove{event.index, event.subIndex});
+              return none;
+            }
+            TrackListReordering reordering{Project(event.reaProject), std::move(*moves)};
+            moves->clear();
+            return reordering;
+          }
+      );
+    });
   }
 
   bool HelperControlSurface::isProbablyInputFx(Track track, int fxIndex, int paramIndex, double fxValue) const {
@@ -788,6 +1273,25 @@ namespace reaplus {
           // We don't have a parameter number at our disposal so we need to guess - we guess normal FX TODO
           return false;
         } else {
+          // A repeated report of a known value can be attributed without asking REAPER
+          const auto outputShadow = fxParameterShadowTable_.find(mediaTrack, false, fxIndex, paramIndex);
+          const auto inputShadow = fxParameterShadowTable_.find(mediaTrack, true, fxIndex, paramIndex);
+          const bool matchesOutputShadow = outputShadow != nullptr && outputShadow->value == fxValue;
+          const bool matchesInputShadow = inputShadow != nullptr && inputShadow->value == fxValue;
+          if (matchesOutputShadow != matchesInputShadow) {
+            return matchesInputShadow;
+          }
+          // An actual change most likely belongs to the parameter which is being moved, that is the one which changed
+          // recently. Only ambiguous if both or none of them changed recently.
+          const auto latestSequence = fxParameterShadowTable_.sequence();
+          const auto changedRecently = [latestSequence](const FxParameterShadowTable::Entry* entry) {
+            return entry != nullptr && entry->sequence + FX_PARAMETER_ATTRIBUTION_WINDOW > latestSequence;
+          };
+          const bool outputChangedRecently = changedRecently(outputShadow);
+          const bool inputChangedRecently = changedRecently(inputShadow);
+          if (outputChangedRecently != inputChangedRecently) {
+            return inputChangedRecently;
+          }
           // Compare parameter values (a heuristic but so what, it's just for MIDI learn)
           if (const auto outputFx = track.normalFxChain().fxByIndex(fxIndex)) {
             FxParameter outputFxParam = outputFx->parameterByIndex(paramIndex);
@@ -804,94 +1308,53 @@ namespace reaplus {
     }
   }
 
+  rx::observable<ParameterRef> HelperControlSurface::parameterValueChanged() const {
+    return observeEvents<ParameterRef>(PARAMETER_VALUE_CHANGED_MASK, parameterRefOf);
+  }
+
+  rx::observable<ParameterRef> HelperControlSurface::parameterTouched() const {
+    // Arm, solo, selection and FX enable have no automation envelope, so touched = changed
+    return observeEvents<ParameterRef>(
+        eventMask(
+            ControlSurfaceEventKind::FxParameterTouched,
+            ControlSurfaceEventKind::FxEnabledChanged,
+            ControlSurfaceEventKind::TrackVolumeTouched,
+            ControlSurfaceEventKind::TrackPanTouched,
+            ControlSurfaceEventKind::TrackArmChanged,
+            ControlSurfaceEventKind::TrackMuteTouched,
+            ControlSurfaceEventKind::TrackSoloChanged,
+            ControlSurfaceEventKind::TrackSelectedChanged,
+            ControlSurfaceEventKind::MasterTempoTouched,
+            ControlSurfaceEventKind::MasterPlayrateTouched,
+            ControlSurfaceEventKind::TrackSendPanTouched,
+            ControlSurfaceEventKind::TrackSendVolumeTouched
+        ),
+        parameterRefOf
+    );
+  }
+
   rx::observable<Parameter*> HelperControlSurface::parameterValueChangedUnsafe() const {
-    return fxParameterValueChanged().map([this](FxParameter fxParam) -> Parameter* {
-          return new FxParameter(fxParam);
-        })
-        .merge(fxEnabledChanged().map([this](Fx fx) -> Parameter* {
-          return new FxEnable(fx);
-        }))
-        .merge(trackVolumeChanged().map([this](Track track) -> Parameter* {
-          return new TrackVolume(track);
-        }))
-        .merge(trackPanChanged().map([this](Track track) -> Parameter* {
-          return new TrackPan(track);
-        }))
-        .merge(trackArmChanged().map([this](Track track) -> Parameter* {
-          return new TrackArm(track);
-        }))
-        .merge(trackMuteChanged().map([this](Track track) -> Parameter* {
-          return new TrackMute(track);
-        }))
-        .merge(trackSoloChanged().map([this](Track track) -> Parameter* {
-          return new TrackSolo(track);
-        }))
-        .merge(trackSelectedChanged().map([this](Track track) -> Parameter* {
-          return new TrackSelection(track);
-        }))
-        .merge(masterTempoChanged().map([](bool) -> Parameter* {
-          return new MasterTempo();
-        }))
-        .merge(masterPlayrateChanged().map([](bool) -> Parameter* {
-          return new MasterPlayrate();
-        }))
-        .merge(trackSendPanChanged().map([this](TrackSend trackSend) -> Parameter* {
-          return new TrackSendPan(trackSend);
-        }))
-        .merge(trackSendVolumeChanged().map([this](TrackSend trackSend) -> Parameter* {
-          return new TrackSendVolume(trackSend);
-        }));
+    // Like fxParameterValueChanged(), this always reported FX parameter values even if unchanged
+    return observeEvents<ParameterRef>(
+        PARAMETER_VALUE_CHANGED_MASK | eventMask(ControlSurfaceEventKind::FxParameterValueUnchanged),
+        parameterRefOf
+    ).map(toParameterUnsafe).filter(isNotNull);
   }
 
   rx::observable<Parameter*> HelperControlSurface::parameterTouchedUnsafe() const {
-    return fxParameterTouched().map([this](FxParameter fxParam) -> Parameter* {
-          return new FxParameter(fxParam);
-        })
-        .merge(fxEnabledTouched().map([this](Fx fx) -> Parameter* {
-          return new FxEnable(fx);
-        }))
-        .merge(trackVolumeTouched().map([this](Track track) -> Parameter* {
-          return new TrackVolume(track);
-        }))
-        .merge(trackPanTouched().map([this](Track track) -> Parameter* {
-          return new TrackPan(track);
-        }))
-        .merge(trackArmTouched().map([this](Track track) -> Parameter* {
-          return new TrackArm(track);
-        }))
-        .merge(trackMuteTouched().map([this](Track track) -> Parameter* {
-          return new TrackMute(track);
-        }))
-        .merge(trackSoloTouched().map([this](Track track) -> Parameter* {
-          return new TrackSolo(track);
-        }))
-        .merge(trackSelectedTouched().map([this](Track track) -> Parameter* {
-          return new TrackSelection(track);
-        }))
-        .merge(masterTempoTouched().map([](bool) -> Parameter* {
-          return new MasterTempo();
-        }))
-        .merge(masterPlayrateTouched().map([](bool) -> Parameter* {
-          return new MasterPlayrate();
-        }))
-        .merge(trackSendPanTouched().map([this](TrackSend trackSend) -> Parameter* {
-          return new TrackSendPan(trackSend);
-        }))
-        .merge(trackSendVolumeTouched().map([this](TrackSend trackSend) -> Parameter* {
-          return new TrackSendVolume(trackSend);
-        }));
+    return parameterTouched().map(toParameterUnsafe).filter(isNotNull);
   }
 
   rx::observable<FxParameter> HelperControlSurface::fxParameterTouched() const {
-    return fxParameterTouchedSubject_.get_observable();
+    return observeEvents<FxParameter>(eventMask(ControlSurfaceEventKind::FxParameterTouched), fxParameterOf);
   }
 
   rx::observable<Track> HelperControlSurface::trackVolumeTouched() const {
-    return trackVolumeTouchedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackVolumeTouched), trackOf);
   }
 
   rx::observable<Track> HelperControlSurface::trackPanTouched() const {
-    return trackPanTouchedSubject_.get_observable();
+    return observeEvents<Track>(eventMask(ControlSurfaceEventKind::TrackPanTouched), trackOf);
   }
 
   rx::observable<Track> HelperControlSurface::trackArmTouched() const {
@@ -900,28 +1363,120 @@ namespace reaplus {
   }
 
   rx::observable<TrackSend> HelperControlSurface::trackSendVolumeTouched() const {
-    return trackSendVolumeTouchedSubject_.get_observable();
+    return observeEvents<TrackSend>(eventMask(ControlSurfaceEventKind::TrackSendVolumeTouched), trackSendOf);
   }
   rxcpp::observable<bool> HelperControlSurface::mainThreadIdle() const {
-    return mainThreadIdleSubject_.get_observable();
-  }
-
-  bool HelperControlSurface::trackParameterIsAutomated(Track track, string parameterName) const {
-    if (track.isAvailable() && reaper::GetTrackEnvelopeByName(track.mediaTrack(), parameterName.c_str()) != nullptr) {
-      // There's at least one automation lane for this parameter
-      auto automationMode = track.effectiveAutomationMode();
-      switch (automationMode) {
-        case AutomationMode::Bypass:
-        case AutomationMode::TrimRead:
-        case AutomationMode::Write:
-          // Is not automated
-          return false;
-        default:
-          // Is automated
-          return true;
+    return observeEvents<bool>(eventMask(ControlSurfaceEventKind::MainThreadIdle), trueOf);
+  }
+
+  rxcpp::observable<ValueChange<FxParameter>> HelperControlSurface::fxParameterValueChangedCoalesced() const {
+    return observeEvents<ValueChange<FxParameter>>(
+        eventMask(ControlSurfaceEventKind::FxParameterValueChangedCoalesced),
+        valueChangeOf(&fxParameterOf)
+    );
+  }
+
+  rxcpp::observable<ValueChange<Track>> HelperControlSurface::trackVolumeChangedCoalesced() const {
+    return observeEvents<ValueChange<Track>>(
+        eventMask(ControlSurfaceEventKind::TrackVolumeChangedCoalesced),
+        valueChangeOf(&trackOf)
+    );
+  }
+
+  rxcpp::observable<ValueChange<Track>> HelperControlSurface::trackPanChangedCoalesced() const {
+    return observeEvents<ValueChange<Track>>(
+        eventMask(ControlSurfaceEventKind::TrackPanChangedCoalesced),
+        valueChangeOf(&trackOf)
+    );
+  }
+
+  rxcpp::observable<ValueChange<TrackSend>> HelperControlSurface::trackSendVolumeChangedCoalesced() const {
+    return observeEvents<ValueChange<TrackSend>>(
+        eventMask(ControlSurfaceEventKind::TrackSendVolumeChangedCoalesced),
+        valueChangeOf(&trackSendOf)
+    );
+  }
+
+  rxcpp::observable<ValueChange<TrackSend>> HelperControlSurface::trackSendPanChangedCoalesced() const {
+    return observeEvents<ValueChange<TrackSend>>(
+        eventMask(ControlSurfaceEventKind::TrackSendPanChangedCoalesced),
+        valueChangeOf(&trackSendOf)
+    );
+  }
+
+  void HelperControlSurface::flushCoalescedChanges() {
+    changeCoalescer_.flush([this](const ControlSurfaceEvent& event) {
+      eventBus_.publish(event);
+    });
+  }
+
+  bool HelperControlSurface::trackParameterIsAutomated(MediaTrack* mediaTrack, const TrackDataLocation& location,
+      AutomatedParameter parameter) {
+    const auto bit = automatedParameterBit(parameter);
+    if (location.store == nullptr) {
+      return (queryAutomatedParameters(mediaTrack) & bit) != 0;
+    }
+    auto& store = *location.store;
+    if (store.automationEpochs[location.slot] != automationEpoch_) {
+      store.automatedParameters[location.slot] = queryAutomatedParameters(mediaTrack);
+      store.automationEpochs[location.slot] = automationEpoch_;
+    }
+    return (store.automatedParameters[location.slot] & bit) != 0;
+  }
+
+  std::uint8_t HelperControlSurface::queryAutomatedParameters(MediaTrack* mediaTrack) const {
+    // Unfortunately, we don't have a ReaProject* here. Therefore we pass a nullptr.
+    if (!Track(mediaTrack, nullptr).isAvailable()) {
+      return 0;
+    }
+    auto automationMode = static_cast<AutomationMode>(reaper::GetGlobalAutomationOverride());
+    if (automationMode == AutomationMode::NoOverride) {
+      automationMode = static_cast<AutomationMode>(reaper::GetTrackAutomationMode(mediaTrack));
+    }
+    switch (automationMode) {
+      case AutomationMode::Bypass:
+      case AutomationMode::TrimRead:
+      case AutomationMode::Write:
+        // Is not automated
+        return 0;
+      default:
+        break;
+    }
+    // Automated if there's at least one automation lane for the parameter
+    static const std::pair<AutomatedParameter, const char*> envelopeNames[] = {
+        {AutomatedParameter::Volume, "Volume"},
+        {AutomatedParameter::Pan, "Pan"},
+        {AutomatedParameter::Mute, "Mute"},
+        {AutomatedParameter::SendVolume, "Send Volume"},
+        {AutomatedParameter::SendPan, "Send Pan"}
+    };
+    std::uint8_t automatedParameters = 0;
+    for (const auto& envelopeName : envelopeNames) {
+      if (reaper::GetTrackEnvelopeByName(mediaTrack, envelopeName.second) != nullptr) {
+        automatedParameters |= automatedParameterBit(envelopeName.first);
       }
-    } else {
-      return false;
     }
+    return automatedParameters;
   }
+
+  void HelperControlSurface::invalidateAutomationStates() {
+    automationEpoch_++;
+    if (automationEpoch_ == 0) {
+      // Wrapped around, 0 is reserved for "not cached yet"
+      automationEpoch_ = 1;
+      for (auto& pair : trackDataStoreByReaProject_) {
+        auto& epochs = pair.second.automationEpochs;
+        std::fill(epochs.begin(), epochs.end(), 0);
+      }
+    }
+  }
+
+  void HelperControlSurface::SetAutoMode(int) {
+    try {
+      invalidateAutomationStates();
+    } catch (...) {
+      logException();
+    }
+  }
+
 }
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include <reaplus/HighResolutionMidiAssembler.h>
+
+namespace reaplus {
+  namespace {
+    constexpr int CHANNEL_COUNT = 16;
+    constexpr unsigned char DATA_ENTRY_MSB = 6;
+    constexpr unsigned char DATA_ENTRY_LSB = 38;
+    constexpr unsigned char NRPN_LSB = 98;
+    constexpr unsigned char NRPN_MSB = 99;
+    constexpr unsigned char RPN_LSB = 100;
+    constexpr unsigned char RPN_MSB = 101;
+
+    CapturedMidiEventKind dataEntryKind(CapturedMidiEventKind parameterKind, bool is14Bit) {
+      if (parameterKind == CapturedMidiEventKind::Nrpn7Bit) {
+        return is14Bit ? CapturedMidiEventKind::Nrpn14Bit : CapturedMidiEventKind::Nrpn7Bit;
+      }
+      return is14Bit ? CapturedMidiEventKind::Rpn14Bit : CapturedMidiEventKind::Rpn7Bit;
+    }
+
+    CapturedMidiEvent assemble(const CapturedMidiEvent& rawEvent, CapturedMidiEventKind kind, int number,
+        int value) {
+      auto event = rawEvent;
+      event.kind = kind;
+      event.data1 = 0;
+      event.data2 = 0;
+      event.number = static_cast<std::uint16_t>(number);
+      event.value = static_cast<std::uint16_t>(value);
+      return event;
+    }
+  }
+
+  HighResolutionMidiAssembler::HighResolutionMidiAssembler() :
+      channelStates_(new ChannelState[MAX_DEVICE_COUNT * CHANNEL_COUNT]) {
+    reset();
+  }
+
+  bool HighResolutionMidiAssembler::process(const CapturedMidiEvent& event, CapturedMidiEvent& assembledEvent) {
+    if ((event.status & 0xf0) != 0xb0 || event.inputDeviceId < 0 || event.inputDeviceId >= MAX_DEVICE_COUNT) {
+      return false;
+    }
+    auto& state = channelStates_[event.inputDeviceId * CHANNEL_COUNT + (event.status & 0x0f)];
+    const auto controller = event.data1;
+    const auto value = static_cast<std::int8_t>(event.data2 & 0x7f);
+    const bool parameterSelected = state.parameterKind != CapturedMidiEventKind::Raw
+                                   && state.parameterMsb != UNKNOWN && state.parameterLsb != UNKNOWN;
+    // Data entry belongs to the selected parameter, if any
+    if (parameterSelected && controller == DATA_ENTRY_MSB) {
+      state.dataMsb = value;
+      assembledEvent = assemble(event, dataEntryKind(state.parameterKind, false),
+          (state.parameterMsb << 7) | state.parameterLsb, value);
+      return true;
+    }
+    if (parameterSelected && controller == DATA_ENTRY_LSB) {
+      if (state.dataMsb == UNKNOWN) {
+        return false;
+      }
+      assembledEvent = assemble(event, dataEntryKind(state.parameterKind, true),
+          (state.parameterMsb << 7) | state.parameterLsb, (state.dataMsb << 7) | value);
+      return true;
+    }
+    switch (controller) {
+      case NRPN_MSB:
+        selectParameter(state, CapturedMidiEventKind::Nrpn7Bit, true, value);
+        return false;
+      case NRPN_LSB:
+        selectParameter(state, CapturedMidiEventKind::Nrpn7Bit, false, value);
+        return false;
+      case RPN_MSB:
+        selectParameter(state, CapturedMidiEventKind::Rpn7Bit, true, value);
+        return false;
+      case RPN_LSB:
+        selectParameter(state, CapturedMidiEventKind::Rpn7Bit, false, value);
+        return false;
+      default:
+        break;
+    }
+    if (controller < 32) {
+      state.controlMsbs[controller] = value;
+      return false;
+    }
+    if (controller < 64) {
+      const auto msb = state.controlMsbs[controller - 32];
+      if (msb == UNKNOWN) {
+        return false;
+      }
+      assembledEvent = assemble(event, CapturedMidiEventKind::ControlChange14Bit, controller - 32,
+          (msb << 7) | value);
+      return true;
+    }
+    return false;
+  }
+
+  void HighResolutionMidiAssembler::reset() {
+    for (int i = 0; i < MAX_DEVICE_COUNT * CHANNEL_COUNT; i++) {
+      auto& state = channelStates_[i];
+      for (auto& msb : state.controlMsbs) {
+        msb = UNKNOWN;
+      }
+      state.parameterKind = CapturedMidiEventKind::Raw;
+      state.parameterMsb = UNKNOWN;
+      state.parameterLsb = UNKNOWN;
+      state.dataMsb = UNKNOWN;
+    }
+  }
+
+  void HighResolutionMidiAssembler::selectParameter(ChannelState& state, CapturedMidiEventKind kind, bool isMsb,
+      std::int8_t value) {
+    if (state.parameterKind != kind) {
+      // Switching between NRPN and RPN, the other half is not valid anymore
+      state.parameterKind = kind;
+      state.parameterMsb = UNKNOWN;
+      state.parameterLsb = UNKNOWN;
+    }
+    if (isMsb) {
+      state.parameterMsb = value;
+    } else {
+      state.parameterLsb = value;
+    }
+    state.dataMsb = UNKNOWN;
+    // RPN null function
+    if (kind == CapturedMidiEventKind::Rpn7Bit && state.parameterMsb == 127 && state.parameterLsb == 127) {
+      state.parameterKind = CapturedMidiEventKind::Raw;
+      state.parameterMsb = UNKNOWN;
+      state.parameterLsb = UNKNOWN;
+    }
+  }
+}
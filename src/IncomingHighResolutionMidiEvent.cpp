@@ -0,0 +1,46 @@
+#include <reaplus/IncomingHighResolutionMidiEvent.h>
+
+namespace reaplus {
+  IncomingHighResolutionMidiEvent::IncomingHighResolutionMidiEvent(MidiInputDevice inputDevice,
+      HighResolutionMidiEventKind kind, int channel, int number, int value, bool is14Bit, int frameOffset,
+      std::uint64_t samplePosition, double sampleRate)
+      : inputDevice_(inputDevice), kind_(kind), channel_(channel), number_(number), value_(value), is14Bit_(is14Bit),
+        frameOffset_(frameOffset), samplePosition_(samplePosition), sampleRate_(sampleRate) {
+  }
+
+  MidiInputDevice IncomingHighResolutionMidiEvent::inputDevice() const {
+    return inputDevice_;
+  }
+
+  HighResolutionMidiEventKind IncomingHighResolutionMidiEvent::kind() const {
+    return kind_;
+  }
+
+  int IncomingHighResolutionMidiEvent::channel() const {
+    return channel_;
+  }
+
+  int IncomingHighResolutionMidiEvent::number() const {
+    return number_;
+  }
+
+  int IncomingHighResolutionMidiEvent::value() const {
+    return value_;
+  }
+
+  bool IncomingHighResolutionMidiEvent::is14Bit() const {
+    return is14Bit_;
+  }
+
+  int IncomingHighResolutionMidiEvent::getFrameOffset() const {
+    return frameOffset_;
+  }
+
+  std::uint64_t IncomingHighResolutionMidiEvent::samplePosition() const {
+    return samplePosition_;
+  }
+
+  double IncomingHighResolutionMidiEvent::sampleRate() const {
+    return sampleRate_;
+  }
+}
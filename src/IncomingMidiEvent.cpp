@@ -16,7 +16,21 @@ namespace reaplus {
     return frameOffset_;
   }
 
-  IncomingMidiEvent::IncomingMidiEvent(MidiInputDevice inputDevice, MidiMessage message, int frameOffset)
-      : inputDevice_(inputDevice), message_(std::move(message)), frameOffset_(frameOffset) {
+  std::uint64_t IncomingMidiEvent::samplePosition() const {
+    return samplePosition_;
+  }
+
+  double IncomingMidiEvent::sampleRate() const {
+    return sampleRate_;
+  }
+
+  double IncomingMidiEvent::timeInSeconds() const {
+    return sampleRate_ > 0 ? samplePosition_ / sampleRate_ : 0;
+  }
+
+  IncomingMidiEvent::IncomingMidiEvent(MidiInputDevice inputDevice, MidiMessage message, int frameOffset,
+      std::uint64_t samplePosition, double sampleRate)
+      : inputDevice_(inputDevice), message_(std::move(message)), frameOffset_(frameOffset),
+        samplePosition_(samplePosition), sampleRate_(sampleRate) {
   }
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#include <reaplus/IncomingMidiEventBlock.h>
+
+namespace reaplus {
+  IncomingMidiEventBlock::IncomingMidiEventBlock(std::uint64_t blockIndex, const IncomingMidiEvent* events,
+      std::size_t size) : blockIndex_(blockIndex), events_(events), size_(size) {
+  }
+
+  std::uint64_t IncomingMidiEventBlock::blockIndex() const {
+    return blockIndex_;
+  }
+
+  std::size_t IncomingMidiEventBlock::size() const {
+    return size_;
+  }
+
+  bool IncomingMidiEventBlock::empty() const {
+    return size_ == 0;
+  }
+
+  const IncomingMidiEvent& IncomingMidiEventBlock::operator[](std::size_t index) const {
+    return events_[index];
+  }
+
+  const IncomingMidiEvent* IncomingMidiEventBlock::begin() const {
+    return events_;
+  }
+
+  const IncomingMidiEvent* IncomingMidiEventBlock::end() const {
+    return events_ + size_;
+  }
+}
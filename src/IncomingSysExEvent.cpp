@@ -0,0 +1,34 @@
+#include <reaplus/IncomingSysExEvent.h>
+#include <utility>
+
+namespace reaplus {
+  IncomingSysExEvent::IncomingSysExEvent(MidiInputDevice inputDevice, std::shared_ptr<const unsigned char> data,
+      std::size_t size, int frameOffset, std::uint64_t samplePosition, double sampleRate)
+      : inputDevice_(inputDevice), data_(std::move(data)), size_(size), frameOffset_(frameOffset),
+        samplePosition_(samplePosition), sampleRate_(sampleRate) {
+  }
+
+  MidiInputDevice IncomingSysExEvent::inputDevice() const {
+    return inputDevice_;
+  }
+
+  const unsigned char* IncomingSysExEvent::data() const {
+    return data_.get();
+  }
+
+  std::size_t IncomingSysExEvent::size() const {
+    return size_;
+  }
+
+  int IncomingSysExEvent::getFrameOffset() const {
+    return frameOffset_;
+  }
+
+  std::uint64_t IncomingSysExEvent::samplePosition() const {
+    return samplePosition_;
+  }
+
+  double IncomingSysExEvent::sampleRate() const {
+    return sampleRate_;
+  }
+}
@@ -0,0 +1,131 @@
+#include <reaplus/MainThreadScheduler.h>
+#include <reaplus/util/log.h>
+#include <algorithm>
+#include <iterator>
+
+using reaplus::util::logException;
+
+namespace reaplus {
+  namespace {
+    // REAPER calls Run() about 30 times per second
+    constexpr std::chrono::microseconds INITIAL_RUN_INTERVAL{33000};
+    // Weight of the newest measurement in the smoothed Run() interval
+    constexpr double RUN_INTERVAL_SMOOTHING = 0.125;
+    constexpr std::int64_t DEFAULT_DEADLINE_MICROS[] = {0, 100000, 1000000};
+
+    std::chrono::microseconds budgetFor(std::chrono::microseconds runInterval) {
+      const auto budget = std::chrono::microseconds(
+          static_cast<std::int64_t>(runInterval.count() * MainThreadScheduler::BUDGET_FRACTION)
+      );
+      return std::min(std::max(budget, MainThreadScheduler::MIN_BUDGET), MainThreadScheduler::MAX_BUDGET);
+    }
+  }
+
+  constexpr std::chrono::microseconds MainThreadScheduler::MIN_BUDGET;
+  constexpr std::chrono::microseconds MainThreadScheduler::MAX_BUDGET;
+  constexpr std::chrono::microseconds MainThreadScheduler::DEFAULT_FEEDBACK_LATENCY_TARGET;
+
+  MainThreadScheduler::MainThreadScheduler() : runStart_(Clock::now()), runInterval_(INITIAL_RUN_INTERVAL),
+      budget_(budgetFor(INITIAL_RUN_INTERVAL)) {
+    for (std::size_t i = 0; i < PRIORITY_COUNT; i++) {
+      deadlineMicros_[i].store(DEFAULT_DEADLINE_MICROS[i]);
+    }
+  }
+
+  void MainThreadScheduler::setDeadline(MainThreadPriority priority, std::chrono::microseconds deadline) {
+    deadlineMicros_[index(priority)].store(deadline.count());
+  }
+
+  std::chrono::microseconds MainThreadScheduler::deadline(MainThreadPriority priority) const {
+    return std::chrono::microseconds(deadlineMicros_[index(priority)].load());
+  }
+
+  void MainThreadScheduler::setFeedbackLatencyTarget(std::chrono::microseconds target) {
+    feedbackLatencyTargetMicros_.store(target.count());
+  }
+
+  std::chrono::microseconds MainThreadScheduler::feedbackLatencyTarget() const {
+    return std::chrono::microseconds(feedbackLatencyTargetMicros_.load());
+  }
+
+  void MainThreadScheduler::setWorkBeforeFeedback(std::chrono::microseconds duration) {
+    workBeforeFeedbackMicros_.store(duration.count());
+  }
+
+  std::chrono::microseconds MainThreadScheduler::workBeforeFeedback() const {
+    return std::chrono::microseconds(workBeforeFeedbackMicros_.load());
+  }
+
+  void MainThreadScheduler::beginRun() {
+    const auto now = Clock::now();
+    if (hasRunBefore_) {
+      const auto interval = std::chrono::duration_cast<std::chrono::microseconds>(now - runStart_);
+      runInterval_ = std::chrono::microseconds(static_cast<std::int64_t>(
+          runInterval_.count() + RUN_INTERVAL_SMOOTHING * (interval.count() - runInterval_.count())
+      ));
+      budget_ = budgetFor(runInterval_);
+    }
+    hasRunBefore_ = true;
+    runStart_ = now;
+    for (std::size_t i = 0; i < PRIORITY_COUNT; i++) {
+      auto& pending = pending_[i];
+      std::size_t count;
+      while ((count = inbound_[i].try_dequeue_bulk(batch_.begin(), batch_.size())) > 0) {
+        std::move(batch_.begin(), batch_.begin() + count, std::back_inserter(pending));
+      }
+    }
+  }
+
+  void MainThreadScheduler::runPending(MainThreadPriority priority) {
+    auto& pending = pending_[index(priority)];
+    auto& statistics = statistics_[index(priority)];
+    while (!pending.empty() && mayRun(priority, pending.front().scheduleTime)) {
+      // Take it out first, the task might schedule or run other tasks
+      auto entry = std::move(pending.front());
+      pending.pop_front();
+      statistics.executedCount++;
+      statistics.maxLatency = std::max(statistics.maxLatency,
+          std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - entry.scheduleTime));
+      try {
+        entry.task();
+      } catch (...) {
+        logException();
+      }
+    }
+  }
+
+  bool MainThreadScheduler::mayRun(MainThreadPriority priority, std::chrono::steady_clock::time_point waitingSince)
+  const {
+    const auto now = Clock::now();
+    const auto elapsed = now - runStart_;
+    if (priority == MainThreadPriority::Background
+        && elapsed + runInterval_ + workBeforeFeedback() >= feedbackLatencyTarget()) {
+      return false;
+    }
+    return elapsed < budget_ || (now - waitingSince >= deadline(priority) && elapsed < MAX_BUDGET);
+  }
+
+  std::chrono::microseconds MainThreadScheduler::runInterval() const {
+    return runInterval_;
+  }
+
+  std::chrono::microseconds MainThreadScheduler::budget() const {
+    return budget_;
+  }
+
+  std::size_t MainThreadScheduler::pendingCount(MainThreadPriority priority) const {
+    return pending_[index(priority)].size();
+  }
+
+  std::uint64_t MainThreadScheduler::executedCount(MainThreadPriority priority) const {
+    return statistics_[index(priority)].executedCount;
+  }
+
+  std::chrono::microseconds MainThreadScheduler::maxLatency(MainThreadPriority priority) const {
+    return statistics_[index(priority)].maxLatency;
+  }
+
+  std::size_t MainThreadScheduler::index(MainThreadPriority priority) {
+    return static_cast<std::size_t>(priority);
+  }
+}
@@ -0,0 +1,70 @@
+#include <reaplus/MainThreadTaskQueue.h>
+#include <reaplus/util/log.h>
+
+using reaplus::util::logException;
+
+namespace reaplus {
+  MainThreadTaskQueue::MainThreadTaskQueue() = default;
+
+  MainThreadTaskQueue::MainThreadTaskQueue(std::size_t initialCapacity) : tasks_(initialCapacity) {
+  }
+
+  std::size_t MainThreadTaskQueue::runFor(std::chrono::microseconds budget) {
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t executed = 0;
+    while (true) {
+      const auto count = tasks_.try_dequeue_bulk(batch_.begin(), BATCH_SIZE);
+      if (count == 0) {
+        break;
+      }
+      for (std::size_t i = 0; i < count; i++) {
+        auto& entry = batch_[i];
+        const auto latencyMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - entry.pushTime
+        ).count();
+        totalLatencyMicros_.fetch_add(latencyMicros, std::memory_order_relaxed);
+        if (latencyMicros > maxLatencyMicros_.load(std::memory_order_relaxed)) {
+          maxLatencyMicros_.store(latencyMicros, std::memory_order_relaxed);
+        }
+        // One failing task shouldn't take the rest of the batch down with it
+        try {
+          entry.task();
+        } catch (...) {
+          logException();
+        }
+        entry.task.reset();
+      }
+      executed += count;
+      executedCount_.fetch_add(count, std::memory_order_relaxed);
+      if (std::chrono::steady_clock::now() - start >= budget) {
+        deferredCount_.fetch_add(tasks_.size_approx(), std::memory_order_relaxed);
+        break;
+      }
+    }
+    return executed;
+  }
+
+  std::size_t MainThreadTaskQueue::size() const {
+    return tasks_.size_approx();
+  }
+
+  std::uint64_t MainThreadTaskQueue::executedCount() const {
+    return executedCount_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t MainThreadTaskQueue::deferredCount() const {
+    return deferredCount_.load(std::memory_order_relaxed);
+  }
+
+  std::chrono::microseconds MainThreadTaskQueue::averageLatency() const {
+    const auto executedCount = executedCount_.load(std::memory_order_relaxed);
+    if (executedCount == 0) {
+      return std::chrono::microseconds(0);
+    }
+    return std::chrono::microseconds(totalLatencyMicros_.load(std::memory_order_relaxed) / (std::int64_t) executedCount);
+  }
+
+  std::chrono::microseconds MainThreadTaskQueue::maxLatency() const {
+    return std::chrono::microseconds(maxLatencyMicros_.load(std::memory_order_relaxed));
+  }
+}
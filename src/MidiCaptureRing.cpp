@@ -0,0 +1,33 @@
+#include <reaplus/MidiCaptureRing.h>
+
+namespace reaplus {
+  namespace {
+    std::size_t nextPowerOfTwo(std::size_t n) {
+      std::size_t result = 1;
+      while (result < n) {
+        result <<= 1;
+      }
+      return result;
+    }
+  }
+
+  MidiCaptureRing::MidiCaptureRing(std::size_t capacity) : slots_(nextPowerOfTwo(capacity)),
+      mask_(slots_.size() - 1) {
+  }
+
+  std::size_t MidiCaptureRing::capacity() const {
+    return slots_.size();
+  }
+
+  std::size_t MidiCaptureRing::size() const {
+    return writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_acquire);
+  }
+
+  std::uint64_t MidiCaptureRing::overflowCount() const {
+    return overflowCount_.load(std::memory_order_relaxed);
+  }
+
+  std::size_t MidiCaptureRing::highWaterMark() const {
+    return highWaterMark_.load(std::memory_order_relaxed);
+  }
+}
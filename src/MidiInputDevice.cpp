@@ -1,5 +1,6 @@
 #include <reaplus/MidiInputDevice.h>
 #include <reaplus/utility.h>
+#include <reaplus/Reaper.h>
 #include <reaper_plugin_functions.h>
 
 namespace reaplus {
@@ -11,12 +12,19 @@ namespace reaplus {
   }
 
   std::string MidiInputDevice::name() const {
+    if (const auto device = findInSnapshot()) {
+      return device->name;
+    }
     return reaplus::toString(33, [this](char* buffer, int maxSize) {
       reaper::GetMIDIInputName(id_, buffer, maxSize);
     });
   }
 
   bool MidiInputDevice::isAvailable() const {
+    if (findInSnapshot() != nullptr) {
+      return true;
+    }
+    // Maybe added since the last refresh
     char name[2] = {0};
     const bool connected = reaper::GetMIDIInputName(id_, name, 2);
     return connected || name[0] != 0;
@@ -28,6 +36,14 @@ namespace reaplus {
     return reaper::GetMIDIInputName(id_, dummy, 0);
   }
 
+  const MidiInputDeviceInfo* MidiInputDevice::findInSnapshot() const {
+    const auto& reaper = Reaper::instance();
+    if (!reaper.currentThreadIsMainThread()) {
+      return nullptr;
+    }
+    return reaper.midiInputDeviceSnapshot().findDevice(id_);
+  }
+
   bool reaplus::operator==(const MidiInputDevice& lhs, const MidiInputDevice& rhs) {
     return lhs.id_ == rhs.id_;
   }
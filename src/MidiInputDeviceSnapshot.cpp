@@ -0,0 +1,53 @@
+#include <reaplus/MidiInputDeviceSnapshot.h>
+#include <reaplus/utility.h>
+#include <reaper_plugin_functions.h>
+#include <algorithm>
+
+namespace reaplus {
+  MidiInputDeviceSnapshot MidiInputDeviceSnapshot::capture() {
+    MidiInputDeviceSnapshot snapshot;
+    const int maxCount = reaper::GetMaxMidiInputs();
+    for (int id = 0; id < maxCount; id++) {
+      bool connected = false;
+      const auto name = reaplus::toString(33, [id, &connected](char* buffer, int maxSize) {
+        connected = reaper::GetMIDIInputName(id, buffer, maxSize);
+      });
+      // Same rule as MidiInputDevice::isAvailable()
+      if (!connected && name.empty()) {
+        continue;
+      }
+      snapshot.devices_.push_back(MidiInputDeviceInfo{id, name, connected});
+      if (connected) {
+        snapshot.connectedDeviceIds_.push_back(id);
+      }
+    }
+    return snapshot;
+  }
+
+  const std::vector<MidiInputDeviceInfo>& MidiInputDeviceSnapshot::devices() const {
+    return devices_;
+  }
+
+  const std::vector<int>& MidiInputDeviceSnapshot::connectedDeviceIds() const {
+    return connectedDeviceIds_;
+  }
+
+  const MidiInputDeviceInfo* MidiInputDeviceSnapshot::findDevice(int id) const {
+    const auto it = std::lower_bound(devices_.begin(), devices_.end(), id,
+        [](const MidiInputDeviceInfo& device, int id) {
+          return device.id < id;
+        });
+    return it != devices_.end() && it->id == id ? &*it : nullptr;
+  }
+
+  bool operator==(const MidiInputDeviceSnapshot& lhs, const MidiInputDeviceSnapshot& rhs) {
+    return std::equal(lhs.devices_.begin(), lhs.devices_.end(), rhs.devices_.begin(), rhs.devices_.end(),
+        [](const MidiInputDeviceInfo& l, const MidiInputDeviceInfo& r) {
+          return l.id == r.id && l.name == r.name && l.connected == r.connected;
+        });
+  }
+
+  bool operator!=(const MidiInputDeviceSnapshot& lhs, const MidiInputDeviceSnapshot& rhs) {
+    return !(lhs == rhs);
+  }
+}
@@ -1,5 +1,6 @@
 #include <reaplus/MidiOutputDevice.h>
 #include <reaplus/utility.h>
+#include <reaplus/Reaper.h>
 #include <reaper_plugin_functions.h>
 
 using helgoboss::MidiMessage;
@@ -36,6 +37,16 @@ namespace reaplus {
     }
   }
 
+  bool MidiOutputDevice::schedule(const MidiMessage& message, std::uint64_t samplePosition) const {
+    return Reaper::instance().midiOutputScheduler().scheduleShortMessage(id_, message.getStatusByte(),
+        message.getDataByte1(), message.getDataByte2(), samplePosition);
+  }
+
+  bool MidiOutputDevice::scheduleSysEx(const unsigned char* data, std::size_t size,
+      std::uint64_t samplePosition) const {
+    return Reaper::instance().midiOutputScheduler().scheduleSysEx(id_, data, size, samplePosition);
+  }
+
   bool operator==(const MidiOutputDevice& lhs, const MidiOutputDevice& rhs) {
     return lhs.id_ == rhs.id_;
   }
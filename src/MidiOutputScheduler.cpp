@@ -0,0 +1,193 @@
+#include <reaplus/MidiOutputScheduler.h>
+#include <reaper_plugin.h>
+#include <reaper_plugin_functions.h>
+#include <algorithm>
+#include <cstring>
+
+namespace reaplus {
+  namespace {
+    // Frame offsets of midi_Output are in units of 1/1024000 of a second
+    constexpr double FRAME_OFFSET_UNITS_PER_SECOND = 1024000.0;
+    // How long a rate-limited device may receive at full speed after a quiet period
+    constexpr double MAX_BURST_SECONDS = 0.01;
+    // Short messages take 3 bytes at most
+    constexpr double SHORT_MESSAGE_SIZE = 3;
+
+    constexpr std::size_t roundUpToAlignment(std::size_t size, std::size_t alignment) {
+      return (size + alignment - 1) / alignment * alignment;
+    }
+
+    // SysEx buffers are laid out as MIDI_event_t, so they can be passed to SendMsg() without copying
+    constexpr std::size_t SYSEX_BUFFER_STRIDE = roundUpToAlignment(
+        sizeof(MIDI_event_t) - sizeof(MIDI_event_t::midi_message) + MidiOutputScheduler::MAX_SYSEX_SIZE,
+        alignof(MIDI_event_t)
+    );
+  }
+
+  struct MidiOutputScheduler::DeviceQueue {
+    util::BoundedQueue<OutgoingMessage> messages{QUEUE_CAPACITY_PER_DEVICE};
+    util::BoundedQueue<int> freeSysExBuffers{SYSEX_BUFFER_COUNT_PER_DEVICE};
+    std::unique_ptr<unsigned char[]> sysExStorage{new unsigned char[SYSEX_BUFFER_COUNT_PER_DEVICE * SYSEX_BUFFER_STRIDE]};
+    std::atomic<double> bytesPerSecond{0};
+    // Audio thread only
+    OutgoingMessage heldBackMessage{};
+    bool hasHeldBackMessage = false;
+    double byteAllowance = 0;
+
+    DeviceQueue() {
+      for (int i = 0; i < (int) SYSEX_BUFFER_COUNT_PER_DEVICE; i++) {
+        freeSysExBuffers.tryPush(i);
+      }
+    }
+
+    MIDI_event_t* sysExBuffer(int index) {
+      return reinterpret_cast<MIDI_event_t*>(sysExStorage.get() + index * SYSEX_BUFFER_STRIDE);
+    }
+  };
+
+  MidiOutputScheduler::MidiOutputScheduler() {
+    for (auto& queue : deviceQueues_) {
+      queue.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  MidiOutputScheduler::~MidiOutputScheduler() {
+    for (auto& queue : deviceQueues_) {
+      delete queue.load();
+    }
+  }
+
+  bool MidiOutputScheduler::scheduleShortMessage(int deviceId, unsigned char status, unsigned char data1,
+      unsigned char data2, std::uint64_t samplePosition) {
+    return schedule(deviceId, OutgoingMessage{samplePosition, -1, status, data1, data2});
+  }
+
+  bool MidiOutputScheduler::scheduleSysEx(int deviceId, const unsigned char* data, std::size_t size,
+      std::uint64_t samplePosition) {
+    const auto queue = getOrCreateDeviceQueue(deviceId);
+    int bufferIndex;
+    if (queue == nullptr || size > MAX_SYSEX_SIZE || !queue->freeSysExBuffers.tryPop(bufferIndex)) {
+      droppedCount_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    const auto event = queue->sysExBuffer(bufferIndex);
+    event->frame_offset = 0;
+    event->size = (int) size;
+    std::memcpy(event->midi_message, data, size);
+    if (!schedule(deviceId, OutgoingMessage{samplePosition, bufferIndex, 0, 0, 0})) {
+      queue->freeSysExBuffers.tryPush(bufferIndex);
+      return false;
+    }
+    return true;
+  }
+
+  void MidiOutputScheduler::setRateLimit(int deviceId, double bytesPerSecond) {
+    if (const auto queue = getOrCreateDeviceQueue(deviceId)) {
+      queue->bytesPerSecond.store(bytesPerSecond, std::memory_order_relaxed);
+    }
+  }
+
+  void MidiOutputScheduler::process(std::uint64_t blockStartSamplePosition, int blockLength, double sampleRate) {
+    for (int deviceId = 0; deviceId < MAX_DEVICE_COUNT; deviceId++) {
+      if (const auto queue = deviceQueues_[deviceId].load(std::memory_order_acquire)) {
+        processDevice(deviceId, *queue, blockStartSamplePosition, blockLength, sampleRate);
+      }
+    }
+  }
+
+  std::uint64_t MidiOutputScheduler::sentCount() const {
+    return sentCount_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t MidiOutputScheduler::droppedCount() const {
+    return droppedCount_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t MidiOutputScheduler::rateLimitedCount() const {
+    return rateLimitedCount_.load(std::memory_order_relaxed);
+  }
+
+  MidiOutputScheduler::DeviceQueue* MidiOutputScheduler::getOrCreateDeviceQueue(int deviceId) {
+    if (deviceId < 0 || deviceId >= MAX_DEVICE_COUNT) {
+      return nullptr;
+    }
+    auto& slot = deviceQueues_[deviceId];
+    if (const auto existing = slot.load(std::memory_order_acquire)) {
+      return existing;
+    }
+    std::unique_ptr<DeviceQueue> created(new DeviceQueue());
+    DeviceQueue* expected = nullptr;
+    if (slot.compare_exchange_strong(expected, created.get(), std::memory_order_acq_rel)) {
+      return created.release();
+    }
+    // Another thread was faster
+    return expected;
+  }
+
+  bool MidiOutputScheduler::schedule(int deviceId, const OutgoingMessage& message) {
+    const auto queue = getOrCreateDeviceQueue(deviceId);
+    if (queue == nullptr || !queue->messages.tryPush(message)) {
+      droppedCount_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  void MidiOutputScheduler::processDevice(int deviceId, DeviceQueue& queue, std::uint64_t blockStartSamplePosition,
+      int blockLength, double sampleRate) {
+    const auto output = reaper::GetMidiOutput(deviceId);
+    const auto blockEndSamplePosition = blockStartSamplePosition + std::max(blockLength, 0);
+    const auto bytesPerSecond = queue.bytesPerSecond.load(std::memory_order_relaxed);
+    if (bytesPerSecond > 0 && sampleRate > 0) {
+      const auto maxAllowance = std::max(bytesPerSecond * MAX_BURST_SECONDS, SHORT_MESSAGE_SIZE);
+      queue.byteAllowance = std::min(queue.byteAllowance + bytesPerSecond * blockLength / sampleRate, maxAllowance);
+    }
+    while (true) {
+      if (!queue.hasHeldBackMessage) {
+        if (!queue.messages.tryPop(queue.heldBackMessage)) {
+          break;
+        }
+        queue.hasHeldBackMessage = true;
+      }
+      auto& message = queue.heldBackMessage;
+      if (output != nullptr) {
+        if (message.samplePosition >= blockEndSamplePosition) {
+          // Not due yet
+          break;
+        }
+        // An allowance which is not used up is enough to send a message of any size. It might become negative then
+        // and the device has to wait correspondingly longer.
+        if (bytesPerSecond > 0 && queue.byteAllowance <= 0) {
+          rateLimitedCount_.fetch_add(1, std::memory_order_relaxed);
+          break;
+        }
+        const auto offsetInSamples = message.samplePosition > blockStartSamplePosition
+                                     ? message.samplePosition - blockStartSamplePosition
+                                     : 0;
+        const auto frameOffset = sampleRate > 0
+                                 ? static_cast<int>(offsetInSamples / sampleRate * FRAME_OFFSET_UNITS_PER_SECOND)
+                                 : 0;
+        if (message.sysExBufferIndex >= 0) {
+          const auto event = queue.sysExBuffer(message.sysExBufferIndex);
+          event->frame_offset = frameOffset;
+          output->SendMsg(event, frameOffset);
+          queue.byteAllowance -= event->size;
+        } else {
+          output->Send(message.status, message.data1, message.data2, frameOffset);
+          queue.byteAllowance -= SHORT_MESSAGE_SIZE;
+        }
+        sentCount_.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        // Device is gone, don't let messages pile up
+        droppedCount_.fetch_add(1, std::memory_order_relaxed);
+      }
+      if (message.sysExBufferIndex >= 0) {
+        queue.freeSysExBuffers.tryPush(message.sysExBufferIndex);
+      }
+      queue.hasHeldBackMessage = false;
+    }
+    if (bytesPerSecond <= 0) {
+      queue.byteAllowance = 0;
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#include <reaplus/MidiPreFilter.h>
+
+namespace reaplus {
+  namespace {
+    unsigned char typeOf(unsigned char status) {
+      return status < 0xf0 ? static_cast<unsigned char>(status & 0xf0) : status;
+    }
+  }
+
+  bool MidiInterest::matches(int deviceId, unsigned char status, unsigned char data1) const {
+    if (inputDeviceId != ANY_DEVICE && inputDeviceId != deviceId) {
+      return false;
+    }
+    const auto type = typeOf(status);
+    if (type < minType || type > maxType) {
+      return false;
+    }
+    if (status < 0xf0 && ((channelMask >> (status & 0x0f)) & 1) == 0) {
+      return false;
+    }
+    return data1 >= minData1 && data1 <= maxData1;
+  }
+
+  MidiPreFilter::MidiPreFilter() : matchesNothing_(true) {
+    entries_.fill(Entry{0, false, {0, 0}});
+  }
+
+  MidiPreFilter MidiPreFilter::compile(const std::vector<MidiInterest>& interests) {
+    MidiPreFilter filter;
+    for (const auto& interest : interests) {
+      filter.add(interest);
+    }
+    return filter;
+  }
+
+  bool MidiPreFilter::matchesNothing() const {
+    return matchesNothing_;
+  }
+
+  void MidiPreFilter::add(const MidiInterest& interest) {
+    std::uint64_t data1Mask[2] = {0, 0};
+    for (int d = interest.minData1; d <= interest.maxData1 && d < 128; d++) {
+      data1Mask[d >> 6] |= std::uint64_t(1) << (d & 63);
+    }
+    const bool anyDevice = interest.inputDeviceId == MidiInterest::ANY_DEVICE;
+    const bool otherDevice = anyDevice || interest.inputDeviceId >= MAX_DEVICE_COUNT;
+    const auto deviceMask = anyDevice ? ~std::uint64_t(0)
+                                      : interest.inputDeviceId >= 0 && interest.inputDeviceId < MAX_DEVICE_COUNT
+                                        ? std::uint64_t(1) << interest.inputDeviceId
+                                        : 0;
+    for (int status = 0x80; status <= 0xff; status++) {
+      // Only the device-independent parts, the device is merged in below
+      if (!interest.matches(interest.inputDeviceId, (unsigned char) status, interest.minData1)) {
+        continue;
+      }
+      auto& entry = entries_[status];
+      entry.deviceMask |= deviceMask;
+      entry.matchesOtherDevices = entry.matchesOtherDevices || otherDevice;
+      entry.data1Mask[0] |= data1Mask[0];
+      entry.data1Mask[1] |= data1Mask[1];
+      matchesNothing_ = false;
+    }
+  }
+}
@@ -0,0 +1,175 @@
+#include <reaplus/ParameterRef.h>
+#include <reaplus/Reaper.h>
+#include <reaplus/Section.h>
+#include <reaplus/Action.h>
+#include <reaplus/FxParameter.h>
+#include <reaplus/FxEnable.h>
+#include <reaplus/FxPreset.h>
+#include <reaplus/TrackVolume.h>
+#include <reaplus/TrackPan.h>
+#include <reaplus/TrackArm.h>
+#include <reaplus/TrackSelection.h>
+#include <reaplus/TrackMute.h>
+#include <reaplus/TrackSolo.h>
+#include <reaplus/TrackSendVolume.h>
+#include <reaplus/TrackSendPan.h>
+#include <reaplus/MasterTempo.h>
+#include <reaplus/MasterPlayrate.h>
+#include <stdexcept>
+
+using std::unique_ptr;
+using std::make_unique;
+
+namespace reaplus {
+  ParameterRef::ParameterRef(ParameterType type, MediaTrack* mediaTrack, bool isInputFx, int index, int subIndex)
+      : type_(type), isInputFx_(isInputFx), index_(index), subIndex_(subIndex), mediaTrack_(mediaTrack) {
+  }
+
+  ParameterRef ParameterRef::fxParameter(MediaTrack* mediaTrack, bool isInputFx, int fxIndex, int paramIndex) {
+    return ParameterRef(ParameterType::FX, mediaTrack, isInputFx, fxIndex, paramIndex);
+  }
+
+  ParameterRef ParameterRef::fxEnable(MediaTrack* mediaTrack, bool isInputFx, int fxIndex) {
+    return ParameterRef(ParameterType::FxEnable, mediaTrack, isInputFx, fxIndex, -1);
+  }
+
+  ParameterRef ParameterRef::fxPreset(MediaTrack* mediaTrack, bool isInputFx, int fxIndex) {
+    return ParameterRef(ParameterType::FxPreset, mediaTrack, isInputFx, fxIndex, -1);
+  }
+
+  ParameterRef ParameterRef::trackParameter(ParameterType type, MediaTrack* mediaTrack) {
+    switch (type) {
+      case ParameterType::TrackVolume:
+      case ParameterType::TrackPan:
+      case ParameterType::TrackArm:
+      case ParameterType::TrackSelection:
+      case ParameterType::TrackMute:
+      case ParameterType::TrackSolo:
+        return ParameterRef(type, mediaTrack, false, -1, -1);
+      default:
+        throw std::logic_error("not a simple track parameter type");
+    }
+  }
+
+  ParameterRef ParameterRef::trackSendParameter(ParameterType type, MediaTrack* mediaTrack, int sendIndex) {
+    switch (type) {
+      case ParameterType::TrackSendVolume:
+      case ParameterType::TrackSendPan:
+        return ParameterRef(type, mediaTrack, false, sendIndex, -1);
+      default:
+        throw std::logic_error("not a track send parameter type");
+    }
+  }
+
+  ParameterRef ParameterRef::masterTempo() {
+    return ParameterRef(ParameterType::MasterTempo, nullptr, false, -1, -1);
+  }
+
+  ParameterRef ParameterRef::masterPlayrate() {
+    return ParameterRef(ParameterType::MasterPlayrate, nullptr, false, -1, -1);
+  }
+
+  ParameterRef ParameterRef::action(int commandId) {
+    return ParameterRef(ParameterType::Action, nullptr, false, commandId, -1);
+  }
+
+  ParameterType ParameterRef::parameterType() const {
+    return type_;
+  }
+
+  bool ParameterRef::isTrackParameter() const {
+    return mediaTrack_ != nullptr;
+  }
+
+  MediaTrack* ParameterRef::mediaTrack() const {
+    return mediaTrack_;
+  }
+
+  bool ParameterRef::isInputFx() const {
+    return isInputFx_;
+  }
+
+  int ParameterRef::fxIndex() const {
+    switch (type_) {
+      case ParameterType::FX:
+      case ParameterType::FxEnable:
+      case ParameterType::FxPreset:
+        return index_;
+      default:
+        return -1;
+    }
+  }
+
+  int ParameterRef::paramIndex() const {
+    return subIndex_;
+  }
+
+  int ParameterRef::sendIndex() const {
+    switch (type_) {
+      case ParameterType::TrackSendVolume:
+      case ParameterType::TrackSendPan:
+        return index_;
+      default:
+        return -1;
+    }
+  }
+
+  int ParameterRef::commandId() const {
+    return type_ == ParameterType::Action ? index_ : 0;
+  }
+
+  unique_ptr<Parameter> ParameterRef::toParameter() const {
+    // Unfortunately, we don't have a ReaProject* here. Therefore we pass a nullptr.
+    const Track track(mediaTrack_, nullptr);
+    switch (type_) {
+      case ParameterType::FX:
+      case ParameterType::FxEnable:
+      case ParameterType::FxPreset: {
+        const auto fxChain = isInputFx_ ? track.inputFxChain() : track.normalFxChain();
+        const auto fx = fxChain.fxByIndex(index_);
+        if (!fx) {
+          return nullptr;
+        }
+        if (type_ == ParameterType::FX) {
+          return make_unique<FxParameter>(fx->parameterByIndex(subIndex_));
+        } else if (type_ == ParameterType::FxEnable) {
+          return make_unique<FxEnable>(*fx);
+        } else {
+          return make_unique<FxPreset>(*fx);
+        }
+      }
+      case ParameterType::TrackVolume:
+        return make_unique<TrackVolume>(track);
+      case ParameterType::TrackPan:
+        return make_unique<TrackPan>(track);
+      case ParameterType::TrackArm:
+        return make_unique<TrackArm>(track);
+      case ParameterType::TrackSelection:
+        return make_unique<TrackSelection>(track);
+      case ParameterType::TrackMute:
+        return make_unique<TrackMute>(track);
+      case ParameterType::TrackSolo:
+        return make_unique<TrackSolo>(track);
+      case ParameterType::TrackSendVolume:
+        return make_unique<TrackSendVolume>(track.indexBasedSendByIndex(index_));
+      case ParameterType::TrackSendPan:
+        return make_unique<TrackSendPan>(track.indexBasedSendByIndex(index_));
+      case ParameterType::MasterTempo:
+        return make_unique<MasterTempo>();
+      case ParameterType::MasterPlayrate:
+        return make_unique<MasterPlayrate>();
+      case ParameterType::Action:
+        return make_unique<Action>(Reaper::instance().mainSection().actionByCommandId(index_));
+    }
+    return nullptr;
+  }
+
+  bool operator==(const ParameterRef& lhs, const ParameterRef& rhs) {
+    return lhs.type_ == rhs.type_ && lhs.mediaTrack_ == rhs.mediaTrack_ && lhs.isInputFx_ == rhs.isInputFx_
+        && lhs.index_ == rhs.index_ && lhs.subIndex_ == rhs.subIndex_;
+  }
+
+  bool operator!=(const ParameterRef& lhs, const ParameterRef& rhs) {
+    return !(lhs == rhs);
+  }
+}
@@ -13,6 +13,7 @@
 #include <reaplus/util/log.h>
 #include <reaper_plugin_functions.h>
 #include <utility>
+#include <algorithm>
 
 using rxcpp::subscriber;
 using boost::none;
@@ -26,6 +27,26 @@ using boost::optional;
 using helgoboss::MidiMessage;
 
 namespace reaplus {
+  namespace {
+    // Enough for a few hundred milliseconds of very dense MIDI traffic
+    constexpr std::size_t MIDI_CAPTURE_RING_CAPACITY = 4096;
+    constexpr std::size_t AUDIO_TASK_QUEUE_CAPACITY = 1024;
+    // A small fraction of a typical audio block (e.g. 5.8 ms for 256 samples at 44.1 kHz)
+    constexpr std::int64_t DEFAULT_AUDIO_TASK_BUDGET_MICROS = 200;
+    const std::vector<int> NO_DEVICE_IDS;
+    // Enough for display updates and identity replies of typical controllers
+    constexpr std::size_t SYSEX_POOL_BUFFER_COUNT = 64;
+    constexpr std::size_t SYSEX_POOL_BUFFER_SIZE = 2048;
+
+    // Frame offsets of midi_Input events are in units of 1/1024000 of a second, not in sample frames
+    std::uint64_t inputFrameOffsetToSamples(int frameOffset, double sampleRate) {
+      if (frameOffset <= 0 || sampleRate <= 0) {
+        return 0;
+      }
+      return static_cast<std::uint64_t>(frameOffset * sampleRate / 1024000.0);
+    }
+  }
+
   std::unique_ptr<Reaper> Reaper::INSTANCE = nullptr;
 
   Reaper& reaplus::Reaper::instance() {
@@ -70,6 +91,8 @@ namespace reaplus {
   }
 
   void Reaper::staticHookPostCommand(int commandId, int) {
+    // Actions might have changed automation modes or shown/created envelopes
+    HelperControlSurface::instance().invalidateAutomationStates();
     auto action = Reaper::instance().mainSection().actionByCommandId(commandId);
     instance().actionInvokedSubject_.get_subscriber().on_next(action);
   }
@@ -100,7 +123,17 @@ namespace reaplus {
     return actionInvokedSubject_.get_observable();
   }
 
-  Reaper::Reaper() {
+  Reaper::Reaper() : sysExPool_(SYSEX_POOL_BUFFER_COUNT, SYSEX_POOL_BUFFER_SIZE),
+      midiCaptureRing_(MIDI_CAPTURE_RING_CAPACITY),
+      midiPreFilter_(std::unique_ptr<MidiPreFilter>(new MidiPreFilter())),
+      midiInputDeviceSnapshot_(
+          std::unique_ptr<MidiInputDeviceSnapshot>(new MidiInputDeviceSnapshot(MidiInputDeviceSnapshot::capture()))
+      ),
+      audioTaskQueue_(AUDIO_TASK_QUEUE_CAPACITY), audioTaskBudgetMicros_(DEFAULT_AUDIO_TASK_BUDGET_MICROS),
+      workerPool_(0, [](MainThreadTask task) {
+        HelperControlSurface::instance().enqueueCommandFast(std::move(task));
+      }) {
+    midiEventBlockBuffer_.reserve(MIDI_CAPTURE_RING_CAPACITY);
     // DONE-rust
     idOfMainThread_ = std::this_thread::get_id();
     // TODO-rust
@@ -124,6 +157,8 @@ namespace reaplus {
   }
 
   Reaper::~Reaper() {
+    // Results are delivered via HelperControlSurface
+    workerPool_.shutdown();
     // TODO-rust
     HelperControlSurface::destroyInstance();
     // DONE-rust
@@ -311,17 +346,28 @@ namespace reaplus {
 
   rxcpp::observable<MidiInputDevice> Reaper::midiInputDevices() const {
     return observable<>::create<MidiInputDevice>([this](subscriber<MidiInputDevice> s) {
-      const int maxCount = reaper::GetMaxMidiInputs();
-      for (int i = 0; i < maxCount && s.is_subscribed(); i++) {
-        const auto dev = midiInputDeviceById(i);
-        if (dev.isAvailable()) {
-          s.on_next(dev);
-        }
+      // Copy because subscribers might trigger a refresh
+      const auto devices = midiInputDeviceSnapshot().devices();
+      for (auto it = devices.begin(); it != devices.end() && s.is_subscribed(); ++it) {
+        s.on_next(midiInputDeviceById(it->id));
       }
       s.on_completed();
     });
   }
 
+  const MidiInputDeviceSnapshot& Reaper::midiInputDeviceSnapshot() const {
+    return midiInputDeviceSnapshot_.get();
+  }
+
+  void Reaper::refreshMidiInputDevices() {
+    auto snapshot = MidiInputDeviceSnapshot::capture();
+    if (snapshot != midiInputDeviceSnapshot_.get()) {
+      midiInputDeviceSnapshot_.publish(std::unique_ptr<MidiInputDeviceSnapshot>(
+          new MidiInputDeviceSnapshot(std::move(snapshot))
+      ));
+    }
+  }
+
   MidiInputDevice Reaper::midiInputDeviceById(int id) const {
     return MidiInputDevice(id);
   }
@@ -369,7 +415,149 @@ namespace reaplus {
   }
 
   rxcpp::observable<IncomingMidiEvent> Reaper::incomingMidiEvents() const {
-    return incomingMidiEventsSubject_.get_observable();
+    // Everything
+    return incomingMidiEvents({MidiInterest()});
+  }
+
+  rxcpp::observable<IncomingMidiEvent> Reaper::incomingMidiEvents(std::vector<MidiInterest> interests) const {
+    return rxcpp::observable<>::create<CapturedMidiEvent>([this, interests](subscriber<CapturedMidiEvent> s) {
+      const auto subscriptionId = addMidiInterests(interests);
+      s.add([this, subscriptionId] {
+        removeMidiInterests(subscriptionId);
+      });
+      capturedMidiEventsSubject_.get_observable().subscribe(s);
+    }).filter([interests](const CapturedMidiEvent& event) {
+      return std::any_of(interests.begin(), interests.end(), [&event](const MidiInterest& interest) {
+        return interest.matches(event.inputDeviceId, event.status, event.data1);
+      });
+    }).map(&createIncomingMidiEvent);
+  }
+
+  rxcpp::observable<IncomingMidiEventBlock> Reaper::incomingMidiEventBlocks() const {
+    return observable<>::create<IncomingMidiEventBlock>([this](subscriber<IncomingMidiEventBlock> s) {
+      const auto subscriptionId = addMidiInterests({MidiInterest()});
+      s.add([this, subscriptionId] {
+        removeMidiInterests(subscriptionId);
+      });
+      incomingMidiEventBlocksSubject_.get_observable().subscribe(s);
+    });
+  }
+
+  rxcpp::observable<IncomingHighResolutionMidiEvent> Reaper::incomingHighResolutionMidiEvents() const {
+    return observable<>::create<IncomingHighResolutionMidiEvent>(
+        [this](subscriber<IncomingHighResolutionMidiEvent> s) {
+          // All control changes which the assembler looks at
+          MidiInterest controllers;
+          controllers.minType = 0xb0;
+          controllers.maxType = 0xb0;
+          controllers.maxData1 = 63;
+          MidiInterest parameterNumbers = controllers;
+          parameterNumbers.minData1 = 98;
+          parameterNumbers.maxData1 = 101;
+          const auto subscriptionId = addMidiInterests({controllers, parameterNumbers});
+          highResolutionMidiSubscriptionCount_++;
+          s.add([this, subscriptionId] {
+            highResolutionMidiSubscriptionCount_--;
+            removeMidiInterests(subscriptionId);
+          });
+          incomingHighResolutionMidiEventsSubject_.get_observable().subscribe(s);
+        }
+    );
+  }
+
+  rxcpp::observable<IncomingSysExEvent> Reaper::incomingSysExEvents() const {
+    return observable<>::create<IncomingSysExEvent>([this](subscriber<IncomingSysExEvent> s) {
+      MidiInterest sysEx;
+      sysEx.minType = 0xf0;
+      sysEx.maxType = 0xf0;
+      const auto subscriptionId = addMidiInterests({sysEx});
+      sysExSubscriptionCount_++;
+      s.add([this, subscriptionId] {
+        sysExSubscriptionCount_--;
+        removeMidiInterests(subscriptionId);
+      });
+      incomingSysExEventsSubject_.get_observable().subscribe(s);
+    });
+  }
+
+  const SysExPool& Reaper::sysExPool() const {
+    return sysExPool_;
+  }
+
+  std::uint64_t Reaper::addMidiInterests(std::vector<MidiInterest> interests) const {
+    std::lock_guard<std::mutex> lock(midiInterestsMutex_);
+    const auto subscriptionId = nextMidiInterestsSubscriptionId_++;
+    midiInterestsBySubscription_.emplace(subscriptionId, std::move(interests));
+    publishMidiPreFilter();
+    return subscriptionId;
+  }
+
+  void Reaper::removeMidiInterests(std::uint64_t subscriptionId) const {
+    std::lock_guard<std::mutex> lock(midiInterestsMutex_);
+    midiInterestsBySubscription_.erase(subscriptionId);
+    publishMidiPreFilter();
+  }
+
+  void Reaper::publishMidiPreFilter() const {
+    std::vector<MidiInterest> allInterests;
+    for (const auto& pair : midiInterestsBySubscription_) {
+      allInterests.insert(allInterests.end(), pair.second.begin(), pair.second.end());
+    }
+    midiPreFilter_.publish(std::unique_ptr<MidiPreFilter>(new MidiPreFilter(MidiPreFilter::compile(allInterests))));
+  }
+
+  const MidiCaptureRing& Reaper::midiCaptureRing() const {
+    return midiCaptureRing_;
+  }
+
+  void Reaper::emitCapturedMidiEvents() {
+    const bool emitBlocks = incomingMidiEventBlocksSubject_.has_observers();
+    std::uint64_t currentBlockIndex = 0;
+    // Drain even without observers, otherwise the ring would overflow
+    midiCaptureRing_.drain([this, emitBlocks, &currentBlockIndex](const CapturedMidiEvent& event) {
+      if (event.kind == CapturedMidiEventKind::SysEx) {
+        if (incomingSysExEventsSubject_.has_observers()) {
+          incomingSysExEventsSubject_.get_subscriber().on_next(createIncomingSysExEvent(event));
+        } else {
+          sysExPool_.release(event.number);
+        }
+        return;
+      }
+      if (event.kind != CapturedMidiEventKind::Raw) {
+        if (incomingHighResolutionMidiEventsSubject_.has_observers()) {
+          incomingHighResolutionMidiEventsSubject_.get_subscriber().on_next(
+              createIncomingHighResolutionMidiEvent(event)
+          );
+        }
+        return;
+      }
+      if (capturedMidiEventsSubject_.has_observers()) {
+        capturedMidiEventsSubject_.get_subscriber().on_next(event);
+      }
+      if (emitBlocks) {
+        // Events arrive in block order, so a different index means the previous block is complete
+        if (!midiEventBlockBuffer_.empty() && event.blockIndex != currentBlockIndex) {
+          emitMidiEventBlock(currentBlockIndex);
+        }
+        currentBlockIndex = event.blockIndex;
+        midiEventBlockBuffer_.push_back(createIncomingMidiEvent(event));
+      }
+    });
+    if (!midiEventBlockBuffer_.empty()) {
+      emitMidiEventBlock(currentBlockIndex);
+    }
+    // Free snapshots and pre-filters which the audio hook doesn't use anymore
+    midiInputDeviceSnapshot_.collect();
+    std::lock_guard<std::mutex> lock(midiInterestsMutex_);
+    midiPreFilter_.collect();
+  }
+
+  void Reaper::emitMidiEventBlock(std::uint64_t blockIndex) {
+    incomingMidiEventBlocksSubject_.get_subscriber().on_next(
+        IncomingMidiEventBlock(blockIndex, midiEventBlockBuffer_.data(), midiEventBlockBuffer_.size())
+    );
+    // Keeps the capacity
+    midiEventBlockBuffer_.clear();
   }
 
   void Reaper::init() {
@@ -377,55 +565,134 @@ namespace reaplus {
   }
 
   uint64_t Reaper::sampleCounter() const {
-    return sampleCounter_;
+    return sampleCounter_.load(std::memory_order_relaxed);
   }
 
-  void Reaper::processAudioBuffer(bool isPost, int len, double, struct audio_hook_register_t*) {
+  void Reaper::processAudioBuffer(bool isPost, int len, double srate, struct audio_hook_register_t* reg) {
     try {
       if (!isPost) {
         auto& reaper = Reaper::instance();
-        // Make use of audioThreadCoordination for rxcpp possible
+        reaper.audioTaskQueue_.runFor(
+            std::chrono::microseconds(reaper.audioTaskBudgetMicros_.load(std::memory_order_relaxed))
+        );
+        // Make use of audioThreadCoordination for rxcpp possible. Never wait for the lock in the audio thread.
         // TODO-rust
-        reaper.audioThreadRunLoop_.dispatch();
-        // For each open MIDI device
-        auto& subject = reaper.incomingMidiEventsSubject_;
-        for (int i = 0; subject.has_observers() && i < reaper::GetMaxMidiInputs(); i++) {
+        reaper.audioThreadRunLoop_.try_dispatch();
+        // For each open MIDI device. Only capture here, subscribers are served in the main thread.
+        auto& ring = reaper.midiCaptureRing_;
+        // Only the audio hook writes it
+        const auto blockStart = reaper.sampleCounter_.load(std::memory_order_relaxed);
+        const auto& preFilter = reaper.midiPreFilter_.beginRead();
+        const auto& deviceSnapshot = reaper.midiInputDeviceSnapshot_.beginRead();
+        const auto& deviceIds = preFilter.matchesNothing() ? NO_DEVICE_IDS : deviceSnapshot.connectedDeviceIds();
+        const bool assembleHighResolutionEvents = reaper.highResolutionMidiSubscriptionCount_.load() > 0;
+        const bool captureSysEx = reaper.sysExSubscriptionCount_.load() > 0;
+        for (const auto i : deviceIds) {
           // Read MIDI messages
           const auto midiInput = reaper::GetMidiInput(i);
           if (midiInput != nullptr) {
             const auto midiEvents = midiInput->GetReadBuf();
             MIDI_event_t* midiEvent;
             int l = 0;
-            while (subject.has_observers() && (midiEvent = midiEvents->EnumItems(&l))) {
-              // Send MIDI message
+            while ((midiEvent = midiEvents->EnumItems(&l))) {
               auto& msg = midiEvent->midi_message;
-              if (msg[0] != 254) {
-                // No active sensing, good to go
-                subject.get_subscriber().on_next(IncomingMidiEvent(
-                    MidiInputDevice(i),
-                    createMidiMessageFromEvent(*midiEvent),
-                    midiEvent->frame_offset
-                ));
+              if (midiEvent->size > 0 && msg[0] == 0xf0) {
+                // Doesn't fit into a short message, so it goes into a pool buffer
+                if (captureSysEx && preFilter.matches(i, 0xf0, 0)) {
+                  const auto bufferIndex = reaper.sysExPool_.acquire(msg, (std::size_t) midiEvent->size);
+                  if (bufferIndex >= 0 && !ring.push(CapturedMidiEvent{
+                      i,
+                      midiEvent->frame_offset,
+                      0xf0,
+                      0,
+                      0,
+                      CapturedMidiEventKind::SysEx,
+                      static_cast<std::uint16_t>(bufferIndex),
+                      static_cast<std::uint16_t>(midiEvent->size),
+                      reaper.audioBlockCounter_,
+                      blockStart + inputFrameOffsetToSamples(midiEvent->frame_offset, srate),
+                      srate
+                  })) {
+                    reaper.sysExPool_.release(bufferIndex);
+                  }
+                }
+                continue;
+              }
+              const auto data1 = midiEvent->size >= 2 ? msg[1] : static_cast<unsigned char>(0);
+              // No active sensing and somebody is interested, good to go
+              if (msg[0] != 254 && preFilter.matches(i, msg[0], data1)) {
+                const CapturedMidiEvent event{
+                    i,
+                    midiEvent->frame_offset,
+                    midiEvent->size >= 1 ? msg[0] : static_cast<unsigned char>(0),
+                    data1,
+                    midiEvent->size >= 3 ? msg[2] : static_cast<unsigned char>(0),
+                    CapturedMidiEventKind::Raw,
+                    0,
+                    0,
+                    reaper.audioBlockCounter_,
+                    blockStart + inputFrameOffsetToSamples(midiEvent->frame_offset, srate),
+                    srate
+                };
+                ring.push(event);
+                CapturedMidiEvent assembledEvent;
+                if (assembleHighResolutionEvents
+                    && reaper.highResolutionMidiAssembler_.process(event, assembledEvent)) {
+                  ring.push(assembledEvent);
+                }
               }
             }
           }
         }
-        reaper.sampleCounter_ += len;
+        reaper.midiInputDeviceSnapshot_.endRead();
+        reaper.midiPreFilter_.endRead();
+        reaper.midiOutputScheduler_.process(blockStart, len, srate);
+        reaper.sampleCounter_.store(blockStart + len, std::memory_order_relaxed);
+        reaper.audioBlockCounter_++;
+      } else {
+        Reaper::instance().hardwareMeter_.process(*reg, len, srate);
       }
     } catch (...) {
       util::logException();
     }
   }
 
-  MidiMessage Reaper::createMidiMessageFromEvent(const MIDI_event_t& event) {
-    if (event.size == 0) {
+  MidiMessage Reaper::createMidiMessageFromEvent(const CapturedMidiEvent& event) {
+    // Status 0 means the event was empty
+    if (event.status == 0) {
       return MidiMessage::empty();
     }
-    return MidiMessage(
-        event.midi_message[0],
-        event.size >= 2 ? event.midi_message[1] : static_cast<unsigned char>(0),
-        event.size >= 3 ? event.midi_message[2] : static_cast<unsigned char>(0)
-    );
+    return MidiMessage(event.status, event.data1, event.data2);
+  }
+
+  IncomingSysExEvent Reaper::createIncomingSysExEvent(const CapturedMidiEvent& event) {
+    const auto bufferIndex = static_cast<int>(event.number);
+    auto& pool = sysExPool_;
+    // Released as soon as all copies of the event are gone
+    const auto data = std::shared_ptr<const unsigned char>(pool.buffer(bufferIndex),
+        [&pool, bufferIndex](const unsigned char*) {
+          pool.release(bufferIndex);
+        });
+    return IncomingSysExEvent(MidiInputDevice(event.inputDeviceId), data, event.value, event.frameOffset,
+        event.samplePosition, event.sampleRate);
+  }
+
+  IncomingHighResolutionMidiEvent Reaper::createIncomingHighResolutionMidiEvent(const CapturedMidiEvent& event) {
+    const auto kind = event.kind == CapturedMidiEventKind::ControlChange14Bit
+                      ? HighResolutionMidiEventKind::ControlChange14Bit
+                      : event.kind == CapturedMidiEventKind::Nrpn7Bit || event.kind == CapturedMidiEventKind::Nrpn14Bit
+                        ? HighResolutionMidiEventKind::Nrpn
+                        : HighResolutionMidiEventKind::Rpn;
+    const bool is14Bit = event.kind == CapturedMidiEventKind::ControlChange14Bit
+                         || event.kind == CapturedMidiEventKind::Nrpn14Bit
+                         || event.kind == CapturedMidiEventKind::Rpn14Bit;
+    return IncomingHighResolutionMidiEvent(MidiInputDevice(event.inputDeviceId), kind, event.status & 0x0f,
+        event.number, event.value, is14Bit, event.frameOffset, event.samplePosition, event.sampleRate);
+  }
+
+  IncomingMidiEvent Reaper::createIncomingMidiEvent(const CapturedMidiEvent& event) {
+    return IncomingMidiEvent(MidiInputDevice(event.inputDeviceId), createMidiMessageFromEvent(event),
+        event.frameOffset, event.samplePosition, event.sampleRate);
   }
 
   void Reaper::registerProjectConfigExtension(ProjectConfigExtension extension) {
@@ -459,6 +726,14 @@ namespace reaplus {
     }
   }
 
+  rxcpp::observable<ParameterRef> Reaper::parameterValueChanged() const {
+    return HelperControlSurface::instance().parameterValueChanged();
+  }
+
+  rxcpp::observable<ParameterRef> Reaper::parameterTouched() const {
+    return HelperControlSurface::instance().parameterTouched();
+  }
+
   rxcpp::observable<Parameter*> Reaper::parameterValueChangedUnsafe() const {
     return HelperControlSurface::instance().parameterValueChangedUnsafe();
   }
@@ -543,6 +818,10 @@ namespace reaplus {
     return HelperControlSurface::instance().tracksReordered();
   }
 
+  rxcpp::observable<TrackListReordering> Reaper::trackListReordered() const {
+    return HelperControlSurface::instance().trackListReordered();
+  }
+
   rxcpp::observable<Fx> Reaper::fxAdded() const {
     return HelperControlSurface::instance().fxAdded();
   }
@@ -563,6 +842,10 @@ namespace reaplus {
     return HelperControlSurface::instance().fxReordered();
   }
 
+  rxcpp::observable<FxChainReordering> Reaper::fxChainReordered() const {
+    return HelperControlSurface::instance().fxChainReordered();
+  }
+
   rxcpp::observable<Track> Reaper::trackInputMonitoringChanged() const {
     return HelperControlSurface::instance().trackInputMonitoringChanged();
   }
@@ -623,13 +906,77 @@ namespace reaplus {
     return HelperControlSurface::instance().mainThreadIdle();
   }
 
+  rxcpp::observable<ValueChange<FxParameter>> Reaper::fxParameterValueChangedCoalesced() const {
+    return HelperControlSurface::instance().fxParameterValueChangedCoalesced();
+  }
+
+  rxcpp::observable<ValueChange<Track>> Reaper::trackVolumeChangedCoalesced() const {
+    return HelperControlSurface::instance().trackVolumeChangedCoalesced();
+  }
+
+  rxcpp::observable<ValueChange<Track>> Reaper::trackPanChangedCoalesced() const {
+    return HelperControlSurface::instance().trackPanChangedCoalesced();
+  }
+
+  rxcpp::observable<ValueChange<TrackSend>> Reaper::trackSendVolumeChangedCoalesced() const {
+    return HelperControlSurface::instance().trackSendVolumeChangedCoalesced();
+  }
+
+  rxcpp::observable<ValueChange<TrackSend>> Reaper::trackSendPanChangedCoalesced() const {
+    return HelperControlSurface::instance().trackSendPanChangedCoalesced();
+  }
+
+  ControlSurfaceEventBus& Reaper::controlSurfaceEventBus() {
+    return HelperControlSurface::instance().eventBus();
+  }
+
+  const FxParameterShadowTable& Reaper::fxParameterShadowTable() const {
+    return HelperControlSurface::instance().fxParameterShadowTable();
+  }
+
   rxcpp::composite_subscription Reaper::executeLaterInMainThread(std::function<void(void)> command) {
     return HelperControlSurface::instance().enqueueCommand(std::move(command));
   }
-  void Reaper::executeLaterInMainThreadFast(std::function<void(void)> command) {
+  void Reaper::executeLaterInMainThreadFast(MainThreadTask command) {
     HelperControlSurface::instance().enqueueCommandFast(std::move(command));
   }
 
+  const MainThreadTaskQueue& Reaper::mainThreadTaskQueue() const {
+    return HelperControlSurface::instance().fastCommandQueue();
+  }
+
+  void Reaper::executeLaterInMainThread(MainThreadPriority priority, MainThreadTask task) {
+    HelperControlSurface::instance().mainThreadScheduler().schedule(priority, std::move(task));
+  }
+
+  MainThreadScheduler& Reaper::mainThreadScheduler() {
+    return HelperControlSurface::instance().mainThreadScheduler();
+  }
+
+  TimerHandle Reaper::executeLaterInMainThread(std::chrono::steady_clock::duration delay, MainThreadTask task) {
+    return HelperControlSurface::instance().timerWheel().schedule(delay, std::move(task));
+  }
+
+  TimerWheel& Reaper::timerWheel() {
+    return HelperControlSurface::instance().timerWheel();
+  }
+
+  MainThreadAwaitable Reaper::mainThread() const {
+    return MainThreadAwaitable();
+  }
+
+  NextRunCycleAwaitable Reaper::nextRunCycle() const {
+    return NextRunCycleAwaitable();
+  }
+
+  AudioBlockAwaitable Reaper::audioBlock() const {
+    return AudioBlockAwaitable();
+  }
+
+  WorkerPool& Reaper::workerPool() {
+    return workerPool_;
+  }
+
   rxcpp::composite_subscription Reaper::executeWhenInMainThread(std::function<void(void)> command) {
     if (currentThreadIsMainThread()) {
       command();
@@ -647,6 +994,26 @@ namespace reaplus {
     return audioThreadCoordination_;
   }
 
+  bool Reaper::executeLaterInAudioThread(AudioTask task) {
+    return audioTaskQueue_.push(std::move(task));
+  }
+
+  void Reaper::setAudioTaskBudget(std::chrono::microseconds budget) {
+    audioTaskBudgetMicros_.store(budget.count(), std::memory_order_relaxed);
+  }
+
+  const AudioTaskQueue& Reaper::audioTaskQueue() const {
+    return audioTaskQueue_;
+  }
+
+  MidiOutputScheduler& Reaper::midiOutputScheduler() {
+    return midiOutputScheduler_;
+  }
+
+  HardwareMeter& Reaper::hardwareMeter() {
+    return hardwareMeter_;
+  }
+
   std::thread::id Reaper::idOfMainThread() const {
     return idOfMainThread_;
   }
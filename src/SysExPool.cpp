@@ -0,0 +1,53 @@
+#include <reaplus/SysExPool.h>
+#include <cstring>
+
+namespace reaplus {
+  SysExPool::SysExPool(std::size_t bufferCount, std::size_t bufferSize) : bufferCount_(bufferCount),
+      bufferSize_(bufferSize), storage_(new unsigned char[bufferCount * bufferSize]), freeBuffers_(bufferCount) {
+    for (int i = 0; i < (int) bufferCount; i++) {
+      freeBuffers_.tryPush(i);
+    }
+  }
+
+  int SysExPool::acquire(const unsigned char* message, std::size_t size) {
+    if (size > bufferSize_) {
+      oversizedCount_.fetch_add(1, std::memory_order_relaxed);
+      return -1;
+    }
+    int bufferIndex;
+    if (!freeBuffers_.tryPop(bufferIndex)) {
+      exhaustedCount_.fetch_add(1, std::memory_order_relaxed);
+      return -1;
+    }
+    std::memcpy(storage_.get() + bufferIndex * bufferSize_, message, size);
+    return bufferIndex;
+  }
+
+  void SysExPool::release(int bufferIndex) {
+    freeBuffers_.tryPush(bufferIndex);
+  }
+
+  const unsigned char* SysExPool::buffer(int bufferIndex) const {
+    return storage_.get() + bufferIndex * bufferSize_;
+  }
+
+  std::size_t SysExPool::bufferCount() const {
+    return bufferCount_;
+  }
+
+  std::size_t SysExPool::bufferSize() const {
+    return bufferSize_;
+  }
+
+  std::size_t SysExPool::freeBufferCount() const {
+    return freeBuffers_.size();
+  }
+
+  std::uint64_t SysExPool::exhaustedCount() const {
+    return exhaustedCount_.load(std::memory_order_relaxed);
+  }
+
+  std::uint64_t SysExPool::oversizedCount() const {
+    return oversizedCount_.load(std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,194 @@
+#include <reaplus/TimerWheel.h>
+#include <reaplus/util/log.h>
+#include <algorithm>
+#include <atomic>
+
+using reaplus::util::logException;
+
+namespace reaplus {
+  namespace {
+    constexpr std::uint64_t SLOT_BITS = 6;
+    constexpr std::uint64_t SLOT_MASK = TimerWheel::SLOT_COUNT_PER_LEVEL - 1;
+
+    std::uint64_t nextGeneration() {
+      static std::atomic<std::uint64_t> GENERATION{0};
+      return ++GENERATION;
+    }
+
+    // Number of ticks covered by the levels up to and including the given one
+    std::uint64_t rangeOfLevel(std::size_t level) {
+      return std::uint64_t(1) << (SLOT_BITS * (level + 1));
+    }
+  }
+
+  TimerWheel::TimerWheel(Clock::time_point start) : start_(start) {
+    heads_.fill(NO_INDEX);
+    tails_.fill(NO_INDEX);
+  }
+
+  TimerHandle TimerWheel::schedule(Clock::duration delay, MainThreadTask task) {
+    return scheduleAt(Clock::now() + delay, std::move(task));
+  }
+
+  TimerHandle TimerWheel::scheduleAt(Clock::time_point dueTime, MainThreadTask task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::uint32_t index;
+    if (freeIndexes_.empty()) {
+      index = static_cast<std::uint32_t>(nodes_.size());
+      nodes_.emplace_back();
+    } else {
+      index = freeIndexes_.back();
+      freeIndexes_.pop_back();
+    }
+    auto& node = nodes_[index];
+    node.task = std::move(task);
+    node.dueTick = tickOf(dueTime);
+    node.generation = nextGeneration();
+    if (node.dueTick <= currentTick_) {
+      append(OVERDUE_SLOT, index);
+    } else {
+      place(index);
+    }
+    size_++;
+    return TimerHandle(index, node.generation);
+  }
+
+  bool TimerWheel::cancel(TimerHandle handle) {
+    MainThreadTask task;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (handle.generation_ == 0 || handle.index_ >= nodes_.size()
+          || nodes_[handle.index_].generation != handle.generation_) {
+        return false;
+      }
+      auto& node = nodes_[handle.index_];
+      unlink(handle.index_);
+      task = std::move(node.task);
+      node.generation = 0;
+      freeIndexes_.push_back(handle.index_);
+      size_--;
+    }
+    // Captures are destroyed outside of the lock
+    return true;
+  }
+
+  bool TimerWheel::isPending(TimerHandle handle) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return handle.generation_ != 0 && handle.index_ < nodes_.size()
+        && nodes_[handle.index_].generation == handle.generation_;
+  }
+
+  std::size_t TimerWheel::advance(Clock::time_point now) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fire(OVERDUE_SLOT);
+      const auto targetTick = tickOf(now);
+      if (size_ == 0) {
+        currentTick_ = std::max(currentTick_, targetTick);
+      }
+      while (currentTick_ < targetTick) {
+        currentTick_++;
+        // Higher levels first, so that their timers can trickle down to level 0 within the same tick
+        for (auto level = LEVEL_COUNT - 1; level > 0; level--) {
+          if ((currentTick_ & (rangeOfLevel(level - 1) - 1)) == 0) {
+            cascade(level, (currentTick_ >> (SLOT_BITS * level)) & SLOT_MASK);
+          }
+        }
+        fire(currentTick_ & SLOT_MASK);
+      }
+    }
+    for (auto& task : firedTasks_) {
+      try {
+        task();
+      } catch (...) {
+        logException();
+      }
+    }
+    const auto firedCount = firedTasks_.size();
+    firedTasks_.clear();
+    return firedCount;
+  }
+
+  std::size_t TimerWheel::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+  std::uint64_t TimerWheel::tickOf(Clock::time_point time) const {
+    if (time <= start_) {
+      return 0;
+    }
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(time - start_).count());
+  }
+
+  void TimerWheel::place(std::uint32_t index) {
+    auto& node = nodes_[index];
+    const auto delta = node.dueTick - currentTick_;
+    std::size_t level = 0;
+    while (level < LEVEL_COUNT - 1 && delta >= rangeOfLevel(level)) {
+      level++;
+    }
+    // Too far away even for the top level, so it's placed again (closer) when its slot comes up
+    const auto topRange = rangeOfLevel(LEVEL_COUNT - 1);
+    const auto tick = delta < topRange ? node.dueTick : currentTick_ + topRange - 1;
+    append(level * SLOT_COUNT_PER_LEVEL + ((tick >> (SLOT_BITS * level)) & SLOT_MASK), index);
+  }
+
+  void TimerWheel::append(std::size_t slot, std::uint32_t index) {
+    auto& node = nodes_[index];
+    node.slot = static_cast<std::uint32_t>(slot);
+    node.next = NO_INDEX;
+    node.previous = tails_[slot];
+    if (tails_[slot] == NO_INDEX) {
+      heads_[slot] = index;
+    } else {
+      nodes_[tails_[slot]].next = index;
+    }
+    tails_[slot] = index;
+  }
+
+  void TimerWheel::unlink(std::uint32_t index) {
+    auto& node = nodes_[index];
+    if (node.previous == NO_INDEX) {
+      heads_[node.slot] = node.next;
+    } else {
+      nodes_[node.previous].next = node.next;
+    }
+    if (node.next == NO_INDEX) {
+      tails_[node.slot] = node.previous;
+    } else {
+      nodes_[node.next].previous = node.previous;
+    }
+    node.previous = NO_INDEX;
+    node.next = NO_INDEX;
+  }
+
+  void TimerWheel::cascade(std::size_t level, std::size_t slotInLevel) {
+    const auto slot = level * SLOT_COUNT_PER_LEVEL + slotInLevel;
+    auto index = heads_[slot];
+    heads_[slot] = NO_INDEX;
+    tails_[slot] = NO_INDEX;
+    while (index != NO_INDEX) {
+      const auto next = nodes_[index].next;
+      place(index);
+      index = next;
+    }
+  }
+
+  void TimerWheel::fire(std::size_t slot) {
+    auto index = heads_[slot];
+    heads_[slot] = NO_INDEX;
+    tails_[slot] = NO_INDEX;
+    while (index != NO_INDEX) {
+      auto& node = nodes_[index];
+      const auto next = node.next;
+      firedTasks_.push_back(std::move(node.task));
+      node.generation = 0;
+      node.previous = NO_INDEX;
+      node.next = NO_INDEX;
+      freeIndexes_.push_back(index);
+      size_--;
+      index = next;
+    }
+  }
+}
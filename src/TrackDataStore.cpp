@@ -0,0 +1,150 @@
+#include <reaplus/TrackDataStore.h>
+
+namespace reaplus {
+  namespace {
+    constexpr std::size_t INITIAL_BUCKET_COUNT = 16;
+  }
+
+  TrackDataStore::TrackDataStore() : buckets_(INITIAL_BUCKET_COUNT, Bucket{nullptr, NO_SLOT}),
+      mask_(INITIAL_BUCKET_COUNT - 1) {
+  }
+
+  int TrackDataStore::size() const {
+    return (int) mediaTracks.size();
+  }
+
+  bool TrackDataStore::empty() const {
+    return mediaTracks.empty();
+  }
+
+  TrackDataStore::Slot TrackDataStore::add(MediaTrack* mediaTrack, const TrackData& data) {
+    // Keep load factor <= 0.5 so probe sequences stay short
+    if ((mediaTracks.size() + 1) * 2 > buckets_.size()) {
+      rehash(buckets_.size() * 2);
+    }
+    const auto slot = size();
+    mediaTracks.push_back(mediaTrack);
+    volumes.push_back(data.volume);
+    pans.push_back(data.pan);
+    selecteds.push_back(data.selected);
+    mutes.push_back(data.mute);
+    solos.push_back(data.solo);
+    recarms.push_back(data.recarm);
+    numbers.push_back(data.number);
+    recmonitors.push_back(data.recmonitor);
+    recinputs.push_back(data.recinput);
+    guids.push_back(data.guid);
+    automationEpochs.push_back(data.automationEpoch);
+    automatedParameters.push_back(data.automatedParameters);
+    insertIntoBuckets(mediaTrack, slot);
+    return slot;
+  }
+
+  void TrackDataStore::remove(Slot slot) {
+    const auto lastSlot = size() - 1;
+    eraseFromBuckets(mediaTracks[slot]);
+    if (slot != lastSlot) {
+      mediaTracks[slot] = mediaTracks[lastSlot];
+      volumes[slot] = volumes[lastSlot];
+      pans[slot] = pans[lastSlot];
+      selecteds[slot] = selecteds[lastSlot];
+      mutes[slot] = mutes[lastSlot];
+      solos[slot] = solos[lastSlot];
+      recarms[slot] = recarms[lastSlot];
+      numbers[slot] = numbers[lastSlot];
+      recmonitors[slot] = recmonitors[lastSlot];
+      recinputs[slot] = recinputs[lastSlot];
+      guids[slot] = guids[lastSlot];
+      automationEpochs[slot] = automationEpochs[lastSlot];
+      automatedParameters[slot] = automatedParameters[lastSlot];
+      buckets_[findBucket(mediaTracks[slot])].slot = slot;
+    }
+    mediaTracks.pop_back();
+    volumes.pop_back();
+    pans.pop_back();
+    selecteds.pop_back();
+    mutes.pop_back();
+    solos.pop_back();
+    recarms.pop_back();
+    numbers.pop_back();
+    recmonitors.pop_back();
+    recinputs.pop_back();
+    guids.pop_back();
+    automationEpochs.pop_back();
+    automatedParameters.pop_back();
+  }
+
+  TrackData TrackDataStore::get(Slot slot) const {
+    TrackData d;
+    d.volume = volumes[slot];
+    d.pan = pans[slot];
+    d.selected = selecteds[slot] != 0;
+    d.mute = mutes[slot] != 0;
+    d.solo = solos[slot] != 0;
+    d.recarm = recarms[slot] != 0;
+    d.number = numbers[slot];
+    d.recmonitor = recmonitors[slot];
+    d.recinput = recinputs[slot];
+    d.guid = guids[slot];
+    d.automationEpoch = automationEpochs[slot];
+    d.automatedParameters = automatedParameters[slot];
+    return d;
+  }
+
+  void TrackDataStore::clear() {
+    mediaTracks.clear();
+    volumes.clear();
+    pans.clear();
+    selecteds.clear();
+    mutes.clear();
+    solos.clear();
+    recarms.clear();
+    numbers.clear();
+    recmonitors.clear();
+    recinputs.clear();
+    guids.clear();
+    automationEpochs.clear();
+    automatedParameters.clear();
+    buckets_.assign(buckets_.size(), Bucket{nullptr, NO_SLOT});
+  }
+
+  std::size_t TrackDataStore::findBucket(MediaTrack* mediaTrack) const {
+    auto i = bucketIndexOf(mediaTrack);
+    while (buckets_[i].mediaTrack != mediaTrack) {
+      i = (i + 1) & mask_;
+    }
+    return i;
+  }
+
+  void TrackDataStore::insertIntoBuckets(MediaTrack* mediaTrack, Slot slot) {
+    auto i = bucketIndexOf(mediaTrack);
+    while (buckets_[i].mediaTrack != nullptr) {
+      i = (i + 1) & mask_;
+    }
+    buckets_[i] = Bucket{mediaTrack, slot};
+  }
+
+  void TrackDataStore::eraseFromBuckets(MediaTrack* mediaTrack) {
+    // Backward-shift deletion, so we don't need tombstones
+    auto hole = findBucket(mediaTrack);
+    buckets_[hole] = Bucket{nullptr, NO_SLOT};
+    for (auto i = (hole + 1) & mask_; buckets_[i].mediaTrack != nullptr; i = (i + 1) & mask_) {
+      const auto home = bucketIndexOf(buckets_[i].mediaTrack);
+      // Entry can stay if its home lies cyclically within (hole, i]
+      const bool canStay = hole < i ? (hole < home && home <= i) : (hole < home || home <= i);
+      if (!canStay) {
+        buckets_[hole] = buckets_[i];
+        buckets_[i] = Bucket{nullptr, NO_SLOT};
+        hole = i;
+      }
+    }
+  }
+
+  void TrackDataStore::rehash(std::size_t capacity) {
+    buckets_.assign(capacity, Bucket{nullptr, NO_SLOT});
+    mask_ = capacity - 1;
+    for (Slot slot = 0; slot < size(); slot++) {
+      insertIntoBuckets(mediaTracks[slot], slot);
+    }
+  }
+}
@@ -0,0 +1,132 @@
+#include <reaplus/WorkerPool.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace reaplus {
+  namespace {
+    constexpr std::size_t MAX_DEFAULT_THREAD_COUNT = 4;
+    // Index of the worker running in the current thread, for putting its own submissions into its own deque
+    thread_local const void* CURRENT_POOL = nullptr;
+    thread_local std::size_t CURRENT_WORKER_INDEX = 0;
+
+    std::size_t defaultThreadCount() {
+      const auto hardwareThreadCount = std::thread::hardware_concurrency();
+      return std::min(std::max<std::size_t>(hardwareThreadCount / 2, 1), MAX_DEFAULT_THREAD_COUNT);
+    }
+  }
+
+  WorkerPool::WorkerPool(std::size_t threadCount, MainThreadPoster postToMainThread) :
+      threadCount_(threadCount == 0 ? defaultThreadCount() : threadCount),
+      postToMainThread_(std::move(postToMainThread)) {
+    for (std::size_t i = 0; i < threadCount_; i++) {
+      workers_.emplace_back(new Worker());
+    }
+  }
+
+  WorkerPool::~WorkerPool() {
+    shutdown();
+  }
+
+  void WorkerPool::shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(stateMutex_);
+      if (stopped_) {
+        return;
+      }
+      stopping_ = true;
+      stopped_ = true;
+    }
+    wakeUp_.notify_all();
+    // No thread can be started anymore
+    for (const auto& worker : workers_) {
+      if (worker->thread.joinable()) {
+        worker->thread.join();
+      }
+    }
+  }
+
+  std::size_t WorkerPool::threadCount() const {
+    return threadCount_;
+  }
+
+  std::uint64_t WorkerPool::stolenCount() const {
+    return stolenCount_.load(std::memory_order_relaxed);
+  }
+
+  void WorkerPool::push(WorkerTask task) {
+    const bool isOwnWorker = CURRENT_POOL == this;
+    const auto workerIndex = isOwnWorker
+                             ? CURRENT_WORKER_INDEX
+                             : nextWorkerIndex_.fetch_add(1, std::memory_order_relaxed) % threadCount_;
+    {
+      std::lock_guard<std::mutex> lock(stateMutex_);
+      // Tasks fanning out while shutting down are still part of the already submitted work. The submitting worker
+      // doesn't stop before its own deque is empty.
+      if (stopping_ && !isOwnWorker) {
+        throw std::logic_error("worker pool has been shut down");
+      }
+      // Under the same lock as stopping_, so shutdown() joins every thread which has been started
+      if (!started_) {
+        for (std::size_t i = 0; i < threadCount_; i++) {
+          workers_[i]->thread = std::thread([this, i] {
+            run(i);
+          });
+        }
+        started_ = true;
+      }
+      // Workers don't stop while this is > 0, so the task below will be executed even if shutdown() comes in between
+      pendingCount_++;
+    }
+    auto& worker = *workers_[workerIndex];
+    {
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+    }
+    wakeUp_.notify_one();
+  }
+
+  void WorkerPool::run(std::size_t workerIndex) {
+    CURRENT_POOL = this;
+    CURRENT_WORKER_INDEX = workerIndex;
+    WorkerTask task;
+    while (true) {
+      if (tryTake(workerIndex, task)) {
+        pendingCount_--;
+        // Exceptions are caught by the task itself (see submit())
+        task();
+        task.reset();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(stateMutex_);
+      wakeUp_.wait(lock, [this] {
+        return stopping_ || pendingCount_.load() > 0;
+      });
+      if (stopping_ && pendingCount_.load() == 0) {
+        return;
+      }
+    }
+  }
+
+  bool WorkerPool::tryTake(std::size_t workerIndex, WorkerTask& task) {
+    {
+      auto& own = *workers_[workerIndex];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        return true;
+      }
+    }
+    for (std::size_t offset = 1; offset < threadCount_; offset++) {
+      auto& victim = *workers_[(workerIndex + offset) % threadCount_];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        stolenCount_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+}
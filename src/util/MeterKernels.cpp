@@ -0,0 +1,66 @@
+#include <reaplus/util/MeterKernels.h>
+#include <algorithm>
+#include <cmath>
+
+#if REASAMPLE_SIZE == 8 && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define REAPLUS_METER_KERNELS_SSE2
+#include <emmintrin.h>
+#elif REASAMPLE_SIZE == 8 && defined(__ARM_NEON) && defined(__aarch64__)
+#define REAPLUS_METER_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace reaplus::util {
+  namespace {
+    PeakAndSumOfSquares measureScalar(const ReaSample* samples, int count, PeakAndSumOfSquares result) {
+      for (int i = 0; i < count; i++) {
+        const double sample = samples[i];
+        result.peak = std::max(result.peak, std::abs(sample));
+        result.sumOfSquares += sample * sample;
+      }
+      return result;
+    }
+  }
+
+  PeakAndSumOfSquares measurePeakAndSumOfSquares(const ReaSample* samples, int count) {
+    PeakAndSumOfSquares result{0, 0};
+    int i = 0;
+#if defined(REAPLUS_METER_KERNELS_SSE2)
+    // Two independent accumulators (4 samples per iteration) hide the latency of the additions
+    const auto absMask = _mm_castsi128_pd(_mm_set1_epi64x(0x7fffffffffffffffLL));
+    auto peak0 = _mm_setzero_pd();
+    auto peak1 = _mm_setzero_pd();
+    auto sum0 = _mm_setzero_pd();
+    auto sum1 = _mm_setzero_pd();
+    for (; i + 4 <= count; i += 4) {
+      const auto a = _mm_loadu_pd(samples + i);
+      const auto b = _mm_loadu_pd(samples + i + 2);
+      peak0 = _mm_max_pd(peak0, _mm_and_pd(a, absMask));
+      peak1 = _mm_max_pd(peak1, _mm_and_pd(b, absMask));
+      sum0 = _mm_add_pd(sum0, _mm_mul_pd(a, a));
+      sum1 = _mm_add_pd(sum1, _mm_mul_pd(b, b));
+    }
+    const auto peak = _mm_max_pd(peak0, peak1);
+    const auto sum = _mm_add_pd(sum0, sum1);
+    result.peak = std::max(_mm_cvtsd_f64(peak), _mm_cvtsd_f64(_mm_unpackhi_pd(peak, peak)));
+    result.sumOfSquares = _mm_cvtsd_f64(sum) + _mm_cvtsd_f64(_mm_unpackhi_pd(sum, sum));
+#elif defined(REAPLUS_METER_KERNELS_NEON)
+    auto peak0 = vdupq_n_f64(0);
+    auto peak1 = vdupq_n_f64(0);
+    auto sum0 = vdupq_n_f64(0);
+    auto sum1 = vdupq_n_f64(0);
+    for (; i + 4 <= count; i += 4) {
+      const auto a = vld1q_f64(samples + i);
+      const auto b = vld1q_f64(samples + i + 2);
+      peak0 = vmaxq_f64(peak0, vabsq_f64(a));
+      peak1 = vmaxq_f64(peak1, vabsq_f64(b));
+      sum0 = vfmaq_f64(sum0, a, a);
+      sum1 = vfmaq_f64(sum1, b, b);
+    }
+    result.peak = vmaxvq_f64(vmaxq_f64(peak0, peak1));
+    result.sumOfSquares = vaddvq_f64(vaddq_f64(sum0, sum1));
+#endif
+    // Remainder (or everything if there's no vectorized variant)
+    return measureScalar(samples + i, count - i, result);
+  }
+}
@@ -18,6 +18,13 @@ namespace reaplus {
     return guidString;
   }
 
+  GUID convertStringToGuid(const string& guidString) {
+    GUID guid;
+    const auto bracedGuidString = "{" + guidString + "}";
+    reaper::stringToGuid(bracedGuidString.c_str(), &guid);
+    return guid;
+  }
+
   string toString(int maxSize, function<void(char*, int)> fillBuffer) {
     // TODO Can this be implemented in a better way?
     string s;
@@ -0,0 +1,26 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+namespace reaplus {
+  std::atomic<bool> countAllocations(false);
+  std::atomic<int> allocationCount(0);
+}
+
+void* operator new(std::size_t size) {
+  if (reaplus::countAllocations) {
+    reaplus::allocationCount++;
+  }
+  if (const auto p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
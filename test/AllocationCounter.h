@@ -0,0 +1,19 @@
+#pragma once
+
+#include <atomic>
+
+namespace reaplus {
+  // Counted by the replacement operator new in AllocationCounter.cpp
+  extern std::atomic<bool> countAllocations;
+  extern std::atomic<int> allocationCount;
+
+  // Number of heap allocations (in any thread) while executing f
+  template<typename F>
+  int allocationsDuring(F f) {
+    allocationCount = 0;
+    countAllocations = true;
+    f();
+    countAllocations = false;
+    return allocationCount;
+  }
+}
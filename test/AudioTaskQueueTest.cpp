@@ -0,0 +1,67 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/AudioTaskQueue.h>
+#include <reaplus/Reaper.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace reaplus;
+
+TEST_CASE("Audio task queue drops tasks when full and defers them when out of budget") {
+  AudioTaskQueue queue(3);
+  REQUIRE(queue.capacity() == 4);
+  std::vector<int> executed;
+  for (int i = 0; i < 6; i++) {
+    queue.push([&executed, i] {
+      executed.push_back(i);
+    });
+  }
+  REQUIRE(queue.droppedCount() == 2);
+  REQUIRE(queue.size() == 4);
+  // Zero budget still makes progress
+  REQUIRE(queue.runFor(std::chrono::microseconds(0)) == 1);
+  REQUIRE(queue.deferredCount() == 3);
+  REQUIRE(queue.runFor(std::chrono::seconds(1)) == 3);
+  REQUIRE(executed == std::vector<int>{0, 1, 2, 3});
+  REQUIRE(queue.executedCount() == 4);
+  REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE("Audio task queue accepts tasks from several threads") {
+  AudioTaskQueue queue(64);
+  std::atomic<int> executedCount(0);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < 4; p++) {
+    producers.emplace_back([&queue, &executedCount] {
+      for (int i = 0; i < 1000; i++) {
+        while (!queue.push([&executedCount] {
+          executedCount++;
+        })) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  std::size_t totalExecuted = 0;
+  while (totalExecuted < 4000) {
+    totalExecuted += queue.runFor(std::chrono::milliseconds(1));
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  REQUIRE(executedCount == 4000);
+}
+
+TEST_CASE("Audio hook executes tasks pushed from the main thread") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  int executedCount = 0;
+  REQUIRE(reaper.executeLaterInAudioThread([&executedCount] {
+    executedCount++;
+  }));
+  REQUIRE(executedCount == 0);
+  fake.processAudioBlock(512);
+  REQUIRE(executedCount == 1);
+  REQUIRE(reaper.audioTaskQueue().executedCount() == 1);
+}
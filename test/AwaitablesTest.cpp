@@ -0,0 +1,96 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Awaitables.h>
+#include <reaplus/CoroutineFrameArena.h>
+#include <reaplus/Reaper.h>
+#include <thread>
+
+using namespace reaplus;
+
+namespace {
+  // Stands in for a coroutine handle, the tests are built as C++17
+  struct FakeCoroutineHandle {
+    int* resumeCount;
+
+    void resume() const {
+      (*resumeCount)++;
+    }
+  };
+}
+
+TEST_CASE("Coroutine frame arena reuses freed blocks of the same size class") {
+  CoroutineFrameArena arena(2);
+  const auto first = arena.allocate(100);
+  arena.deallocate(first, 100);
+  // 100 and 120 both fall into the smallest size class
+  const auto second = arena.allocate(120);
+  REQUIRE(second == first);
+  REQUIRE(arena.reuseCount() == 1);
+  const auto big = arena.allocate(CoroutineFrameArena::MAX_BLOCK_SIZE + 1);
+  arena.deallocate(big, CoroutineFrameArena::MAX_BLOCK_SIZE + 1);
+  arena.deallocate(second, 120);
+  REQUIRE(arena.heapAllocationCount() == 2);
+}
+
+TEST_CASE("Awaitables resume in the right thread") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  int resumeCount = 0;
+  const FakeCoroutineHandle handle{&resumeCount};
+  SECTION("Main thread") {
+    REQUIRE(reaper.mainThread().await_ready());
+    bool readyInOtherThread = true;
+    std::thread([&reaper, &readyInOtherThread, handle] {
+      const auto awaitable = reaper.mainThread();
+      readyInOtherThread = awaitable.await_ready();
+      if (!readyInOtherThread) {
+        awaitable.await_suspend(handle);
+      }
+    }).join();
+    REQUIRE(!readyInOtherThread);
+    REQUIRE(resumeCount == 0);
+    fake.runControlSurfaces();
+    REQUIRE(resumeCount == 1);
+  }
+  SECTION("Next run cycle") {
+    reaper.nextRunCycle().await_suspend(handle);
+    fake.processAudioBlock(512);
+    REQUIRE(resumeCount == 0);
+    fake.runControlSurfaces();
+    REQUIRE(resumeCount == 1);
+  }
+  SECTION("Audio block") {
+    auto awaitable = reaper.audioBlock();
+    REQUIRE(awaitable.await_suspend(handle));
+    fake.runControlSurfaces();
+    REQUIRE(resumeCount == 0);
+    fake.processAudioBlock(512);
+    REQUIRE(resumeCount == 1);
+    REQUIRE_NOTHROW(awaitable.await_resume());
+  }
+  SECTION("Delay") {
+    REQUIRE(delay(std::chrono::milliseconds(0)).await_ready());
+    const auto awaitable = delay(std::chrono::milliseconds(20));
+    REQUIRE(!awaitable.await_ready());
+    awaitable.await_suspend(handle);
+    fake.runControlSurfaces();
+    REQUIRE(resumeCount == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    fake.runControlSurfaces();
+    REQUIRE(resumeCount == 1);
+  }
+  SECTION("Delay from another thread") {
+    // E.g. the audio thread after co_await audioBlock()
+    std::thread([handle] {
+      delay(std::chrono::milliseconds(20)).await_suspend(handle);
+    }).join();
+    // Only the main thread touches the timer wheel
+    REQUIRE(reaper.timerWheel().size() == 0);
+    fake.runControlSurfaces();
+    REQUIRE(reaper.timerWheel().size() == 1);
+    REQUIRE(resumeCount == 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    fake.runControlSurfaces();
+    REQUIRE(resumeCount == 1);
+  }
+}
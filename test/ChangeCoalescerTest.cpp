@@ -0,0 +1,66 @@
+#include <catch.hpp>
+#include "AllocationCounter.h"
+#include <reaplus/util/ChangeCoalescer.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace reaplus;
+using reaplus::util::ChangeCoalescer;
+
+TEST_CASE("Change coalescer delivers each target once with its latest value") {
+  ChangeCoalescer<int, std::pair<int, double>> coalescer;
+  coalescer.mark(3, {3, 0.1});
+  coalescer.mark(1, {1, 0.2});
+  coalescer.mark(3, {3, 0.3});
+  std::vector<std::pair<int, double>> delivered;
+  coalescer.flush([&delivered](const std::pair<int, double>& value) {
+    delivered.push_back(value);
+  });
+  REQUIRE(delivered == std::vector<std::pair<int, double>>{{3, 0.3}, {1, 0.2}});
+  REQUIRE(coalescer.empty());
+}
+
+TEST_CASE("Change coalescer keeps targets marked while flushing for the next flush") {
+  ChangeCoalescer<int, int> coalescer;
+  coalescer.mark(1, 1);
+  int deliveredCount = 0;
+  coalescer.flush([&coalescer, &deliveredCount](int value) {
+    deliveredCount++;
+    coalescer.mark(value, value + 1);
+  });
+  REQUIRE(deliveredCount == 1);
+  REQUIRE(!coalescer.empty());
+  coalescer.flush([](int value) {
+    REQUIRE(value == 2);
+  });
+}
+
+TEST_CASE("Change coalescer grows its index without losing targets") {
+  ChangeCoalescer<std::string, int> coalescer;
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 1000; i++) {
+      coalescer.mark(std::to_string(i), i);
+    }
+    int sum = 0;
+    int count = 0;
+    coalescer.flush([&sum, &count](int value) {
+      sum += value;
+      count++;
+    });
+    REQUIRE(count == 1000);
+    REQUIRE(sum == 999 * 1000 / 2);
+  }
+}
+
+TEST_CASE("Change coalescer doesn't allocate once warmed up") {
+  ChangeCoalescer<int, double> coalescer;
+  const auto markAndFlush = [&coalescer] {
+    for (int i = 0; i < 500; i++) {
+      coalescer.mark(i % 200, i);
+    }
+    coalescer.flush([](double) {});
+  };
+  markAndFlush();
+  REQUIRE(allocationsDuring(markAndFlush) == 0);
+}
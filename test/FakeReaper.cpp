@@ -0,0 +1,1346 @@
+// The reaper:: function pointers are defined here, so executables linking FakeReaper must not define them elsewhere
+#define REAPERAPI_IMPLEMENT
+
+#include "FakeReaper.h"
+#include <reaplus/Reaper.h>
+#include <reaper_plugin_functions.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+using std::string;
+using std::vector;
+using std::unique_ptr;
+
+namespace reaplus {
+  namespace {
+    constexpr int INPUT_FX_QUERY_INDEX_OFFSET = 0x1000000;
+    constexpr int DEFAULT_FX_PARAM_COUNT = 8;
+
+    struct FakeFx {
+      GUID guid;
+      string name;
+      vector<double> params;
+      bool enabled;
+    };
+
+    struct FakeSend {
+      MediaTrack* destTrack;
+      double volume;
+      double pan;
+    };
+
+    struct FakeTrack {
+      ReaProject* project;
+      GUID guid;
+      string name;
+      double volume = 1;
+      double pan = 0;
+      bool mute = false;
+      int solo = 0;
+      int recarm = 0;
+      int recmon = 0;
+      int recinput = 0;
+      int selected = 0;
+      int automationMode = 0;
+      vector<FakeFx> fxs;
+      vector<FakeFx> inputFxs;
+      vector<FakeSend> sends;
+      // Deque because envelope pointers handed out must stay valid
+      std::deque<string> envelopes;
+      // Empty means generated from the track state
+      string chunk;
+    };
+
+    struct FakeProject {
+      unique_ptr<FakeTrack> masterTrack;
+      vector<unique_ptr<FakeTrack>> tracks;
+    };
+
+    // Event positions (bpos) are event indexes
+    class FakeMidiEventList : public MIDI_eventlist {
+    public:
+      void AddItem(MIDI_event_t* evt) override {
+        const auto byteCount = sizeof(MIDI_event_t) + std::max(0, evt->size - 4);
+        vector<char> item(byteCount);
+        std::memcpy(item.data(), evt, byteCount);
+        items_.push_back(std::move(item));
+      }
+
+      MIDI_event_t* EnumItems(int* bpos) override {
+        const auto index = bpos == nullptr ? 0 : *bpos;
+        if (index < 0 || index >= (int) items_.size()) {
+          return nullptr;
+        }
+        if (bpos != nullptr) {
+          *bpos = index + 1;
+        }
+        return reinterpret_cast<MIDI_event_t*>(items_[index].data());
+      }
+
+      void DeleteItem(int bpos) override {
+        if (bpos >= 0 && bpos < (int) items_.size()) {
+          items_.erase(items_.begin() + bpos);
+        }
+      }
+
+      int GetSize() override {
+        int size = 0;
+        for (const auto& item : items_) {
+          size += (int) item.size();
+        }
+        return size;
+      }
+
+      void Empty() override {
+        items_.clear();
+      }
+
+      ~FakeMidiEventList() override = default;
+
+      void swap(FakeMidiEventList& other) {
+        items_.swap(other.items_);
+      }
+
+    private:
+      vector<vector<char>> items_;
+    };
+
+    class FakeMidiInput : public midi_Input {
+    public:
+      explicit FakeMidiInput(string name) : name(std::move(name)) {
+      }
+
+      string name;
+      FakeMidiEventList pending;
+
+      void start() override {
+      }
+
+      void stop() override {
+      }
+
+      // Doesn't allocate, so processAudioBlock() can be used to check that audio hooks don't
+      void SwapBufs(unsigned int) override {
+        readBuf_.swap(pending);
+        pending.Empty();
+      }
+
+      MIDI_eventlist* GetReadBuf() override {
+        return &readBuf_;
+      }
+
+    private:
+      FakeMidiEventList readBuf_;
+    };
+
+    class FakeMidiOutput : public midi_Output {
+    public:
+      explicit FakeMidiOutput(string name) : name(std::move(name)) {
+      }
+
+      string name;
+      vector<vector<unsigned char>> sentMessages;
+      vector<int> sentFrameOffsets;
+
+      void SendMsg(MIDI_event_t* msg, int frameOffset) override {
+        sentMessages.emplace_back(msg->midi_message, msg->midi_message + msg->size);
+        sentFrameOffsets.push_back(frameOffset);
+      }
+
+      void Send(unsigned char status, unsigned char d1, unsigned char d2, int frameOffset) override {
+        sentMessages.push_back({status, d1, d2});
+        sentFrameOffsets.push_back(frameOffset);
+      }
+    };
+  }
+
+  struct FakeReaperState {
+    string appVersion = "6.0/x64";
+    vector<unique_ptr<FakeProject>> projects;
+    FakeProject* currentProject = nullptr;
+    vector<std::pair<string, void*>> registrations;
+    vector<audio_hook_register_t*> audioHooksBuffer;
+    vector<vector<ReaSample>> hardwareOutputSamples;
+    std::unordered_map<string, int> commandIdByName;
+    int nextCommandId = 40000;
+    std::map<int, unique_ptr<FakeMidiInput>> midiInputs;
+    std::map<int, unique_ptr<FakeMidiOutput>> midiOutputs;
+    int globalAutomationOverride = -1;
+    double tempo = 120;
+    double playrate = 1;
+    string consoleOutput;
+    unsigned int nextGuidNumber = 1;
+    string resourcePath = ".";
+    // Deleted tracks stay allocated, so that new tracks don't get their addresses
+    vector<unique_ptr<FakeTrack>> deletedTracks;
+    // > 0 while in batchTrackListChanges()
+    int trackListChangeBatchDepth = 0;
+    bool trackListChangePending = false;
+  };
+
+  namespace {
+    FakeReaperState* STATE = nullptr;
+
+    FakeReaperState& state() {
+      if (STATE == nullptr) {
+        throw std::logic_error("no FakeReaper instance");
+      }
+      return *STATE;
+    }
+
+    ReaSample* getAudioBuffer(bool isOutput, int idx) {
+      auto& channels = state().hardwareOutputSamples;
+      if (!isOutput || idx < 0 || idx >= (int) channels.size()) {
+        return nullptr;
+      }
+      return channels[idx].data();
+    }
+
+    FakeTrack* fakeTrack(MediaTrack* mediaTrack) {
+      return reinterpret_cast<FakeTrack*>(mediaTrack);
+    }
+
+    MediaTrack* mediaTrackOf(FakeTrack* track) {
+      return reinterpret_cast<MediaTrack*>(track);
+    }
+
+    FakeProject* fakeProject(ReaProject* reaProject) {
+      return reaProject == nullptr ? state().currentProject : reinterpret_cast<FakeProject*>(reaProject);
+    }
+
+    ReaProject* reaProjectOf(FakeProject* project) {
+      return reinterpret_cast<ReaProject*>(project);
+    }
+
+    GUID nextGuid() {
+      GUID guid{};
+      guid.Data1 = state().nextGuidNumber++;
+      guid.Data4[7] = 0x42;
+      return guid;
+    }
+
+    void copyString(const string& source, char* buffer, int bufferSize) {
+      if (buffer == nullptr || bufferSize <= 0) {
+        return;
+      }
+      const auto length = std::min((int) source.size(), bufferSize - 1);
+      std::memcpy(buffer, source.data(), length);
+      buffer[length] = '\0';
+    }
+
+    unique_ptr<FakeTrack> createTrack(FakeProject* project, const string& name) {
+      auto track = unique_ptr<FakeTrack>(new FakeTrack);
+      track->project = reaProjectOf(project);
+      track->guid = nextGuid();
+      track->name = name;
+      return track;
+    }
+
+    unique_ptr<FakeProject> createProject() {
+      auto project = unique_ptr<FakeProject>(new FakeProject);
+      project->masterTrack = createTrack(project.get(), "MASTER");
+      return project;
+    }
+
+    // Returns -1 for master track, -2 if not found
+    int indexOf(FakeTrack* track) {
+      auto project = fakeProject(track->project);
+      if (project->masterTrack.get() == track) {
+        return -1;
+      }
+      for (int i = 0; i < (int) project->tracks.size(); i++) {
+        if (project->tracks[i].get() == track) {
+          return i;
+        }
+      }
+      return -2;
+    }
+
+    bool trackExists(FakeProject* project, void* pointer) {
+      if (project->masterTrack.get() == pointer) {
+        return true;
+      }
+      return std::any_of(project->tracks.begin(), project->tracks.end(), [pointer](const unique_ptr<FakeTrack>& t) {
+        return t.get() == pointer;
+      });
+    }
+
+    vector<FakeFx>& fxChainOf(FakeTrack* track, bool isInputFx) {
+      return isInputFx ? track->inputFxs : track->fxs;
+    }
+
+    FakeFx* resolveFx(MediaTrack* mediaTrack, int queryIndex) {
+      const auto track = fakeTrack(mediaTrack);
+      if (track == nullptr) {
+        return nullptr;
+      }
+      const bool isInputFx = queryIndex >= INPUT_FX_QUERY_INDEX_OFFSET;
+      auto& chain = fxChainOf(track, isInputFx);
+      const auto index = isInputFx ? queryIndex - INPUT_FX_QUERY_INDEX_OFFSET : queryIndex;
+      return index >= 0 && index < (int) chain.size() ? &chain[index] : nullptr;
+    }
+
+    FakeFx createFx(const string& name, int paramCount) {
+      return FakeFx{nextGuid(), name, vector<double>(paramCount, 0.0), true};
+    }
+
+    // Copy because callbacks might register or unregister surfaces
+    template<typename F>
+    void forEachControlSurface(F f, IReaperControlSurface* except = nullptr) {
+      vector<IReaperControlSurface*> surfaces;
+      for (const auto& r : state().registrations) {
+        if (r.first == "csurf_inst" && r.second != except) {
+          surfaces.push_back(static_cast<IReaperControlSurface*>(r.second));
+        }
+      }
+      for (const auto surface : surfaces) {
+        f(surface);
+      }
+    }
+
+    void notifyTrackListChange() {
+      if (state().trackListChangeBatchDepth > 0) {
+        state().trackListChangePending = true;
+        return;
+      }
+      forEachControlSurface([](IReaperControlSurface* s) {
+        s->SetTrackListChange();
+      });
+      // REAPER then reports the title of each track of the current project, master track first
+      const auto project = state().currentProject;
+      const auto reportTitle = [](FakeTrack* track) {
+        const auto title = track->name.c_str();
+        forEachControlSurface([track, title](IReaperControlSurface* s) {
+          s->SetTrackTitle(mediaTrackOf(track), title);
+        });
+      };
+      reportTitle(project->masterTrack.get());
+      for (const auto& track : project->tracks) {
+        reportTitle(track.get());
+      }
+    }
+
+    void notifyFxChange(MediaTrack* mediaTrack) {
+      forEachControlSurface([mediaTrack](IReaperControlSurface* s) {
+        s->Extended(CSURF_EXT_SETFXCHANGE, mediaTrack, nullptr, nullptr);
+      });
+    }
+
+    // API functions
+
+    int plugin_register(const char* name, void* infostruct) {
+      // Singletons might unregister after the fake is gone
+      if (STATE == nullptr) {
+        return 0;
+      }
+      auto& s = state();
+      if (name[0] == '-') {
+        const string registeredName = name + 1;
+        const auto it = std::find(s.registrations.begin(), s.registrations.end(),
+            std::make_pair(registeredName, infostruct));
+        if (it != s.registrations.end()) {
+          s.registrations.erase(it);
+        }
+        return 1;
+      }
+      if (std::strcmp(name, "command_id") == 0) {
+        const auto commandName = string(static_cast<const char*>(infostruct));
+        const auto it = s.commandIdByName.find(commandName);
+        if (it != s.commandIdByName.end()) {
+          return it->second;
+        }
+        const auto commandId = s.nextCommandId++;
+        s.commandIdByName.emplace(commandName, commandId);
+        return commandId;
+      }
+      s.registrations.emplace_back(name, infostruct);
+      return 1;
+    }
+
+    const char* GetAppVersion() {
+      return state().appVersion.c_str();
+    }
+
+    HWND GetMainHwnd() {
+      return nullptr;
+    }
+
+    const char* GetResourcePath() {
+      return state().resourcePath.c_str();
+    }
+
+    const char* GetExePath() {
+      return state().resourcePath.c_str();
+    }
+
+    void ShowConsoleMsg(const char* msg) {
+      state().consoleOutput += msg;
+    }
+
+    void ClearConsole() {
+      state().consoleOutput.clear();
+    }
+
+    void genGuid(GUID* g) {
+      *g = nextGuid();
+    }
+
+    void guidToString(const GUID* g, char* destNeed64) {
+      std::snprintf(destNeed64, 64, "{%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+          g->Data1, g->Data2, g->Data3, g->Data4[0], g->Data4[1], g->Data4[2], g->Data4[3], g->Data4[4],
+          g->Data4[5], g->Data4[6], g->Data4[7]);
+    }
+
+    void stringToGuid(const char* str, GUID* g) {
+      unsigned int d1 = 0;
+      unsigned int d2 = 0;
+      unsigned int d3 = 0;
+      unsigned int d4[8] = {};
+      const auto matched = std::sscanf(str, "{%8X-%4X-%4X-%2X%2X-%2X%2X%2X%2X%2X%2X}", &d1, &d2, &d3, &d4[0],
+          &d4[1], &d4[2], &d4[3], &d4[4], &d4[5], &d4[6], &d4[7]);
+      *g = GUID{};
+      if (matched != 11) {
+        return;
+      }
+      g->Data1 = d1;
+      g->Data2 = (unsigned short) d2;
+      g->Data3 = (unsigned short) d3;
+      for (int i = 0; i < 8; i++) {
+        g->Data4[i] = (unsigned char) d4[i];
+      }
+    }
+
+    string generateChunk(FakeTrack* track) {
+      char guid[64];
+      guidToString(&track->guid, guid);
+      char buffer[512];
+      std::snprintf(buffer, sizeof(buffer),
+          "<TRACK %s\nNAME \"%s\"\nVOLPAN %.14f %.14f -1 -1 1\nMUTESOLO %d %d 0\nREC %d %d %d 0 0 0 0\n>\n",
+          guid, track->name.c_str(), track->volume, track->pan, track->mute ? 1 : 0, track->solo,
+          track->recarm, track->recinput, track->recmon);
+      return buffer;
+    }
+
+    ReaProject* EnumProjects(int idx, char* projfn, int projfn_sz) {
+      auto& s = state();
+      copyString("", projfn, projfn_sz);
+      if (idx == -1) {
+        return reaProjectOf(s.currentProject);
+      }
+      if (idx < 0 || idx >= (int) s.projects.size()) {
+        return nullptr;
+      }
+      return reaProjectOf(s.projects[idx].get());
+    }
+
+    ReaProject* GetCurrentProjectInLoadSave() {
+      return nullptr;
+    }
+
+    bool ValidatePtr2(ReaProject* proj, void* pointer, const char* ctypename) {
+      auto& s = state();
+      if (std::strcmp(ctypename, "ReaProject*") == 0) {
+        return std::any_of(s.projects.begin(), s.projects.end(), [pointer](const unique_ptr<FakeProject>& p) {
+          return p.get() == pointer;
+        });
+      }
+      if (std::strcmp(ctypename, "MediaTrack*") == 0) {
+        if (proj != nullptr) {
+          return trackExists(fakeProject(proj), pointer);
+        }
+        return std::any_of(s.projects.begin(), s.projects.end(), [pointer](const unique_ptr<FakeProject>& p) {
+          return trackExists(p.get(), pointer);
+        });
+      }
+      return false;
+    }
+
+    void MarkProjectDirty(ReaProject*) {
+    }
+
+    void Undo_BeginBlock2(ReaProject*) {
+    }
+
+    void Undo_EndBlock2(ReaProject*, const char*, int) {
+    }
+
+    int CountTracks(ReaProject* proj) {
+      return (int) fakeProject(proj)->tracks.size();
+    }
+
+    MediaTrack* GetTrack(ReaProject* proj, int trackidx) {
+      const auto project = fakeProject(proj);
+      if (trackidx < 0 || trackidx >= (int) project->tracks.size()) {
+        return nullptr;
+      }
+      return mediaTrackOf(project->tracks[trackidx].get());
+    }
+
+    MediaTrack* GetMasterTrack(ReaProject* proj) {
+      return mediaTrackOf(fakeProject(proj)->masterTrack.get());
+    }
+
+    void InsertTrackAtIndex(int idx, bool) {
+      auto project = state().currentProject;
+      idx = std::max(0, std::min(idx, (int) project->tracks.size()));
+      project->tracks.insert(project->tracks.begin() + idx, createTrack(project, ""));
+      notifyTrackListChange();
+    }
+
+    void DeleteTrack(MediaTrack* tr) {
+      const auto track = fakeTrack(tr);
+      auto& tracks = fakeProject(track->project)->tracks;
+      // Sends to the deleted track vanish as well
+      for (auto& t : tracks) {
+        auto& sends = t->sends;
+        sends.erase(std::remove_if(sends.begin(), sends.end(), [tr](const FakeSend& send) {
+          return send.destTrack == tr;
+        }), sends.end());
+      }
+      const auto it = std::find_if(tracks.begin(), tracks.end(), [track](const unique_ptr<FakeTrack>& t) {
+        return t.get() == track;
+      });
+      if (it != tracks.end()) {
+        state().deletedTracks.push_back(std::move(*it));
+        tracks.erase(it);
+      }
+      notifyTrackListChange();
+    }
+
+    void* GetSetMediaTrackInfo(MediaTrack* tr, const char* parmname, void* setNewValue) {
+      const auto track = fakeTrack(tr);
+      const string parm = parmname;
+      if (parm == "P_NAME") {
+        if (setNewValue != nullptr) {
+          track->name = static_cast<const char*>(setNewValue);
+          const auto title = track->name.c_str();
+          forEachControlSurface([tr, title](IReaperControlSurface* s) {
+            s->SetTrackTitle(tr, title);
+          });
+        }
+        return &track->name[0];
+      }
+      if (parm == "P_PROJECT") {
+        return track->project;
+      }
+      if (parm == "GUID") {
+        if (setNewValue != nullptr) {
+          track->guid = *static_cast<GUID*>(setNewValue);
+        }
+        return &track->guid;
+      }
+      if (parm == "IP_TRACKNUMBER") {
+        return reinterpret_cast<void*>(static_cast<intptr_t>(indexOf(track) + 1));
+      }
+      if (parm == "D_VOL" || parm == "D_PAN") {
+        auto& value = parm == "D_VOL" ? track->volume : track->pan;
+        if (setNewValue != nullptr) {
+          value = *static_cast<double*>(setNewValue);
+        }
+        return &value;
+      }
+      if (parm == "B_MUTE") {
+        if (setNewValue != nullptr) {
+          track->mute = *static_cast<bool*>(setNewValue);
+        }
+        return &track->mute;
+      }
+      int* intValue = parm == "I_SOLO" ? &track->solo
+          : parm == "I_RECARM" ? &track->recarm
+          : parm == "I_RECMON" ? &track->recmon
+          : parm == "I_RECINPUT" ? &track->recinput
+          : parm == "I_SELECTED" ? &track->selected
+          : parm == "I_AUTOMODE" ? &track->automationMode
+          : nullptr;
+      if (intValue != nullptr && setNewValue != nullptr) {
+        *intValue = *static_cast<int*>(setNewValue);
+      }
+      return intValue;
+    }
+
+    double GetMediaTrackInfo_Value(MediaTrack* tr, const char* parmname) {
+      const auto track = fakeTrack(tr);
+      const string parm = parmname;
+      if (parm == "D_VOL") {
+        return track->volume;
+      }
+      if (parm == "D_PAN") {
+        return track->pan;
+      }
+      if (parm == "B_MUTE") {
+        return track->mute ? 1 : 0;
+      }
+      if (parm == "IP_TRACKNUMBER") {
+        return indexOf(track) + 1;
+      }
+      const auto value = static_cast<int*>(GetSetMediaTrackInfo(tr, parmname, nullptr));
+      return value == nullptr ? 0 : *value;
+    }
+
+    bool SetMediaTrackInfo_Value(MediaTrack* tr, const char* parmname, double newvalue) {
+      const auto track = fakeTrack(tr);
+      const string parm = parmname;
+      if (parm == "D_VOL") {
+        track->volume = newvalue;
+      } else if (parm == "D_PAN") {
+        track->pan = newvalue;
+      } else if (parm == "B_MUTE") {
+        track->mute = newvalue != 0;
+      } else {
+        auto intValue = (int) newvalue;
+        if (GetSetMediaTrackInfo(tr, parmname, nullptr) == nullptr) {
+          return false;
+        }
+        GetSetMediaTrackInfo(tr, parmname, &intValue);
+      }
+      return true;
+    }
+
+    bool GetTrackStateChunk(MediaTrack* track, char* strNeedBig, int strNeedBig_sz, bool) {
+      const auto t = fakeTrack(track);
+      const auto chunk = t->chunk.empty() ? generateChunk(t) : t->chunk;
+      if ((int) chunk.size() >= strNeedBig_sz) {
+        return false;
+      }
+      copyString(chunk, strNeedBig, strNeedBig_sz);
+      return true;
+    }
+
+    // Chunks are stored verbatim, not parsed
+    bool SetTrackStateChunk(MediaTrack* track, const char* str, bool) {
+      fakeTrack(track)->chunk = str;
+      return true;
+    }
+
+    void SetTrackSelected(MediaTrack* track, bool selected) {
+      fakeTrack(track)->selected = selected ? 1 : 0;
+      forEachControlSurface([track, selected](IReaperControlSurface* s) {
+        s->SetSurfaceSelected(track, selected);
+      });
+    }
+
+    void SetOnlyTrackSelected(MediaTrack* track) {
+      const auto project = fakeProject(fakeTrack(track)->project);
+      for (const auto& t : project->tracks) {
+        const bool selected = t.get() == fakeTrack(track);
+        if ((t->selected != 0) != selected) {
+          SetTrackSelected(mediaTrackOf(t.get()), selected);
+        }
+      }
+    }
+
+    int CountSelectedTracks2(ReaProject* proj, bool wantmaster) {
+      const auto project = fakeProject(proj);
+      int count = wantmaster && project->masterTrack->selected ? 1 : 0;
+      for (const auto& t : project->tracks) {
+        count += t->selected ? 1 : 0;
+      }
+      return count;
+    }
+
+    MediaTrack* GetSelectedTrack2(ReaProject* proj, int seltrackidx, bool wantmaster) {
+      const auto project = fakeProject(proj);
+      if (wantmaster && project->masterTrack->selected) {
+        if (seltrackidx == 0) {
+          return mediaTrackOf(project->masterTrack.get());
+        }
+        seltrackidx--;
+      }
+      for (const auto& t : project->tracks) {
+        if (t->selected && seltrackidx-- == 0) {
+          return mediaTrackOf(t.get());
+        }
+      }
+      return nullptr;
+    }
+
+    bool GetTrackUIVolPan(MediaTrack* track, double* volumeOut, double* panOut) {
+      *volumeOut = fakeTrack(track)->volume;
+      *panOut = fakeTrack(track)->pan;
+      return true;
+    }
+
+    void CSurf_SetSurfaceVolume(MediaTrack* trackid, double volume, IReaperControlSurface* ignoresurf) {
+      forEachControlSurface([trackid, volume](IReaperControlSurface* s) {
+        s->SetSurfaceVolume(trackid, volume);
+      }, ignoresurf);
+    }
+
+    void CSurf_SetSurfacePan(MediaTrack* trackid, double pan, IReaperControlSurface* ignoresurf) {
+      forEachControlSurface([trackid, pan](IReaperControlSurface* s) {
+        s->SetSurfacePan(trackid, pan);
+      }, ignoresurf);
+    }
+
+    void CSurf_SetSurfaceMute(MediaTrack* trackid, bool mute, IReaperControlSurface* ignoresurf) {
+      forEachControlSurface([trackid, mute](IReaperControlSurface* s) {
+        s->SetSurfaceMute(trackid, mute);
+      }, ignoresurf);
+    }
+
+    void CSurf_SetSurfaceSolo(MediaTrack* trackid, bool solo, IReaperControlSurface* ignoresurf) {
+      forEachControlSurface([trackid, solo](IReaperControlSurface* s) {
+        s->SetSurfaceSolo(trackid, solo);
+      }, ignoresurf);
+    }
+
+    double CSurf_OnVolumeChangeEx(MediaTrack* trackid, double volume, bool relative, bool) {
+      auto& value = fakeTrack(trackid)->volume;
+      value = relative ? value + volume : volume;
+      CSurf_SetSurfaceVolume(trackid, value, nullptr);
+      return value;
+    }
+
+    double CSurf_OnPanChangeEx(MediaTrack* trackid, double pan, bool relative, bool) {
+      auto& value = fakeTrack(trackid)->pan;
+      value = std::max(-1.0, std::min(1.0, relative ? value + pan : pan));
+      CSurf_SetSurfacePan(trackid, value, nullptr);
+      return value;
+    }
+
+    // recarm < 0 toggles
+    bool CSurf_OnRecArmChangeEx(MediaTrack* trackid, int recarm, bool) {
+      auto& value = fakeTrack(trackid)->recarm;
+      value = recarm < 0 ? (value ? 0 : 1) : (recarm ? 1 : 0);
+      const bool armed = value != 0;
+      forEachControlSurface([trackid, armed](IReaperControlSurface* s) {
+        s->SetSurfaceRecArm(trackid, armed);
+      });
+      return armed;
+    }
+
+    int CSurf_OnInputMonitorChangeEx(MediaTrack* trackid, int monitor, bool) {
+      auto& value = fakeTrack(trackid)->recmon;
+      value = monitor;
+      forEachControlSurface([trackid, &value](IReaperControlSurface* s) {
+        s->Extended(CSURF_EXT_SETINPUTMONITOR, trackid, &value, nullptr);
+      });
+      return value;
+    }
+
+    void TrackList_UpdateAllExternalSurfaces() {
+      notifyTrackListChange();
+    }
+
+    // Supports sends (category 0) and receives (category < 0)
+    int GetTrackNumSends(MediaTrack* tr, int category) {
+      const auto track = fakeTrack(tr);
+      if (category == 0) {
+        return (int) track->sends.size();
+      }
+      if (category > 0) {
+        return 0;
+      }
+      int count = 0;
+      for (const auto& t : fakeProject(track->project)->tracks) {
+        count += (int) std::count_if(t->sends.begin(), t->sends.end(), [tr](const FakeSend& send) {
+          return send.destTrack == tr;
+        });
+      }
+      return count;
+    }
+
+    // Returns the source track and the send of the given receive
+    std::pair<FakeTrack*, FakeSend*> findReceive(MediaTrack* tr, int recvidx) {
+      for (const auto& t : fakeProject(fakeTrack(tr)->project)->tracks) {
+        for (auto& send : t->sends) {
+          if (send.destTrack == tr && recvidx-- == 0) {
+            return {t.get(), &send};
+          }
+        }
+      }
+      return {nullptr, nullptr};
+    }
+
+    void* GetSetTrackSendInfo(MediaTrack* tr, int category, int sendidx, const char* parmname, void* setNewValue) {
+      const auto track = fakeTrack(tr);
+      FakeTrack* sourceTrack = track;
+      FakeSend* send = nullptr;
+      if (category == 0) {
+        if (sendidx >= 0 && sendidx < (int) track->sends.size()) {
+          send = &track->sends[sendidx];
+        }
+      } else if (category < 0) {
+        std::tie(sourceTrack, send) = findReceive(tr, sendidx);
+      }
+      if (send == nullptr) {
+        return nullptr;
+      }
+      const string parm = parmname;
+      if (parm == "P_DESTTRACK") {
+        return send->destTrack;
+      }
+      if (parm == "P_SRCTRACK") {
+        return mediaTrackOf(sourceTrack);
+      }
+      if (parm == "D_VOL" || parm == "D_PAN") {
+        auto& value = parm == "D_VOL" ? send->volume : send->pan;
+        if (setNewValue != nullptr) {
+          value = *static_cast<double*>(setNewValue);
+        }
+        return &value;
+      }
+      return nullptr;
+    }
+
+    int CreateTrackSend(MediaTrack* tr, MediaTrack* desttrInOptional) {
+      auto& sends = fakeTrack(tr)->sends;
+      sends.push_back(FakeSend{desttrInOptional, 1, 0});
+      return (int) sends.size() - 1;
+    }
+
+    bool GetTrackSendName(MediaTrack* track, int send_index, char* buf, int buf_sz) {
+      const auto& sends = fakeTrack(track)->sends;
+      if (send_index < 0 || send_index >= (int) sends.size()) {
+        return false;
+      }
+      const auto dest = fakeTrack(sends[send_index].destTrack);
+      copyString(dest == nullptr ? "" : dest->name, buf, buf_sz);
+      return true;
+    }
+
+    bool GetTrackSendUIVolPan(MediaTrack* track, int send_index, double* volumeOut, double* panOut) {
+      const auto& sends = fakeTrack(track)->sends;
+      if (send_index < 0 || send_index >= (int) sends.size()) {
+        return false;
+      }
+      *volumeOut = sends[send_index].volume;
+      *panOut = sends[send_index].pan;
+      return true;
+    }
+
+    double CSurf_OnSendVolumeChange(MediaTrack* trackid, int send_index, double volume, bool relative) {
+      auto& sends = fakeTrack(trackid)->sends;
+      if (send_index < 0 || send_index >= (int) sends.size()) {
+        return 0;
+      }
+      auto& value = sends[send_index].volume;
+      value = relative ? value + volume : volume;
+      forEachControlSurface([trackid, &send_index, &value](IReaperControlSurface* s) {
+        s->Extended(CSURF_EXT_SETSENDVOLUME, trackid, &send_index, &value);
+      });
+      return value;
+    }
+
+    double CSurf_OnSendPanChange(MediaTrack* trackid, int send_index, double pan, bool relative) {
+      auto& sends = fakeTrack(trackid)->sends;
+      if (send_index < 0 || send_index >= (int) sends.size()) {
+        return 0;
+      }
+      auto& value = sends[send_index].pan;
+      value = std::max(-1.0, std::min(1.0, relative ? value + pan : pan));
+      forEachControlSurface([trackid, &send_index, &value](IReaperControlSurface* s) {
+        s->Extended(CSURF_EXT_SETSENDPAN, trackid, &send_index, &value);
+      });
+      return value;
+    }
+
+    int TrackFX_GetCount(MediaTrack* track) {
+      return (int) fakeTrack(track)->fxs.size();
+    }
+
+    int TrackFX_GetRecCount(MediaTrack* track) {
+      return (int) fakeTrack(track)->inputFxs.size();
+    }
+
+    GUID* TrackFX_GetFXGUID(MediaTrack* track, int fx) {
+      const auto f = resolveFx(track, fx);
+      return f == nullptr ? nullptr : &f->guid;
+    }
+
+    bool TrackFX_GetFXName(MediaTrack* track, int fx, char* buf, int buf_sz) {
+      const auto f = resolveFx(track, fx);
+      if (f == nullptr) {
+        return false;
+      }
+      copyString(f->name, buf, buf_sz);
+      return true;
+    }
+
+    int TrackFX_GetNumParams(MediaTrack* track, int fx) {
+      const auto f = resolveFx(track, fx);
+      return f == nullptr ? 0 : (int) f->params.size();
+    }
+
+    bool TrackFX_GetParamName(MediaTrack* track, int fx, int param, char* buf, int buf_sz) {
+      const auto f = resolveFx(track, fx);
+      if (f == nullptr || param < 0 || param >= (int) f->params.size()) {
+        return false;
+      }
+      copyString("Param " + std::to_string(param + 1), buf, buf_sz);
+      return true;
+    }
+
+    double TrackFX_GetParamNormalized(MediaTrack* track, int fx, int param) {
+      const auto f = resolveFx(track, fx);
+      if (f == nullptr || param < 0 || param >= (int) f->params.size()) {
+        return -1;
+      }
+      return f->params[param];
+    }
+
+    double TrackFX_GetParamEx(MediaTrack* track, int fx, int param, double* minvalOut, double* maxvalOut,
+        double* midvalOut) {
+      *minvalOut = 0;
+      *maxvalOut = 1;
+      *midvalOut = 0.5;
+      return TrackFX_GetParamNormalized(track, fx, param);
+    }
+
+    bool TrackFX_SetParamNormalized(MediaTrack* track, int fx, int param, double value) {
+      const auto f = resolveFx(track, fx);
+      if (f == nullptr || param < 0 || param >= (int) f->params.size()) {
+        return false;
+      }
+      f->params[param] = value;
+      const bool isInputFx = fx >= INPUT_FX_QUERY_INDEX_OFFSET;
+      const auto fxIndex = isInputFx ? fx - INPUT_FX_QUERY_INDEX_OFFSET : fx;
+      // Before 5.95 REAPER reported input FX parameter changes like normal ones
+      const bool supportsRecFx = state().appVersion >= "5.95";
+      const auto call = isInputFx && supportsRecFx ? CSURF_EXT_SETFXPARAM_RECFX : CSURF_EXT_SETFXPARAM;
+      int fxAndParamIndex = (fxIndex << 16) | param;
+      forEachControlSurface([track, call, &fxAndParamIndex, &value](IReaperControlSurface* s) {
+        s->Extended(call, track, &fxAndParamIndex, &value);
+      });
+      return true;
+    }
+
+    bool TrackFX_GetEnabled(MediaTrack* track, int fx) {
+      const auto f = resolveFx(track, fx);
+      return f != nullptr && f->enabled;
+    }
+
+    void TrackFX_SetEnabled(MediaTrack* track, int fx, bool enabled) {
+      const auto f = resolveFx(track, fx);
+      if (f == nullptr) {
+        return;
+      }
+      f->enabled = enabled;
+      int fxIndex = fx >= INPUT_FX_QUERY_INDEX_OFFSET ? fx - INPUT_FX_QUERY_INDEX_OFFSET : fx;
+      forEachControlSurface([track, &fxIndex, enabled](IReaperControlSurface* s) {
+        s->Extended(CSURF_EXT_SETFXENABLED, track, &fxIndex, enabled ? (void*) 1 : nullptr);
+      });
+    }
+
+    bool TrackFX_GetOpen(MediaTrack*, int) {
+      return false;
+    }
+
+    // instantiate: 0 = query only, > 0 = add if not found, < 0 = always add
+    int TrackFX_AddByName(MediaTrack* track, const char* fxname, bool recFX, int instantiate) {
+      auto& chain = fxChainOf(fakeTrack(track), recFX);
+      if (instantiate >= 0) {
+        const auto it = std::find_if(chain.begin(), chain.end(), [fxname](const FakeFx& fx) {
+          return fx.name == fxname;
+        });
+        if (it != chain.end()) {
+          return (int) (it - chain.begin());
+        }
+        if (instantiate == 0) {
+          return -1;
+        }
+      }
+      chain.push_back(createFx(fxname, DEFAULT_FX_PARAM_COUNT));
+      notifyFxChange(track);
+      return (int) chain.size() - 1;
+    }
+
+    bool GetLastTouchedFX(int*, int*, int*) {
+      return false;
+    }
+
+    int GetFocusedFX(int*, int*, int*) {
+      return 0;
+    }
+
+    int GetGlobalAutomationOverride() {
+      return state().globalAutomationOverride;
+    }
+
+    int GetTrackAutomationMode(MediaTrack* tr) {
+      return fakeTrack(tr)->automationMode;
+    }
+
+    TrackEnvelope* GetTrackEnvelopeByName(MediaTrack* track, const char* envname) {
+      auto& envelopes = fakeTrack(track)->envelopes;
+      const auto it = std::find(envelopes.begin(), envelopes.end(), string(envname));
+      return it == envelopes.end() ? nullptr : reinterpret_cast<TrackEnvelope*>(&*it);
+    }
+
+    double Master_GetTempo() {
+      return state().tempo;
+    }
+
+    void SetCurrentBPM(ReaProject*, double bpm, bool) {
+      state().tempo = bpm;
+      forEachControlSurface([&bpm](IReaperControlSurface* s) {
+        s->Extended(CSURF_EXT_SETBPMANDPLAYRATE, &bpm, nullptr, nullptr);
+      });
+    }
+
+    double Master_GetPlayRate(ReaProject*) {
+      return state().playrate;
+    }
+
+    void CSurf_OnPlayRateChange(double playrate) {
+      state().playrate = playrate;
+      forEachControlSurface([&playrate](IReaperControlSurface* s) {
+        s->Extended(CSURF_EXT_SETBPMANDPLAYRATE, nullptr, &playrate, nullptr);
+      });
+    }
+
+    int Audio_RegHardwareHook(bool isAdd, audio_hook_register_t* reg) {
+      return plugin_register(isAdd ? "audio_hook" : "-audio_hook", reg);
+    }
+
+    int GetMaxMidiInputs() {
+      const auto& inputs = state().midiInputs;
+      return inputs.empty() ? 0 : inputs.rbegin()->first + 1;
+    }
+
+    int GetMaxMidiOutputs() {
+      const auto& outputs = state().midiOutputs;
+      return outputs.empty() ? 0 : outputs.rbegin()->first + 1;
+    }
+
+    midi_Input* GetMidiInput(int idx) {
+      const auto it = state().midiInputs.find(idx);
+      return it == state().midiInputs.end() ? nullptr : it->second.get();
+    }
+
+    midi_Output* GetMidiOutput(int idx) {
+      const auto it = state().midiOutputs.find(idx);
+      return it == state().midiOutputs.end() ? nullptr : it->second.get();
+    }
+
+    bool GetMIDIInputName(int dev, char* nameout, int nameout_sz) {
+      const auto it = state().midiInputs.find(dev);
+      if (it == state().midiInputs.end()) {
+        return false;
+      }
+      copyString(it->second->name, nameout, nameout_sz);
+      return true;
+    }
+
+    bool GetMIDIOutputName(int dev, char* nameout, int nameout_sz) {
+      const auto it = state().midiOutputs.find(dev);
+      if (it == state().midiOutputs.end()) {
+        return false;
+      }
+      copyString(it->second->name, nameout, nameout_sz);
+      return true;
+    }
+
+    void StuffMIDIMessage(int, int, int, int) {
+    }
+
+#define FAKE_REAPER_API(name) {#name, reinterpret_cast<void*>(&name)}
+
+    const std::unordered_map<string, void*>& apiFunctions() {
+      static const std::unordered_map<string, void*> FUNCTIONS = {
+          FAKE_REAPER_API(plugin_register),
+          FAKE_REAPER_API(GetAppVersion),
+          FAKE_REAPER_API(GetMainHwnd),
+          FAKE_REAPER_API(GetResourcePath),
+          FAKE_REAPER_API(GetExePath),
+          FAKE_REAPER_API(ShowConsoleMsg),
+          FAKE_REAPER_API(ClearConsole),
+          FAKE_REAPER_API(genGuid),
+          FAKE_REAPER_API(guidToString),
+          FAKE_REAPER_API(stringToGuid),
+          FAKE_REAPER_API(EnumProjects),
+          FAKE_REAPER_API(GetCurrentProjectInLoadSave),
+          FAKE_REAPER_API(ValidatePtr2),
+          FAKE_REAPER_API(MarkProjectDirty),
+          FAKE_REAPER_API(Undo_BeginBlock2),
+          FAKE_REAPER_API(Undo_EndBlock2),
+          FAKE_REAPER_API(CountTracks),
+          FAKE_REAPER_API(GetTrack),
+          FAKE_REAPER_API(GetMasterTrack),
+          FAKE_REAPER_API(InsertTrackAtIndex),
+          FAKE_REAPER_API(DeleteTrack),
+          FAKE_REAPER_API(GetSetMediaTrackInfo),
+          FAKE_REAPER_API(GetMediaTrackInfo_Value),
+          FAKE_REAPER_API(SetMediaTrackInfo_Value),
+          FAKE_REAPER_API(GetTrackStateChunk),
+          FAKE_REAPER_API(SetTrackStateChunk),
+          FAKE_REAPER_API(SetTrackSelected),
+          FAKE_REAPER_API(SetOnlyTrackSelected),
+          FAKE_REAPER_API(CountSelectedTracks2),
+          FAKE_REAPER_API(GetSelectedTrack2),
+          FAKE_REAPER_API(GetTrackUIVolPan),
+          FAKE_REAPER_API(CSurf_SetSurfaceVolume),
+          FAKE_REAPER_API(CSurf_SetSurfacePan),
+          FAKE_REAPER_API(CSurf_SetSurfaceMute),
+          FAKE_REAPER_API(CSurf_SetSurfaceSolo),
+          FAKE_REAPER_API(CSurf_OnVolumeChangeEx),
+          FAKE_REAPER_API(CSurf_OnPanChangeEx),
+          FAKE_REAPER_API(CSurf_OnRecArmChangeEx),
+          FAKE_REAPER_API(CSurf_OnInputMonitorChangeEx),
+          FAKE_REAPER_API(TrackList_UpdateAllExternalSurfaces),
+          FAKE_REAPER_API(GetTrackNumSends),
+          FAKE_REAPER_API(GetSetTrackSendInfo),
+          FAKE_REAPER_API(CreateTrackSend),
+          FAKE_REAPER_API(GetTrackSendName),
+          FAKE_REAPER_API(GetTrackSendUIVolPan),
+          FAKE_REAPER_API(CSurf_OnSendVolumeChange),
+          FAKE_REAPER_API(CSurf_OnSendPanChange),
+          FAKE_REAPER_API(TrackFX_GetCount),
+          FAKE_REAPER_API(TrackFX_GetRecCount),
+          FAKE_REAPER_API(TrackFX_GetFXGUID),
+          FAKE_REAPER_API(TrackFX_GetFXName),
+          FAKE_REAPER_API(TrackFX_GetNumParams),
+          FAKE_REAPER_API(TrackFX_GetParamName),
+          FAKE_REAPER_API(TrackFX_GetParamNormalized),
+          FAKE_REAPER_API(TrackFX_GetParamEx),
+          FAKE_REAPER_API(TrackFX_SetParamNormalized),
+          FAKE_REAPER_API(TrackFX_GetEnabled),
+          FAKE_REAPER_API(TrackFX_SetEnabled),
+          FAKE_REAPER_API(TrackFX_GetOpen),
+          FAKE_REAPER_API(TrackFX_AddByName),
+          FAKE_REAPER_API(GetLastTouchedFX),
+          FAKE_REAPER_API(GetFocusedFX),
+          FAKE_REAPER_API(GetGlobalAutomationOverride),
+          FAKE_REAPER_API(GetTrackAutomationMode),
+          FAKE_REAPER_API(GetTrackEnvelopeByName),
+          FAKE_REAPER_API(Master_GetTempo),
+          FAKE_REAPER_API(SetCurrentBPM),
+          FAKE_REAPER_API(Master_GetPlayRate),
+          FAKE_REAPER_API(CSurf_OnPlayRateChange),
+          FAKE_REAPER_API(Audio_RegHardwareHook),
+          FAKE_REAPER_API(GetMaxMidiInputs),
+          FAKE_REAPER_API(GetMaxMidiOutputs),
+          FAKE_REAPER_API(GetMidiInput),
+          FAKE_REAPER_API(GetMidiOutput),
+          FAKE_REAPER_API(GetMIDIInputName),
+          FAKE_REAPER_API(GetMIDIOutputName),
+          FAKE_REAPER_API(StuffMIDIMessage),
+      };
+      return FUNCTIONS;
+    }
+
+#undef FAKE_REAPER_API
+  }
+
+  FakeReaper::FakeReaper() : state_(new FakeReaperState) {
+    if (STATE != nullptr) {
+      throw std::logic_error("there can only be one FakeReaper instance at a time");
+    }
+    STATE = state_.get();
+    state_->projects.push_back(createProject());
+    state_->currentProject = state_->projects.front().get();
+    // Returns the number of functions not simulated, which is expected
+    reaper::REAPERAPI_LoadAPI(&FakeReaper::getApi);
+  }
+
+  FakeReaper::~FakeReaper() {
+    // Reaper unregisters its hooks and surfaces via the API, so it must go first. Also keeps a failed test from
+    // leaking the Reaper instance into the next one.
+    Reaper::destroyInstance();
+    STATE = nullptr;
+  }
+
+  void* FakeReaper::getApi(const char* name) {
+    const auto& functions = apiFunctions();
+    const auto it = functions.find(name);
+    return it == functions.end() ? nullptr : it->second;
+  }
+
+  void FakeReaper::setAppVersion(const std::string& version) {
+    state_->appVersion = version;
+  }
+
+  ReaProject* FakeReaper::currentProject() const {
+    return reaProjectOf(state_->currentProject);
+  }
+
+  ReaProject* FakeReaper::addProject() {
+    state_->projects.push_back(createProject());
+    state_->currentProject = state_->projects.back().get();
+    notifyTrackListChange();
+    return reaProjectOf(state_->currentProject);
+  }
+
+  void FakeReaper::setCurrentProject(ReaProject* project) {
+    state_->currentProject = fakeProject(project);
+    notifyTrackListChange();
+  }
+
+  void FakeReaper::closeProject(ReaProject* project) {
+    auto& projects = state_->projects;
+    const auto p = fakeProject(project);
+    projects.erase(std::remove_if(projects.begin(), projects.end(), [p](const unique_ptr<FakeProject>& candidate) {
+      return candidate.get() == p;
+    }), projects.end());
+    // Like REAPER, always keep at least one project open
+    if (projects.empty()) {
+      projects.push_back(createProject());
+    }
+    if (state_->currentProject == p) {
+      state_->currentProject = projects.front().get();
+    }
+    notifyTrackListChange();
+  }
+
+  MediaTrack* FakeReaper::insertTrack(ReaProject* project, int index, const std::string& name) {
+    const auto p = fakeProject(project);
+    index = std::max(0, std::min(index, (int) p->tracks.size()));
+    p->tracks.insert(p->tracks.begin() + index, createTrack(p, name));
+    const auto mediaTrack = mediaTrackOf(p->tracks[index].get());
+    notifyTrackListChange();
+    return mediaTrack;
+  }
+
+  void FakeReaper::removeTrack(MediaTrack* track) {
+    DeleteTrack(track);
+  }
+
+  void FakeReaper::batchTrackListChanges(const std::function<void()>& changes) {
+    state_->trackListChangeBatchDepth++;
+    try {
+      changes();
+    } catch (...) {
+      state_->trackListChangeBatchDepth--;
+      throw;
+    }
+    if (--state_->trackListChangeBatchDepth == 0 && state_->trackListChangePending) {
+      state_->trackListChangePending = false;
+      notifyTrackListChange();
+    }
+  }
+
+  void FakeReaper::moveTrack(MediaTrack* track, int newIndex) {
+    auto& tracks = fakeProject(fakeTrack(track)->project)->tracks;
+    const auto oldIndex = indexOf(fakeTrack(track));
+    if (oldIndex < 0) {
+      return;
+    }
+    auto t = std::move(tracks[oldIndex]);
+    tracks.erase(tracks.begin() + oldIndex);
+    newIndex = std::max(0, std::min(newIndex, (int) tracks.size()));
+    tracks.insert(tracks.begin() + newIndex, std::move(t));
+    notifyTrackListChange();
+  }
+
+  int FakeReaper::addFx(MediaTrack* track, const std::string& name, int paramCount, bool isInputFx) {
+    auto& chain = fxChainOf(fakeTrack(track), isInputFx);
+    chain.push_back(createFx(name, paramCount));
+    notifyFxChange(track);
+    return (int) chain.size() - 1;
+  }
+
+  void FakeReaper::removeFx(MediaTrack* track, int fxIndex, bool isInputFx) {
+    auto& chain = fxChainOf(fakeTrack(track), isInputFx);
+    chain.erase(chain.begin() + fxIndex);
+    notifyFxChange(track);
+  }
+
+  void FakeReaper::moveFx(MediaTrack* track, int fromIndex, int toIndex, bool isInputFx) {
+    auto& chain = fxChainOf(fakeTrack(track), isInputFx);
+    auto fx = chain[fromIndex];
+    chain.erase(chain.begin() + fromIndex);
+    chain.insert(chain.begin() + toIndex, fx);
+    notifyFxChange(track);
+  }
+
+  void FakeReaper::setGlobalAutomationOverride(int mode) {
+    state_->globalAutomationOverride = mode;
+    forEachControlSurface([mode](IReaperControlSurface* s) {
+      s->SetAutoMode(mode);
+    });
+  }
+
+  void FakeReaper::setTrackAutomationMode(MediaTrack* track, int mode) {
+    fakeTrack(track)->automationMode = mode;
+    forEachControlSurface([mode](IReaperControlSurface* s) {
+      s->SetAutoMode(mode);
+    });
+  }
+
+  void FakeReaper::addTrackEnvelope(MediaTrack* track, const std::string& name) {
+    fakeTrack(track)->envelopes.push_back(name);
+  }
+
+  void FakeReaper::addMidiInputDevice(int deviceId, const std::string& name) {
+    state_->midiInputs[deviceId] = unique_ptr<FakeMidiInput>(new FakeMidiInput(name));
+  }
+
+  void FakeReaper::addMidiOutputDevice(int deviceId, const std::string& name) {
+    state_->midiOutputs[deviceId] = unique_ptr<FakeMidiOutput>(new FakeMidiOutput(name));
+  }
+
+  void FakeReaper::queueMidiInputEvent(int deviceId, const std::vector<unsigned char>& bytes, int frameOffset) {
+    const auto& input = state_->midiInputs.at(deviceId);
+    // At least 3 bytes, like REAPER does for short messages
+    const auto size = std::max<std::size_t>(3, bytes.size());
+    vector<char> buffer(sizeof(MIDI_event_t) + std::max<std::size_t>(4, size) - 4);
+    const auto event = reinterpret_cast<MIDI_event_t*>(buffer.data());
+    event->frame_offset = frameOffset;
+    event->size = (int) size;
+    std::copy(bytes.begin(), bytes.end(), event->midi_message);
+    input->pending.AddItem(event);
+  }
+
+  const std::vector<std::vector<unsigned char>>& FakeReaper::sentMidiMessages(int deviceId) const {
+    return state_->midiOutputs.at(deviceId)->sentMessages;
+  }
+
+  const std::vector<int>& FakeReaper::sentMidiFrameOffsets(int deviceId) const {
+    return state_->midiOutputs.at(deviceId)->sentFrameOffsets;
+  }
+
+  void FakeReaper::setHardwareOutputSamples(const std::vector<std::vector<ReaSample>>& channels) {
+    state_->hardwareOutputSamples = channels;
+  }
+
+  void FakeReaper::runControlSurfaces() {
+    forEachControlSurface([](IReaperControlSurface* s) {
+      s->Run();
+    });
+  }
+
+  void FakeReaper::processAudioBlock(int length, double sampleRate) {
+    for (const auto& input : state_->midiInputs) {
+      input.second->SwapBufs(0);
+    }
+    auto& hooks = state_->audioHooksBuffer;
+    hooks.clear();
+    for (const auto& r : state_->registrations) {
+      if (r.first == "audio_hook") {
+        hooks.push_back(static_cast<audio_hook_register_t*>(r.second));
+      }
+    }
+    for (const auto hook : hooks) {
+      hook->input_nch = 0;
+      hook->output_nch = (int) state_->hardwareOutputSamples.size();
+      hook->GetBuffer = &getAudioBuffer;
+    }
+    for (const auto isPost : {false, true}) {
+      for (const auto hook : hooks) {
+        hook->OnAudioBuffer(isPost, length, sampleRate, hook);
+      }
+    }
+  }
+
+  std::vector<void*> FakeReaper::registrations(const std::string& name) const {
+    vector<void*> result;
+    for (const auto& r : state_->registrations) {
+      if (r.first == name) {
+        result.push_back(r.second);
+      }
+    }
+    return result;
+  }
+
+  const std::string& FakeReaper::consoleOutput() const {
+    return state_->consoleOutput;
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <reaper_plugin.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace reaplus {
+  struct FakeReaperState;
+
+  // In-process stand-in for REAPER, so ReaPlus can run headless (tests, benchmarks). Simulates projects, tracks, FX,
+  // sends, track chunks and MIDI devices and drives the registered control surfaces and audio hooks. API functions
+  // which aren't simulated resolve to nullptr.
+  //
+  // Defines the reaper:: function pointers (REAPERAPI_IMPLEMENT). Only one instance may exist at a time. Not
+  // thread-safe: processAudioBlock() stands in for the audio thread and must not run concurrently with anything else.
+  class FakeReaper {
+  public:
+    // Makes the function pointers in namespace reaper point to the simulation. Starts with one empty project.
+    FakeReaper();
+
+    // Destroys the Reaper instance (if any) while the simulation is still available
+    ~FakeReaper();
+
+    FakeReaper(const FakeReaper&) = delete;
+
+    FakeReaper& operator=(const FakeReaper&) = delete;
+
+    // Suitable for REAPERAPI_LoadAPI
+    static void* getApi(const char* name);
+
+    // Version reported by GetAppVersion(), e.g. "5.94/x64" in order to simulate the absence of
+    // CSURF_EXT_SETFXPARAM_RECFX
+    void setAppVersion(const std::string& version);
+
+    ReaProject* currentProject() const;
+
+    // Opens a new project tab and makes it the current one
+    ReaProject* addProject();
+
+    void setCurrentProject(ReaProject* project);
+
+    void closeProject(ReaProject* project);
+
+    // Notifies control surfaces like REAPER does
+    MediaTrack* insertTrack(ReaProject* project, int index, const std::string& name = "");
+
+    void moveTrack(MediaTrack* track, int newIndex);
+
+    // Like DeleteTrack(). The track stays allocated, so its address isn't reused by new tracks.
+    void removeTrack(MediaTrack* track);
+
+    // Applies the changes and notifies control surfaces just once, like REAPER does for several changes within one
+    // undo block
+    void batchTrackListChanges(const std::function<void()>& changes);
+
+    // Returns the index of the new FX
+    int addFx(MediaTrack* track, const std::string& name, int paramCount, bool isInputFx = false);
+
+    void removeFx(MediaTrack* track, int fxIndex, bool isInputFx = false);
+
+    void moveFx(MediaTrack* track, int fromIndex, int toIndex, bool isInputFx = false);
+
+    void setGlobalAutomationOverride(int mode);
+
+    void setTrackAutomationMode(MediaTrack* track, int mode);
+
+    void addTrackEnvelope(MediaTrack* track, const std::string& name);
+
+    void addMidiInputDevice(int deviceId, const std::string& name);
+
+    void addMidiOutputDevice(int deviceId, const std::string& name);
+
+    // Delivered with the next processAudioBlock()
+    void queueMidiInputEvent(int deviceId, const std::vector<unsigned char>& bytes, int frameOffset = 0);
+
+    // Short messages sent to the given output device so far
+    const std::vector<std::vector<unsigned char>>& sentMidiMessages(int deviceId) const;
+
+    // Frame offsets of sentMidiMessages(), in units of 1/1024000 of a second
+    const std::vector<int>& sentMidiFrameOffsets(int deviceId) const;
+
+    // Samples of the hardware output channels, handed to audio hooks via GetBuffer(true, channel). Each channel needs
+    // at least as many samples as the blocks passed to processAudioBlock().
+    void setHardwareOutputSamples(const std::vector<std::vector<ReaSample>>& channels);
+
+    // Calls Run() on all registered control surfaces
+    void runControlSurfaces();
+
+    // Calls all registered audio hooks (pre and post), like the audio thread would do once per block. Doesn't allocate
+    // once it has been called with the same number of hooks before.
+    void processAudioBlock(int length, double sampleRate = 44100);
+
+    // Everything registered via plugin_register() with the given name and not unregistered yet
+    std::vector<void*> registrations(const std::string& name) const;
+
+    const std::string& consoleOutput() const;
+
+  private:
+    std::unique_ptr<FakeReaperState> state_;
+  };
+}
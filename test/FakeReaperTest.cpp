@@ -0,0 +1,88 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Project.h>
+#include <reaplus/Track.h>
+#include <reaplus/FxChain.h>
+#include <reaplus/Fx.h>
+#include <reaper_plugin_functions.h>
+
+using namespace reaplus;
+
+namespace {
+  class CountingControlSurface : public IReaperControlSurface {
+  public:
+    int trackListChangeCount = 0;
+    int fxParamCount = 0;
+    int inputFxParamCount = 0;
+
+    const char* GetTypeString() override {
+      return "COUNTING";
+    }
+
+    const char* GetDescString() override {
+      return "";
+    }
+
+    const char* GetConfigString() override {
+      return "";
+    }
+
+    void SetTrackListChange() override {
+      trackListChangeCount++;
+    }
+
+    int Extended(int call, void*, void*, void*) override {
+      if (call == CSURF_EXT_SETFXPARAM) {
+        fxParamCount++;
+      } else if (call == CSURF_EXT_SETFXPARAM_RECFX) {
+        inputFxParamCount++;
+      }
+      return 0;
+    }
+  };
+}
+
+TEST_CASE("Fake REAPER serves tracks to the ReaPlus wrappers") {
+  FakeReaper fake;
+  const auto mediaTrack = fake.insertTrack(fake.currentProject(), 0, "Drums");
+  fake.insertTrack(fake.currentProject(), 1, "Bass");
+  const Project project(fake.currentProject());
+  REQUIRE(project.trackCount() == 2);
+  const Track track(mediaTrack, fake.currentProject());
+  REQUIRE(track.name() == "Drums");
+  REQUIRE(track.index() == 0);
+  REQUIRE(project.trackByGuid(track.guid()).mediaTrack() == mediaTrack);
+}
+
+TEST_CASE("Fake REAPER notifies control surfaces") {
+  FakeReaper fake;
+  CountingControlSurface surface;
+  reaper::plugin_register("csurf_inst", &surface);
+  const auto mediaTrack = fake.insertTrack(fake.currentProject(), 0);
+  REQUIRE(surface.trackListChangeCount == 1);
+  fake.addFx(mediaTrack, "ReaEQ", 4);
+  fake.addFx(mediaTrack, "ReaComp", 4, true);
+  reaper::TrackFX_SetParamNormalized(mediaTrack, 0, 1, 0.5);
+  reaper::TrackFX_SetParamNormalized(mediaTrack, 0x1000000, 1, 0.5);
+  REQUIRE(surface.fxParamCount == 1);
+  REQUIRE(surface.inputFxParamCount == 1);
+  SECTION("Before REAPER 5.95, input FX are reported like normal FX") {
+    fake.setAppVersion("5.94/x64");
+    reaper::TrackFX_SetParamNormalized(mediaTrack, 0x1000000, 1, 0.7);
+    REQUIRE(surface.fxParamCount == 2);
+  }
+  reaper::plugin_register("-csurf_inst", &surface);
+}
+
+TEST_CASE("Fake REAPER identifies FX by GUID") {
+  FakeReaper fake;
+  const Track track(fake.insertTrack(fake.currentProject(), 0), fake.currentProject());
+  fake.addFx(track.mediaTrack(), "ReaEQ", 4);
+  fake.addFx(track.mediaTrack(), "ReaComp", 4);
+  const auto fxChain = track.normalFxChain();
+  REQUIRE(fxChain.fxCount() == 2);
+  const auto comp = fxChain.fxByIndex(1);
+  REQUIRE(comp.is_initialized());
+  fake.moveFx(track.mediaTrack(), 1, 0);
+  REQUIRE(fxChain.fxByGuid(comp->guid()).index() == 0);
+}
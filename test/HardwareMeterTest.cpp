@@ -0,0 +1,76 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Reaper.h>
+#include <reaplus/HardwareMeter.h>
+#include <reaplus/util/MeterKernels.h>
+#include <cmath>
+#include <vector>
+
+using namespace reaplus;
+
+TEST_CASE("Meter kernel measures peak and sum of squares including the remainder") {
+  std::vector<ReaSample> samples;
+  double expectedSumOfSquares = 0;
+  for (int i = 0; i < 37; i++) {
+    const auto sample = std::sin(i * 0.3) * 0.5;
+    samples.push_back(sample);
+    expectedSumOfSquares += sample * sample;
+  }
+  // Peak in the scalar remainder
+  samples[36] = -0.9;
+  expectedSumOfSquares += 0.81 - std::pow(std::sin(36 * 0.3) * 0.5, 2);
+  const auto result = util::measurePeakAndSumOfSquares(samples.data(), (int) samples.size());
+  REQUIRE(result.peak == Approx(0.9));
+  REQUIRE(result.sumOfSquares == Approx(expectedSumOfSquares));
+}
+
+TEST_CASE("Hardware meter measures output channels with decay and hold") {
+  FakeReaper fake;
+  auto& meter = Reaper::instance().hardwareMeter();
+  const int blockLength = 441;
+  fake.setHardwareOutputSamples({
+      std::vector<ReaSample>(blockLength, 0.5),
+      std::vector<ReaSample>(blockLength, -0.25)
+  });
+  SECTION("Disabled by default") {
+    fake.processAudioBlock(blockLength);
+    REQUIRE(meter.channelCount() == 0);
+    REQUIRE(meter.level(0).peak == 0);
+  }
+  SECTION("Peak and RMS") {
+    meter.setEnabled(true);
+    fake.processAudioBlock(blockLength);
+    REQUIRE(meter.channelCount() == 2);
+    REQUIRE(meter.level(0).peak == Approx(0.5));
+    REQUIRE(meter.level(0).rms == Approx(0.5));
+    REQUIRE(meter.level(1).peak == Approx(0.25));
+    REQUIRE(meter.level(1).heldPeak == Approx(0.25));
+  }
+  SECTION("Decay and hold") {
+    meter.setEnabled(true);
+    meter.setDecay(20);
+    meter.setHoldTime(std::chrono::milliseconds(15));
+    fake.processAudioBlock(blockLength);
+    fake.setHardwareOutputSamples({std::vector<ReaSample>(blockLength, 0)});
+    // 10 ms per block, so levels fall by 0.2 dB per block
+    const auto decayFactor = std::pow(10.0, -0.2 / 20);
+    fake.processAudioBlock(blockLength);
+    REQUIRE(meter.level(0).peak == Approx(0.5 * decayFactor));
+    REQUIRE(meter.level(0).rms == Approx(0.5 * decayFactor));
+    REQUIRE(meter.level(0).heldPeak == Approx(0.5));
+    fake.processAudioBlock(blockLength);
+    REQUIRE(meter.level(0).heldPeak == Approx(0.5));
+    // Hold time is over
+    fake.processAudioBlock(blockLength);
+    REQUIRE(meter.level(0).heldPeak == Approx(0.5 * std::pow(decayFactor, 3)));
+  }
+  SECTION("Reset") {
+    meter.setEnabled(true);
+    fake.processAudioBlock(blockLength);
+    fake.setHardwareOutputSamples({std::vector<ReaSample>(blockLength, 0.1)});
+    meter.reset();
+    fake.processAudioBlock(blockLength);
+    REQUIRE(meter.level(0).peak == Approx(0.1));
+    REQUIRE(meter.level(0).heldPeak == Approx(0.1));
+  }
+}
@@ -0,0 +1,521 @@
+#include <catch.hpp>
+#include "AllocationCounter.h"
+#include "FakeReaper.h"
+#include <reaplus/ControlSurfaceEventBus.h>
+#include <reaplus/Fx.h>
+#include <reaplus/FxChain.h>
+#include <reaplus/Parameter.h>
+#include <reaplus/ParameterRef.h>
+#include <reaplus/Project.h>
+#include <reaplus/Reaper.h>
+#include <reaplus/Track.h>
+#include <reaplus/TrackDataStore.h>
+#include <reaper_plugin_functions.h>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace reaplus;
+
+namespace {
+  // Unsubscribes on destruction, so that failing tests don't leave subscriptions behind
+  class Subscriptions {
+  public:
+    ~Subscriptions() {
+      subscription_.unsubscribe();
+    }
+
+    void add(const rxcpp::composite_subscription& subscription) {
+      subscription_.add(subscription);
+    }
+
+  private:
+    rxcpp::composite_subscription subscription_;
+  };
+
+  // Records the track set events of the helper control surface
+  class TrackSetEvents {
+  public:
+    std::vector<std::string> addedNames;
+    std::vector<std::string> removedGuids;
+    std::vector<TrackListReordering> reorderings;
+
+    TrackSetEvents() {
+      auto& reaper = Reaper::instance();
+      subscriptions_.add(reaper.trackAdded().subscribe([this](const Track& track) {
+        addedNames.push_back(track.name());
+      }));
+      subscriptions_.add(reaper.trackRemoved().subscribe([this](const Track& track) {
+        removedGuids.push_back(track.guid());
+      }));
+      subscriptions_.add(reaper.trackListReordered().subscribe([this](const TrackListReordering& reordering) {
+        reorderings.push_back(reordering);
+      }));
+    }
+
+    void clear() {
+      addedNames.clear();
+      removedGuids.clear();
+      reorderings.clear();
+    }
+
+  private:
+    Subscriptions subscriptions_;
+  };
+
+  bool containsMove(const TrackListReordering& reordering, int fromIndex, int toIndex) {
+    return std::any_of(reordering.moves.begin(), reordering.moves.end(), [fromIndex, toIndex](const TrackMove& move) {
+      return move.fromIndex == fromIndex && move.toIndex == toIndex;
+    });
+  }
+}
+
+TEST_CASE("Adds, removals and moves are reconciled in one pass") {
+  FakeReaper fake;
+  const auto project = fake.currentProject();
+  std::vector<MediaTrack*> tracks;
+  for (const auto name : {"A", "B", "C", "D", "E"}) {
+    tracks.push_back(fake.insertTrack(project, (int) tracks.size(), name));
+  }
+  TrackSetEvents events;
+  const auto removedGuid = Track(tracks[1], project).guid();
+  fake.batchTrackListChanges([&fake, &tracks, project] {
+    // A C D E
+    fake.removeTrack(tracks[1]);
+    // E A C D
+    fake.moveTrack(tracks[4], 0);
+    // E A F C D
+    fake.insertTrack(project, 2, "F");
+  });
+  REQUIRE(events.addedNames == std::vector<std::string>{"F"});
+  REQUIRE(events.removedGuids == std::vector<std::string>{removedGuid});
+  REQUIRE(events.reorderings.size() == 1);
+  const auto& reordering = events.reorderings[0];
+  REQUIRE(containsMove(reordering, 4, 0));
+  // Neither the added nor the removed track count as moved
+  for (const auto& move : reordering.moves) {
+    REQUIRE(move.toIndex != 2);
+    REQUIRE(move.fromIndex != 1);
+  }
+  SECTION("Store follows the new order") {
+    events.clear();
+    // E F C D A
+    fake.moveTrack(tracks[0], 4);
+    REQUIRE(events.addedNames.empty());
+    REQUIRE(events.removedGuids.empty());
+    REQUIRE(events.reorderings.size() == 1);
+    REQUIRE(containsMove(events.reorderings[0], 1, 4));
+  }
+}
+
+TEST_CASE("Track set of a large project is reconciled") {
+  FakeReaper fake;
+  const auto project = fake.currentProject();
+  TrackSetEvents events;
+  std::vector<MediaTrack*> tracks;
+  fake.batchTrackListChanges([&fake, &tracks, project] {
+    for (int i = 0; i < 5000; i++) {
+      tracks.push_back(fake.insertTrack(project, i, std::to_string(i)));
+    }
+  });
+  REQUIRE(events.addedNames.size() == 5000);
+  REQUIRE(events.addedNames[4999] == "4999");
+  REQUIRE(events.reorderings.empty());
+  events.clear();
+  fake.batchTrackListChanges([&fake, &tracks, project] {
+    // Every 50th track goes, the last one moves to the top and 10 tracks are appended
+    for (int i = 0; i < 5000; i += 50) {
+      fake.removeTrack(tracks[i]);
+    }
+    fake.moveTrack(tracks[4999], 0);
+    for (int i = 0; i < 10; i++) {
+      fake.insertTrack(project, 4900, "new");
+    }
+  });
+  REQUIRE(events.removedGuids.size() == 100);
+  REQUIRE(events.addedNames == std::vector<std::string>(10, "new"));
+  REQUIRE(events.reorderings.size() == 1);
+  REQUIRE(containsMove(events.reorderings[0], 4999, 0));
+  REQUIRE(Project(project).trackCount() == 4910);
+  events.clear();
+  // The survivors keep their order, so a further add mustn't be mistaken for moves
+  fake.insertTrack(project, 4910, "last");
+  REQUIRE(events.removedGuids.empty());
+  REQUIRE(events.addedNames == std::vector<std::string>{"last"});
+  REQUIRE(events.reorderings.empty());
+}
+
+TEST_CASE("Track list changes made by listeners are reconciled afterwards") {
+  FakeReaper fake;
+  const auto project = fake.currentProject();
+  std::vector<MediaTrack*> tracks;
+  for (const auto name : {"A", "B", "C"}) {
+    tracks.push_back(fake.insertTrack(project, (int) tracks.size(), name));
+  }
+  TrackSetEvents events;
+  auto& reaper = Reaper::instance();
+  Subscriptions subscriptions;
+  // Removing B also removes C, adding D also adds E at the top
+  subscriptions.add(reaper.trackRemoved().subscribe([&fake, &tracks](const Track&) {
+    if (tracks.size() == 3) {
+      const auto c = tracks.back();
+      tracks.pop_back();
+      fake.removeTrack(c);
+    }
+  }));
+  subscriptions.add(reaper.trackAdded().subscribe([&fake, project](const Track& track) {
+    if (track.name() == "D") {
+      fake.insertTrack(project, 0, "E");
+    }
+  }));
+  const auto removedGuids = std::vector<std::string>{Track(tracks[1], project).guid(), Track(tracks[2], project).guid()};
+  fake.batchTrackListChanges([&fake, &tracks, project] {
+    fake.removeTrack(tracks[1]);
+    fake.insertTrack(project, 2, "D");
+  });
+  REQUIRE(events.removedGuids == removedGuids);
+  REQUIRE(events.addedNames == std::vector<std::string>{"D", "E"});
+  REQUIRE(events.reorderings.empty());
+  // E A D
+  REQUIRE(Project(project).trackCount() == 3);
+  events.clear();
+  // The store is consistent, so this is just a move: E D A
+  fake.moveTrack(tracks[0], 2);
+  REQUIRE(events.addedNames.empty());
+  REQUIRE(events.removedGuids.empty());
+  REQUIRE(events.reorderings.size() == 1);
+  REQUIRE(containsMove(events.reorderings[0], 1, 2));
+}
+
+TEST_CASE("Background projects are reconciled in chunks within the Run() budget") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  int addedCount = 0;
+  const auto subscription = reaper.trackAdded().subscribe([&addedCount](const Track&) {
+    addedCount++;
+  });
+  const auto backgroundProject = fake.currentProject();
+  fake.addProject();
+  for (int i = 0; i < 5000; i++) {
+    fake.insertTrack(backgroundProject, i);
+  }
+  REQUIRE(addedCount == 0);
+  int runCount = 0;
+  while (addedCount < 5000 && runCount < 10000) {
+    fake.runControlSurfaces();
+    runCount++;
+  }
+  REQUIRE(addedCount == 5000);
+  // Reading 5000 added tracks takes far longer than the 2 ms budget
+  REQUIRE(runCount > 1);
+  fake.runControlSurfaces();
+  REQUIRE(addedCount == 5000);
+  subscription.unsubscribe();
+}
+
+TEST_CASE("Track callbacks are served from the track data store") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  Subscriptions subscriptions;
+  std::vector<MediaTrack*> volumeChanges;
+  int volumeTouchCount = 0;
+  int panTouchCount = 0;
+  subscriptions.add(reaper.trackVolumeChanged().subscribe([&volumeChanges](const Track& track) {
+    volumeChanges.push_back(track.mediaTrack());
+  }));
+  subscriptions.add(reaper.trackVolumeTouched().subscribe([&volumeTouchCount](const Track&) {
+    volumeTouchCount++;
+  }));
+  subscriptions.add(reaper.trackPanTouched().subscribe([&panTouchCount](const Track&) {
+    panTouchCount++;
+  }));
+  const auto project = fake.currentProject();
+  const auto first = fake.insertTrack(project, 0, "First");
+  const auto second = fake.insertTrack(project, 1, "Second");
+  reaper::CSurf_OnVolumeChangeEx(second, 0.5, false, false);
+  reaper::CSurf_OnVolumeChangeEx(first, 0.25, false, false);
+  REQUIRE(volumeChanges == std::vector<MediaTrack*>{second, first});
+  REQUIRE(volumeTouchCount == 2);
+  SECTION("Unchanged values are not reported") {
+    reaper::CSurf_OnVolumeChangeEx(first, 0.25, false, false);
+    REQUIRE(volumeChanges.size() == 2);
+    REQUIRE(volumeTouchCount == 2);
+  }
+  SECTION("Slots follow their tracks when others are removed") {
+    fake.removeTrack(first);
+    reaper::CSurf_OnVolumeChangeEx(second, 0.5, false, false);
+    REQUIRE(volumeChanges.size() == 2);
+    reaper::CSurf_OnVolumeChangeEx(second, 0.75, false, false);
+    REQUIRE(volumeChanges.size() == 3);
+  }
+  SECTION("Automated parameters are not touched") {
+    fake.addTrackEnvelope(first, "Volume");
+    fake.setTrackAutomationMode(first, (int) AutomationMode::Read);
+    reaper::CSurf_OnVolumeChangeEx(first, 0.3, false, false);
+    REQUIRE(volumeChanges.size() == 3);
+    REQUIRE(volumeTouchCount == 2);
+    // The automation state stays cached until the next automation mode change
+    fake.addTrackEnvelope(first, "Pan");
+    reaper::CSurf_OnPanChangeEx(first, 0.1, false, false);
+    REQUIRE(panTouchCount == 1);
+    fake.setGlobalAutomationOverride((int) AutomationMode::Bypass);
+    reaper::CSurf_OnPanChangeEx(first, 0.2, false, false);
+    reaper::CSurf_OnVolumeChangeEx(first, 0.4, false, false);
+    REQUIRE(panTouchCount == 2);
+    REQUIRE(volumeTouchCount == 3);
+  }
+}
+
+TEST_CASE("Change events go through the event bus and can be coalesced per Run()") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  Subscriptions subscriptions;
+  std::vector<double> coalescedVolumes;
+  subscriptions.add(reaper.trackVolumeChangedCoalesced().subscribe(
+      [&coalescedVolumes](const ValueChange<Track>& change) {
+        coalescedVolumes.push_back(change.value);
+      }
+  ));
+  auto& bus = reaper.controlSurfaceEventBus();
+  std::vector<double> volumes;
+  const auto listenerId = bus.addListener(
+      eventMask(ControlSurfaceEventKind::TrackVolumeChanged),
+      [&volumes](const ControlSurfaceEvent& event) {
+        volumes.push_back(event.value);
+      }
+  );
+  const auto project = fake.currentProject();
+  const auto first = fake.insertTrack(project, 0);
+  const auto second = fake.insertTrack(project, 1);
+  reaper::CSurf_OnVolumeChangeEx(first, 0.1, false, false);
+  reaper::CSurf_OnVolumeChangeEx(second, 0.2, false, false);
+  reaper::CSurf_OnVolumeChangeEx(first, 0.3, false, false);
+  REQUIRE(volumes == std::vector<double>{0.1, 0.2, 0.3});
+  REQUIRE(coalescedVolumes.empty());
+  fake.runControlSurfaces();
+  // Latest value per track, in order of the first change
+  REQUIRE(coalescedVolumes == std::vector<double>{0.3, 0.2});
+  fake.runControlSurfaces();
+  REQUIRE(coalescedVolumes.size() == 2);
+  bus.removeListener(listenerId);
+  reaper::CSurf_OnVolumeChangeEx(first, 0.4, false, false);
+  REQUIRE(volumes.size() == 3);
+}
+
+TEST_CASE("FX chain changes are detected by GUID") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  Subscriptions subscriptions;
+  std::vector<std::string> addedNames;
+  std::vector<std::string> removedGuids;
+  std::vector<FxChainReordering> reorderings;
+  subscriptions.add(reaper.fxAdded().subscribe([&addedNames](const Fx& fx) {
+    addedNames.push_back(fx.name());
+  }));
+  subscriptions.add(reaper.fxRemoved().subscribe([&removedGuids](const Fx& fx) {
+    removedGuids.push_back(fx.guid());
+  }));
+  subscriptions.add(reaper.fxChainReordered().subscribe([&reorderings](const FxChainReordering& reordering) {
+    reorderings.push_back(reordering);
+  }));
+  const auto project = fake.currentProject();
+  const Track track(fake.insertTrack(project, 0), project);
+  for (const auto name : {"ReaEQ", "ReaComp", "ReaDelay"}) {
+    fake.addFx(track.mediaTrack(), name, 4);
+  }
+  REQUIRE(addedNames == std::vector<std::string>{"ReaEQ", "ReaComp", "ReaDelay"});
+  REQUIRE(reorderings.empty());
+  const auto eqGuid = track.normalFxChain().fxByIndex(0)->guid();
+  SECTION("Moves") {
+    // ReaDelay ReaEQ ReaComp
+    fake.moveFx(track.mediaTrack(), 2, 0);
+    REQUIRE(addedNames.size() == 3);
+    REQUIRE(removedGuids.empty());
+    REQUIRE(reorderings.size() == 1);
+    const auto& moves = reorderings[0].moves;
+    REQUIRE(std::any_of(moves.begin(), moves.end(), [](const FxMove& move) {
+      return move.fromIndex == 2 && move.toIndex == 0;
+    }));
+  }
+  SECTION("Removing shifts the others without moving them") {
+    fake.removeFx(track.mediaTrack(), 0);
+    REQUIRE(removedGuids == std::vector<std::string>{eqGuid});
+    REQUIRE(reorderings.empty());
+  }
+}
+
+TEST_CASE("FX parameter values are shadowed") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  Subscriptions subscriptions;
+  int changeCount = 0;
+  int unsafeChangeCount = 0;
+  subscriptions.add(reaper.parameterValueChanged().subscribe([&changeCount](const ParameterRef&) {
+    changeCount++;
+  }));
+  subscriptions.add(reaper.parameterValueChangedUnsafe().subscribe([&unsafeChangeCount](Parameter* parameter) {
+    std::unique_ptr<Parameter> owned(parameter);
+    unsafeChangeCount++;
+  }));
+  const auto project = fake.currentProject();
+  const auto mediaTrack = fake.insertTrack(project, 0);
+  fake.addFx(mediaTrack, "ReaEQ", 4);
+  fake.addFx(mediaTrack, "ReaComp", 4);
+  const auto& table = reaper.fxParameterShadowTable();
+  REQUIRE(table.sequence() == 0);
+  reaper::TrackFX_SetParamNormalized(mediaTrack, 0, 1, 0.5);
+  const auto sequence = table.sequence();
+  REQUIRE(sequence > 0);
+  REQUIRE(table.find(mediaTrack, false, 0, 1)->value == 0.5);
+  REQUIRE(changeCount == 1);
+  REQUIRE(unsafeChangeCount == 1);
+  SECTION("Unchanged values") {
+    reaper::TrackFX_SetParamNormalized(mediaTrack, 0, 1, 0.5);
+    REQUIRE(table.sequence() == sequence);
+    REQUIRE(changeCount == 1);
+    // Like before the shadow table existed
+    REQUIRE(unsafeChangeCount == 2);
+  }
+  SECTION("Delta query") {
+    reaper::TrackFX_SetParamNormalized(mediaTrack, 1, 2, 0.7);
+    reaper::TrackFX_SetParamNormalized(mediaTrack, 1, 3, 0.8);
+    std::vector<double> values;
+    table.forEachChangedSince(sequence, [&values](const FxParameterShadowTable::Entry& entry) {
+      values.push_back(entry.value);
+    });
+    REQUIRE(values == std::vector<double>{0.8, 0.7});
+  }
+  SECTION("Values are dropped when FX indexes change") {
+    fake.moveFx(mediaTrack, 1, 0);
+    REQUIRE(table.find(mediaTrack, false, 0, 1) == nullptr);
+    reaper::TrackFX_SetParamNormalized(mediaTrack, 1, 1, 0.5);
+    REQUIRE(changeCount == 2);
+  }
+}
+
+TEST_CASE("FX parameter changes are attributed to recently changed parameters before REAPER 5.95") {
+  FakeReaper fake;
+  // Input FX parameter changes are reported like normal ones
+  fake.setAppVersion("5.94/x64");
+  auto& reaper = Reaper::instance();
+  reaper.init();
+  const auto mediaTrack = fake.insertTrack(fake.currentProject(), 0);
+  fake.addFx(mediaTrack, "ReaEQ", 4);
+  fake.addFx(mediaTrack, "ReaComp", 4, true);
+  const auto& table = reaper.fxParameterShadowTable();
+  reaper::TrackFX_SetParamNormalized(mediaTrack, 0x1000000, 1, 0.3);
+  REQUIRE(table.find(mediaTrack, true, 0, 1)->value == 0.3);
+  // Same value as the untouched normal FX parameter, so asking REAPER would attribute it to the normal FX
+  reaper::TrackFX_SetParamNormalized(mediaTrack, 0x1000000, 1, 0);
+  REQUIRE(table.find(mediaTrack, true, 0, 1)->value == 0);
+  REQUIRE(table.find(mediaTrack, false, 0, 1) == nullptr);
+  SECTION("Parameters which haven't changed recently don't count") {
+    for (int i = 1; i <= 100; i++) {
+      reaper::TrackFX_SetParamNormalized(mediaTrack, 0x1000000, 3, i / 100.0);
+    }
+    reaper::TrackFX_SetParamNormalized(mediaTrack, 0, 1, 0.5);
+    REQUIRE(table.find(mediaTrack, false, 0, 1)->value == 0.5);
+    REQUIRE(table.find(mediaTrack, true, 0, 1)->value == 0);
+  }
+}
+
+TEST_CASE("Event bus at 10k events per second", "[.][benchmark]") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  // Creates the helper control surface before the tracks exist, so it doesn't wait for their titles
+  auto& bus = reaper.controlSurfaceEventBus();
+  const auto project = fake.currentProject();
+  std::vector<MediaTrack*> tracks;
+  for (int i = 0; i < 100; i++) {
+    tracks.push_back(fake.insertTrack(project, i));
+  }
+  // One second worth of volume changes, spread over the tracks
+  const int eventCount = 10000;
+  int round = 0;
+  const auto reportVolumeChanges = [&tracks, &round] {
+    round++;
+    for (int i = 0; i < eventCount; i++) {
+      reaper::CSurf_SetSurfaceVolume(tracks[i % tracks.size()], round + i * 1e-6, nullptr);
+    }
+  };
+  const auto reportAllocationsPerEvent = [&reportVolumeChanges](const char* listener) {
+    // Warm up
+    reportVolumeChanges();
+    const auto allocations = allocationsDuring(reportVolumeChanges);
+    WARN(listener << ": " << (double) allocations / eventCount << " allocations per event");
+  };
+  int deliveredCount = 0;
+  const auto listenerId = bus.addListener(
+      eventMask(ControlSurfaceEventKind::TrackVolumeChanged),
+      [&deliveredCount](const ControlSurfaceEvent&) {
+        deliveredCount++;
+      }
+  );
+  reportAllocationsPerEvent("Event bus listener");
+  BENCHMARK("10k events to an event bus listener") {
+    reportVolumeChanges();
+    return deliveredCount;
+  };
+  bus.removeListener(listenerId);
+  Subscriptions subscriptions;
+  subscriptions.add(reaper.trackVolumeChanged().subscribe([&deliveredCount](const Track&) {
+    deliveredCount++;
+  }));
+  reportAllocationsPerEvent("Observable subscriber");
+  BENCHMARK("10k events to an observable subscriber") {
+    reportVolumeChanges();
+    return deliveredCount;
+  };
+  subscriptions.add(reaper.trackVolumeChangedCoalesced().subscribe([&deliveredCount](const ValueChange<Track>&) {
+    deliveredCount++;
+  }));
+  reportAllocationsPerEvent("Observable and coalesced subscriber");
+  BENCHMARK("10k events to an observable and coalesced subscriber, flushed once") {
+    reportVolumeChanges();
+    fake.runControlSurfaces();
+    return deliveredCount;
+  };
+}
+
+TEST_CASE("Track callbacks in a large project", "[.][benchmark]") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  Subscriptions subscriptions;
+  int changeCount = 0;
+  subscriptions.add(reaper.trackVolumeChanged().subscribe([&changeCount](const Track&) {
+    changeCount++;
+  }));
+  const auto project = fake.currentProject();
+  std::vector<MediaTrack*> tracks;
+  fake.batchTrackListChanges([&fake, &tracks, project] {
+    for (int i = 0; i < 5000; i++) {
+      tracks.push_back(fake.insertTrack(project, i));
+    }
+  });
+  std::size_t next = 0;
+  double volume = 0;
+  BENCHMARK("Volume change") {
+    next = (next + 1) % tracks.size();
+    volume += 1e-6;
+    reaper::CSurf_SetSurfaceVolume(tracks[next], volume, nullptr);
+    return changeCount;
+  };
+  BENCHMARK("Unchanged volume") {
+    reaper::CSurf_SetSurfaceVolume(tracks[next], volume, nullptr);
+    return changeCount;
+  };
+  // Baseline: The lookup each callback used to do before comparing, i.e. querying the current project and then the
+  // track data map of that project
+  std::unordered_map<ReaProject*, std::unordered_map<MediaTrack*, TrackData>> trackDataByMediaTrackByReaProject;
+  for (const auto track : tracks) {
+    trackDataByMediaTrackByReaProject[project][track] = TrackData{};
+  }
+  BENCHMARK("Track data lookup via current project and unordered_map") {
+    next = (next + 1) % tracks.size();
+    const auto mediaTrack = tracks[next];
+    auto& trackDatas = trackDataByMediaTrackByReaProject[reaper.currentProject().reaProject()];
+    return trackDatas.count(mediaTrack) == 0 ? nullptr : &trackDatas.at(mediaTrack);
+  };
+}
@@ -0,0 +1,94 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/HighResolutionMidiAssembler.h>
+#include <reaplus/IncomingHighResolutionMidiEvent.h>
+#include <reaplus/IncomingMidiEvent.h>
+#include <reaplus/Reaper.h>
+#include <vector>
+
+using namespace reaplus;
+
+namespace {
+  CapturedMidiEvent controlChange(int deviceId, int channel, int controller, int value) {
+    return CapturedMidiEvent{deviceId, 0, static_cast<unsigned char>(0xb0 | channel),
+        static_cast<unsigned char>(controller), static_cast<unsigned char>(value), CapturedMidiEventKind::Raw, 0, 0,
+        0, 0, 0};
+  }
+}
+
+TEST_CASE("High-resolution MIDI assembler combines 14-bit control changes") {
+  HighResolutionMidiAssembler assembler;
+  CapturedMidiEvent assembled{};
+  // LSB without MSB
+  REQUIRE(!assembler.process(controlChange(0, 0, 39, 5), assembled));
+  REQUIRE(!assembler.process(controlChange(0, 0, 7, 100), assembled));
+  REQUIRE(assembler.process(controlChange(0, 0, 39, 5), assembled));
+  REQUIRE(assembled.kind == CapturedMidiEventKind::ControlChange14Bit);
+  REQUIRE(assembled.number == 7);
+  REQUIRE(assembled.value == (100 << 7 | 5));
+  // State is per device and channel
+  REQUIRE(!assembler.process(controlChange(0, 1, 39, 5), assembled));
+  REQUIRE(!assembler.process(controlChange(1, 0, 39, 5), assembled));
+  // Not a control change
+  REQUIRE(!assembler.process(CapturedMidiEvent{0, 0, 0x90, 39, 5, CapturedMidiEventKind::Raw, 0, 0, 0, 0, 0},
+      assembled));
+}
+
+TEST_CASE("High-resolution MIDI assembler combines NRPN and RPN data entry") {
+  HighResolutionMidiAssembler assembler;
+  CapturedMidiEvent assembled{};
+  REQUIRE(!assembler.process(controlChange(0, 2, 99, 1), assembled));
+  REQUIRE(!assembler.process(controlChange(0, 2, 98, 3), assembled));
+  REQUIRE(assembler.process(controlChange(0, 2, 6, 64), assembled));
+  REQUIRE(assembled.kind == CapturedMidiEventKind::Nrpn7Bit);
+  REQUIRE(assembled.number == (1 << 7 | 3));
+  REQUIRE(assembled.value == 64);
+  REQUIRE(assembler.process(controlChange(0, 2, 38, 1), assembled));
+  REQUIRE(assembled.kind == CapturedMidiEventKind::Nrpn14Bit);
+  REQUIRE(assembled.value == (64 << 7 | 1));
+  // Switching to RPN forgets the NRPN number
+  REQUIRE(!assembler.process(controlChange(0, 2, 101, 0), assembled));
+  REQUIRE(!assembler.process(controlChange(0, 2, 6, 1), assembled));
+  REQUIRE(!assembler.process(controlChange(0, 2, 100, 0), assembled));
+  REQUIRE(assembler.process(controlChange(0, 2, 6, 2), assembled));
+  REQUIRE(assembled.kind == CapturedMidiEventKind::Rpn7Bit);
+  REQUIRE(assembled.number == 0);
+  // RPN null deselects, so data entry is a normal control change again
+  REQUIRE(!assembler.process(controlChange(0, 2, 101, 127), assembled));
+  REQUIRE(!assembler.process(controlChange(0, 2, 100, 127), assembled));
+  REQUIRE(!assembler.process(controlChange(0, 2, 6, 3), assembled));
+  REQUIRE(assembler.process(controlChange(0, 2, 38, 4), assembled));
+  REQUIRE(assembled.kind == CapturedMidiEventKind::ControlChange14Bit);
+  REQUIRE(assembled.number == 6);
+}
+
+TEST_CASE("High-resolution MIDI events are emitted next to raw events") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Fader box");
+  auto& reaper = Reaper::instance();
+  // Captured MIDI is delivered in the helper control surface's Run()
+  reaper.init();
+  std::vector<IncomingHighResolutionMidiEvent> highResolutionEvents;
+  int rawEventCount = 0;
+  const auto highResolutionSubscription = reaper.incomingHighResolutionMidiEvents().subscribe(
+      [&highResolutionEvents](const IncomingHighResolutionMidiEvent& event) {
+        highResolutionEvents.push_back(event);
+      });
+  const auto rawSubscription = reaper.incomingMidiEvents().subscribe([&rawEventCount](const IncomingMidiEvent&) {
+    rawEventCount++;
+  });
+  fake.queueMidiInputEvent(0, {0xb3, 1, 64});
+  fake.queueMidiInputEvent(0, {0xb3, 33, 10});
+  fake.processAudioBlock(512);
+  fake.runControlSurfaces();
+  REQUIRE(rawEventCount == 2);
+  REQUIRE(highResolutionEvents.size() == 1);
+  const auto& event = highResolutionEvents[0];
+  REQUIRE(event.kind() == HighResolutionMidiEventKind::ControlChange14Bit);
+  REQUIRE(event.channel() == 3);
+  REQUIRE(event.number() == 1);
+  REQUIRE(event.value() == (64 << 7 | 10));
+  REQUIRE(event.is14Bit());
+  highResolutionSubscription.unsubscribe();
+  rawSubscription.unsubscribe();
+}
@@ -0,0 +1,70 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Reaper.h>
+#include <reaplus/IncomingMidiEventBlock.h>
+#include <vector>
+
+using namespace reaplus;
+
+TEST_CASE("Incoming MIDI events are emitted block by block") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Keyboard");
+  fake.addMidiInputDevice(1, "Controller");
+  auto& reaper = Reaper::instance();
+  // Captured MIDI is delivered in the helper control surface's Run()
+  reaper.init();
+  std::vector<std::uint64_t> blockIndexes;
+  std::vector<std::vector<int>> frameOffsetsPerBlock;
+  int singleEventCount = 0;
+  const auto blockSubscription = reaper.incomingMidiEventBlocks().subscribe(
+      [&blockIndexes, &frameOffsetsPerBlock](const IncomingMidiEventBlock& block) {
+        blockIndexes.push_back(block.blockIndex());
+        std::vector<int> frameOffsets;
+        for (const auto& event : block) {
+          frameOffsets.push_back(event.getFrameOffset());
+        }
+        frameOffsetsPerBlock.push_back(frameOffsets);
+      });
+  const auto eventSubscription = reaper.incomingMidiEvents().subscribe([&singleEventCount](const IncomingMidiEvent&) {
+    singleEventCount++;
+  });
+  fake.queueMidiInputEvent(0, {0x90, 60, 100}, 10);
+  fake.queueMidiInputEvent(1, {0xb0, 1, 64}, 20);
+  fake.processAudioBlock(512);
+  // Block without events
+  fake.processAudioBlock(512);
+  fake.queueMidiInputEvent(1, {0xb0, 1, 65}, 30);
+  fake.processAudioBlock(512);
+  fake.runControlSurfaces();
+  REQUIRE(blockIndexes.size() == 2);
+  REQUIRE(blockIndexes[1] == blockIndexes[0] + 2);
+  REQUIRE(frameOffsetsPerBlock == std::vector<std::vector<int>>{{10, 20}, {30}});
+  // Per-event observable still works alongside
+  REQUIRE(singleEventCount == 3);
+  blockSubscription.unsubscribe();
+  eventSubscription.unsubscribe();
+}
+
+TEST_CASE("Incoming MIDI events carry absolute sample positions") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Keyboard");
+  auto& reaper = Reaper::instance();
+  // Captured MIDI is delivered in the helper control surface's Run()
+  reaper.init();
+  std::vector<IncomingMidiEvent> events;
+  const auto subscription = reaper.incomingMidiEvents().subscribe([&events](const IncomingMidiEvent& event) {
+    events.push_back(event);
+  });
+  const auto blockStart = reaper.sampleCounter();
+  fake.processAudioBlock(512, 48000);
+  // 1/1024000 s units, so 10 ms
+  fake.queueMidiInputEvent(0, {0x90, 60, 100}, 10240);
+  fake.processAudioBlock(512, 48000);
+  fake.runControlSurfaces();
+  REQUIRE(events.size() == 1);
+  REQUIRE(events[0].getFrameOffset() == 10240);
+  REQUIRE(events[0].samplePosition() == blockStart + 512 + 480);
+  REQUIRE(events[0].sampleRate() == 48000);
+  REQUIRE(events[0].timeInSeconds() == Approx((blockStart + 992) / 48000.0));
+  subscription.unsubscribe();
+}
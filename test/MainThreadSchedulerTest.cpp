@@ -0,0 +1,146 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/MainThreadScheduler.h>
+#include <reaplus/Reaper.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace reaplus;
+using Clock = std::chrono::steady_clock;
+
+TEST_CASE("Main thread scheduler executes higher priority classes first") {
+  MainThreadScheduler scheduler;
+  std::string executed;
+  scheduler.schedule(MainThreadPriority::Background, [&executed] {
+    executed += "b";
+  });
+  scheduler.schedule(MainThreadPriority::UserAction, [&executed] {
+    executed += "u";
+  });
+  scheduler.schedule(MainThreadPriority::Feedback, [&executed] {
+    executed += "f";
+  });
+  scheduler.beginRun();
+  REQUIRE(scheduler.pendingCount(MainThreadPriority::Feedback) == 1);
+  scheduler.runPending(MainThreadPriority::Feedback);
+  scheduler.runPending(MainThreadPriority::UserAction);
+  scheduler.runPending(MainThreadPriority::Background);
+  REQUIRE(executed == "fub");
+  REQUIRE(scheduler.executedCount(MainThreadPriority::Background) == 1);
+}
+
+TEST_CASE("Main thread scheduler defers work when the budget is used up") {
+  MainThreadScheduler scheduler;
+  bool secondExecuted = false;
+  scheduler.schedule(MainThreadPriority::UserAction, [&scheduler] {
+    std::this_thread::sleep_for(scheduler.budget());
+  });
+  scheduler.schedule(MainThreadPriority::UserAction, [&secondExecuted] {
+    secondExecuted = true;
+  });
+  scheduler.beginRun();
+  scheduler.runPending(MainThreadPriority::UserAction);
+  REQUIRE(!secondExecuted);
+  REQUIRE(scheduler.pendingCount(MainThreadPriority::UserAction) == 1);
+  SECTION("Executed in the next run") {
+    scheduler.beginRun();
+    scheduler.runPending(MainThreadPriority::UserAction);
+    REQUIRE(secondExecuted);
+  }
+  SECTION("Executed anyway when the deadline has passed") {
+    scheduler.setDeadline(MainThreadPriority::UserAction, std::chrono::microseconds(0));
+    scheduler.runPending(MainThreadPriority::UserAction);
+    REQUIRE(secondExecuted);
+  }
+}
+
+TEST_CASE("Main thread scheduler keeps background work within the feedback latency target") {
+  MainThreadScheduler scheduler;
+  bool executed = false;
+  scheduler.setDeadline(MainThreadPriority::Background, std::chrono::microseconds(0));
+  scheduler.setFeedbackLatencyTarget(std::chrono::microseconds(0));
+  scheduler.schedule(MainThreadPriority::Background, [&executed] {
+    executed = true;
+  });
+  scheduler.beginRun();
+  scheduler.runPending(MainThreadPriority::Background);
+  REQUIRE(!executed);
+  scheduler.setFeedbackLatencyTarget(MainThreadScheduler::DEFAULT_FEEDBACK_LATENCY_TARGET);
+  scheduler.beginRun();
+  scheduler.runPending(MainThreadPriority::Background);
+  REQUIRE(executed);
+}
+
+TEST_CASE("Main thread scheduler leaves room for the next run interval and the work before feedback") {
+  MainThreadScheduler scheduler;
+  std::vector<Clock::duration> elapsedAtTaskStarts;
+  scheduler.setWorkBeforeFeedback(std::chrono::milliseconds(10));
+  Clock::time_point runStart;
+  for (int i = 0; i < 20; i++) {
+    scheduler.schedule(MainThreadPriority::Background, [&elapsedAtTaskStarts, &runStart] {
+      elapsedAtTaskStarts.push_back(Clock::now() - runStart);
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+  }
+  runStart = Clock::now();
+  scheduler.beginRun();
+  // So 10 ms are left for background work
+  scheduler.setFeedbackLatencyTarget(scheduler.runInterval() + std::chrono::milliseconds(20));
+  scheduler.runPending(MainThreadPriority::Background);
+  REQUIRE(!elapsedAtTaskStarts.empty());
+  REQUIRE(scheduler.pendingCount(MainThreadPriority::Background) > 0);
+  // No task started after the allowance (plus a little measurement slack)
+  REQUIRE(elapsedAtTaskStarts.back() < std::chrono::milliseconds(11));
+  SECTION("Nothing if the run interval alone exceeds the target") {
+    scheduler.setDeadline(MainThreadPriority::Background, std::chrono::microseconds(0));
+    const auto executedCount = elapsedAtTaskStarts.size();
+    scheduler.beginRun();
+    scheduler.setFeedbackLatencyTarget(scheduler.runInterval());
+    scheduler.runPending(MainThreadPriority::Background);
+    REQUIRE(elapsedAtTaskStarts.size() == executedCount);
+  }
+}
+
+TEST_CASE("Main thread scheduler caps overdue work per run") {
+  MainThreadScheduler scheduler;
+  int executedCount = 0;
+  scheduler.setDeadline(MainThreadPriority::UserAction, std::chrono::microseconds(0));
+  for (int i = 0; i < 100; i++) {
+    scheduler.schedule(MainThreadPriority::UserAction, [&executedCount] {
+      executedCount++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+  }
+  const auto start = Clock::now();
+  scheduler.beginRun();
+  scheduler.runPending(MainThreadPriority::UserAction);
+  const auto elapsed = Clock::now() - start;
+  REQUIRE(executedCount < 100);
+  REQUIRE(scheduler.pendingCount(MainThreadPriority::UserAction) == 100 - executedCount);
+  // At most one task beyond the cap
+  REQUIRE(elapsed < MainThreadScheduler::MAX_BUDGET + std::chrono::milliseconds(10));
+}
+
+TEST_CASE("Main thread scheduler adapts the budget to the run interval") {
+  MainThreadScheduler scheduler;
+  for (int i = 0; i < 50; i++) {
+    scheduler.beginRun();
+  }
+  // Back-to-back runs
+  REQUIRE(scheduler.budget() == MainThreadScheduler::MIN_BUDGET);
+}
+
+TEST_CASE("Prioritized main thread tasks are executed by the helper control surface") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  std::string executed;
+  reaper.executeLaterInMainThread(MainThreadPriority::Background, [&executed] {
+    executed += "b";
+  });
+  reaper.executeLaterInMainThread(MainThreadPriority::Feedback, [&executed] {
+    executed += "f";
+  });
+  fake.runControlSurfaces();
+  REQUIRE(executed == "fb");
+}
@@ -0,0 +1,74 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/MainThreadTaskQueue.h>
+#include <reaplus/Reaper.h>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace reaplus;
+
+TEST_CASE("Main thread task queue drains batches until the budget is used up") {
+  MainThreadTaskQueue queue;
+  std::vector<int> executed;
+  const int taskCount = (int) MainThreadTaskQueue::BATCH_SIZE + 5;
+  for (int i = 0; i < taskCount; i++) {
+    queue.push([&executed, i] {
+      executed.push_back(i);
+    });
+  }
+  REQUIRE(queue.size() == (std::size_t) taskCount);
+  // Zero budget still executes one batch
+  REQUIRE(queue.runFor(std::chrono::microseconds(0)) == MainThreadTaskQueue::BATCH_SIZE);
+  REQUIRE(queue.deferredCount() == 5);
+  REQUIRE(queue.runFor(std::chrono::seconds(1)) == 5);
+  REQUIRE(executed.size() == (std::size_t) taskCount);
+  REQUIRE(executed.back() == taskCount - 1);
+  REQUIRE(queue.executedCount() == (std::uint64_t) taskCount);
+  REQUIRE(queue.size() == 0);
+}
+
+TEST_CASE("Main thread task queue stores bigger captures inline and measures latency") {
+  MainThreadTaskQueue queue;
+  std::string result;
+  std::string guid = "{5FB3EF4A-61C6-4E0E-9B2B-5A6C2B8E39F7}";
+  const std::array<double, 4> values{1, 2, 3, 4};
+  queue.push([&result, guid, values] {
+    result = guid + std::to_string(values[3]);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  queue.runFor(std::chrono::seconds(1));
+  REQUIRE(result == guid + std::to_string(4.0));
+  REQUIRE(queue.maxLatency() >= std::chrono::milliseconds(5));
+  REQUIRE(queue.averageLatency() == queue.maxLatency());
+}
+
+TEST_CASE("Main thread task queue keeps going if a task throws") {
+  MainThreadTaskQueue queue;
+  bool secondExecuted = false;
+  queue.push([] {
+    throw std::runtime_error("expected");
+  });
+  queue.push([&secondExecuted] {
+    secondExecuted = true;
+  });
+  REQUIRE(queue.runFor(std::chrono::seconds(1)) == 2);
+  REQUIRE(secondExecuted);
+}
+
+TEST_CASE("Fast main thread commands are executed in the next run cycle") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  bool executed = false;
+  std::thread([&reaper, &executed] {
+    reaper.executeLaterInMainThreadFast([&executed] {
+      executed = true;
+    });
+  }).join();
+  REQUIRE(!executed);
+  fake.runControlSurfaces();
+  REQUIRE(executed);
+  REQUIRE(reaper.mainThreadTaskQueue().executedCount() == 1);
+}
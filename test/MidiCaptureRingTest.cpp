@@ -0,0 +1,90 @@
+#include <catch.hpp>
+#include "AllocationCounter.h"
+#include "FakeReaper.h"
+#include <reaplus/MidiCaptureRing.h>
+#include <reaplus/Reaper.h>
+#include <reaplus/IncomingMidiEvent.h>
+#include <reaplus/IncomingSysExEvent.h>
+#include <vector>
+
+using namespace reaplus;
+
+TEST_CASE("MIDI capture ring counts overflows and keeps a high-water mark") {
+  MidiCaptureRing ring(3);
+  REQUIRE(ring.capacity() == 4);
+  const auto allocations = allocationsDuring([&ring] {
+    for (int i = 0; i < 6; i++) {
+      ring.push(CapturedMidiEvent{0, i, 0x90, 60, 100, CapturedMidiEventKind::Raw, 0, 0, 0, 0, 0});
+    }
+  });
+  REQUIRE(allocations == 0);
+  REQUIRE(ring.overflowCount() == 2);
+  REQUIRE(ring.highWaterMark() == 4);
+  int expectedFrameOffset = 0;
+  REQUIRE(ring.drain([&expectedFrameOffset](const CapturedMidiEvent& event) {
+    REQUIRE(event.frameOffset == expectedFrameOffset++);
+  }) == 4);
+  REQUIRE(ring.size() == 0);
+  REQUIRE(ring.push(CapturedMidiEvent{0, 0, 0xb0, 7, 127, CapturedMidiEventKind::Raw, 0, 0, 0, 0, 0}));
+}
+
+TEST_CASE("Audio hook captures MIDI without allocating") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Keyboard");
+  fake.addMidiInputDevice(2, "Controller");
+  const auto& ring = Reaper::instance().midiCaptureRing();
+  // Nothing is captured without interested subscribers
+  const auto subscription = Reaper::instance().incomingMidiEvents().subscribe([](const IncomingMidiEvent&) {});
+  // Warm up
+  fake.processAudioBlock(512);
+  fake.queueMidiInputEvent(0, {0x90, 60, 100}, 10);
+  fake.queueMidiInputEvent(2, {0xfe});
+  fake.queueMidiInputEvent(2, {0xb0, 1, 64}, 20);
+  const auto allocations = allocationsDuring([&fake] {
+    fake.processAudioBlock(512);
+  });
+  REQUIRE(allocations == 0);
+  // Active sensing is skipped
+  REQUIRE(ring.size() == 2);
+  REQUIRE(ring.overflowCount() == 0);
+  subscription.unsubscribe();
+}
+
+TEST_CASE("Audio hook captures SysEx without allocating") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Controller");
+  auto& reaper = Reaper::instance();
+  const auto subscription = reaper.incomingSysExEvents().subscribe([](const IncomingSysExEvent&) {});
+  // Warm up
+  fake.processAudioBlock(512);
+  fake.queueMidiInputEvent(0, {0xf0, 0x00, 0x20, 0x29, 0x02, 0x0d, 0x0e, 0x01, 0xf7});
+  const auto allocations = allocationsDuring([&fake] {
+    fake.processAudioBlock(512);
+  });
+  REQUIRE(allocations == 0);
+  REQUIRE(reaper.midiCaptureRing().size() == 1);
+  REQUIRE(reaper.sysExPool().freeBufferCount() == reaper.sysExPool().bufferCount() - 1);
+  subscription.unsubscribe();
+}
+
+TEST_CASE("MIDI capture ring with dense clock and aftertouch traffic", "[.][benchmark]") {
+  MidiCaptureRing ring(1024);
+  // One audio block worth of clock interleaved with channel aftertouch
+  std::vector<CapturedMidiEvent> block;
+  for (int i = 0; i < 256; i++) {
+    const auto status = (unsigned char) (i % 2 == 0 ? 0xf8 : 0xd0 | (i % 16));
+    const auto data1 = (unsigned char) (i % 128);
+    block.push_back(CapturedMidiEvent{0, i, status, data1, 0, CapturedMidiEventKind::Raw, 0, 0, 0, 0, 0});
+  }
+  BENCHMARK("Push and drain 256 events") {
+    for (const auto& event : block) {
+      ring.push(event);
+    }
+    int frameOffsetSum = 0;
+    ring.drain([&frameOffsetSum](const CapturedMidiEvent& event) {
+      frameOffsetSum += event.frameOffset;
+    });
+    return frameOffsetSum;
+  };
+  REQUIRE(ring.overflowCount() == 0);
+}
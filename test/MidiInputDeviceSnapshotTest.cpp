@@ -0,0 +1,41 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Reaper.h>
+#include <reaplus/MidiInputDevice.h>
+#include <reaplus/IncomingMidiEvent.h>
+#include <reaplus/MidiInputDeviceSnapshot.h>
+
+using namespace reaplus;
+
+TEST_CASE("MIDI input device snapshot only contains available devices") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(1, "Keyboard");
+  fake.addMidiInputDevice(4, "Controller");
+  const auto snapshot = MidiInputDeviceSnapshot::capture();
+  REQUIRE(snapshot.devices().size() == 2);
+  REQUIRE(snapshot.connectedDeviceIds() == std::vector<int>{1, 4});
+  REQUIRE(snapshot.findDevice(4)->name == "Controller");
+  REQUIRE(snapshot.findDevice(2) == nullptr);
+  REQUIRE(snapshot == MidiInputDeviceSnapshot::capture());
+}
+
+TEST_CASE("Audio hook only reads devices from the current snapshot") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Keyboard");
+  auto& reaper = Reaper::instance();
+  const auto& ring = reaper.midiCaptureRing();
+  const auto subscription = reaper.incomingMidiEvents().subscribe([](const IncomingMidiEvent&) {});
+  REQUIRE(reaper.midiInputDeviceById(0).name() == "Keyboard");
+  fake.addMidiInputDevice(1, "Controller");
+  fake.queueMidiInputEvent(1, {0xb0, 1, 64});
+  fake.processAudioBlock(512);
+  // Not refreshed yet
+  REQUIRE(ring.size() == 0);
+  reaper.refreshMidiInputDevices();
+  REQUIRE(reaper.midiInputDeviceSnapshot().connectedDeviceIds() == std::vector<int>{0, 1});
+  REQUIRE(reaper.midiInputDeviceById(1).name() == "Controller");
+  fake.queueMidiInputEvent(1, {0xb0, 1, 65});
+  fake.processAudioBlock(512);
+  REQUIRE(ring.size() == 1);
+  subscription.unsubscribe();
+}
@@ -0,0 +1,64 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Reaper.h>
+#include <reaplus/MidiOutputScheduler.h>
+#include <vector>
+
+using namespace reaplus;
+
+TEST_CASE("MIDI output scheduler sends messages in the block they are due") {
+  FakeReaper fake;
+  fake.addMidiOutputDevice(0, "Controller");
+  auto& reaper = Reaper::instance();
+  auto& scheduler = reaper.midiOutputScheduler();
+  const auto blockStart = reaper.sampleCounter();
+  REQUIRE(scheduler.scheduleShortMessage(0, 0x90, 60, 100));
+  // Second half of the second block
+  REQUIRE(scheduler.scheduleShortMessage(0, 0xb0, 7, 64, blockStart + 480 + 240));
+  fake.processAudioBlock(480, 48000);
+  REQUIRE(fake.sentMidiMessages(0) == std::vector<std::vector<unsigned char>>{{0x90, 60, 100}});
+  fake.processAudioBlock(480, 48000);
+  REQUIRE(fake.sentMidiMessages(0).size() == 2);
+  REQUIRE(fake.sentMidiMessages(0)[1] == std::vector<unsigned char>{0xb0, 7, 64});
+  // 5 ms in units of 1/1024000 s
+  REQUIRE(fake.sentMidiFrameOffsets(0) == std::vector<int>{0, 5120});
+  REQUIRE(scheduler.sentCount() == 2);
+}
+
+TEST_CASE("MIDI output scheduler sends SysEx from pooled buffers") {
+  FakeReaper fake;
+  fake.addMidiOutputDevice(1, "Display");
+  auto& scheduler = Reaper::instance().midiOutputScheduler();
+  const std::vector<unsigned char> sysEx{0xf0, 0x7e, 0x7f, 0x06, 0x01, 0xf7};
+  for (std::size_t i = 0; i < MidiOutputScheduler::SYSEX_BUFFER_COUNT_PER_DEVICE; i++) {
+    REQUIRE(scheduler.scheduleSysEx(1, sysEx.data(), sysEx.size()));
+  }
+  // Pool exhausted
+  REQUIRE(!scheduler.scheduleSysEx(1, sysEx.data(), sysEx.size()));
+  const std::vector<unsigned char> tooBig(MidiOutputScheduler::MAX_SYSEX_SIZE + 1, 0);
+  REQUIRE(!scheduler.scheduleSysEx(1, tooBig.data(), tooBig.size()));
+  REQUIRE(scheduler.droppedCount() == 2);
+  fake.processAudioBlock(512);
+  REQUIRE(fake.sentMidiMessages(1).size() == MidiOutputScheduler::SYSEX_BUFFER_COUNT_PER_DEVICE);
+  REQUIRE(fake.sentMidiMessages(1)[0] == sysEx);
+  // Buffers are free again
+  REQUIRE(scheduler.scheduleSysEx(1, sysEx.data(), sysEx.size()));
+}
+
+TEST_CASE("MIDI output scheduler respects the rate limit of a device") {
+  FakeReaper fake;
+  fake.addMidiOutputDevice(0, "Slow controller");
+  auto& scheduler = Reaper::instance().midiOutputScheduler();
+  // 3 bytes = one short message per 10 ms block
+  scheduler.setRateLimit(0, 300);
+  for (int i = 0; i < 3; i++) {
+    REQUIRE(scheduler.scheduleShortMessage(0, 0xb0, (unsigned char) i, 127));
+  }
+  fake.processAudioBlock(480, 48000);
+  REQUIRE(fake.sentMidiMessages(0).size() == 1);
+  REQUIRE(scheduler.rateLimitedCount() == 1);
+  fake.processAudioBlock(480, 48000);
+  fake.processAudioBlock(480, 48000);
+  REQUIRE(fake.sentMidiMessages(0).size() == 3);
+  REQUIRE(fake.sentMidiMessages(0)[2] == std::vector<unsigned char>{0xb0, 2, 127});
+}
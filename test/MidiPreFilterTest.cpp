@@ -0,0 +1,138 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/MidiCaptureRing.h>
+#include <reaplus/MidiPreFilter.h>
+#include <reaplus/Reaper.h>
+#include <reaplus/IncomingMidiEvent.h>
+#include <utility>
+#include <vector>
+
+using namespace reaplus;
+
+namespace {
+  MidiInterest controlChangesOnDevice(int deviceId, unsigned char minCc, unsigned char maxCc) {
+    MidiInterest interest;
+    interest.inputDeviceId = deviceId;
+    interest.minType = 0xb0;
+    interest.maxType = 0xb0;
+    interest.minData1 = minCc;
+    interest.maxData1 = maxCc;
+    return interest;
+  }
+}
+
+TEST_CASE("MIDI pre-filter matches nothing by default") {
+  MidiPreFilter filter;
+  REQUIRE(filter.matchesNothing());
+  REQUIRE(!filter.matches(0, 0x90, 60));
+  REQUIRE(MidiPreFilter::compile({}).matchesNothing());
+}
+
+TEST_CASE("MIDI pre-filter lets through everything an interest matches") {
+  auto ccOnChannel2 = controlChangesOnDevice(3, 1, 7);
+  ccOnChannel2.channelMask = 1 << 1;
+  MidiInterest clockFromAnyDevice;
+  clockFromAnyDevice.minType = 0xf8;
+  clockFromAnyDevice.maxType = 0xf8;
+  const auto filter = MidiPreFilter::compile({ccOnChannel2, clockFromAnyDevice});
+  REQUIRE(!filter.matchesNothing());
+  REQUIRE(filter.matches(3, 0xb1, 1));
+  REQUIRE(filter.matches(3, 0xb1, 7));
+  REQUIRE(filter.matches(100, 0xf8, 0));
+  REQUIRE(filter.matches(5, 0xf8, 0));
+  REQUIRE(!filter.matches(3, 0xb0, 1));
+  REQUIRE(!filter.matches(3, 0xb1, 8));
+  REQUIRE(!filter.matches(4, 0xb1, 1));
+  REQUIRE(!filter.matches(3, 0x91, 1));
+  REQUIRE(!filter.matches(3, 0xfa, 0));
+}
+
+TEST_CASE("Audio hook only captures MIDI events which subscribers are interested in") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Keyboard");
+  fake.addMidiInputDevice(1, "Controller");
+  auto& reaper = Reaper::instance();
+  // Captured MIDI is delivered in the helper control surface's Run()
+  reaper.init();
+  const auto& ring = reaper.midiCaptureRing();
+  std::vector<int> receivedControllerNumbers;
+  const auto subscription = reaper.incomingMidiEvents({controlChangesOnDevice(0, 0, 127)})
+      .subscribe([&receivedControllerNumbers](const IncomingMidiEvent& event) {
+        receivedControllerNumbers.push_back(event.message().getDataByte1());
+      });
+  fake.queueMidiInputEvent(0, {0xb0, 7, 100});
+  fake.queueMidiInputEvent(0, {0xf8});
+  fake.queueMidiInputEvent(0, {0xd0, 20});
+  fake.queueMidiInputEvent(1, {0xb0, 8, 100});
+  fake.processAudioBlock(512);
+  REQUIRE(ring.size() == 1);
+  fake.runControlSurfaces();
+  REQUIRE(receivedControllerNumbers == std::vector<int>{7});
+  // Nobody interested anymore
+  subscription.unsubscribe();
+  fake.queueMidiInputEvent(0, {0xb0, 7, 100});
+  fake.processAudioBlock(512);
+  REQUIRE(ring.size() == 0);
+}
+
+TEST_CASE("MIDI pre-filter with dense clock and aftertouch traffic", "[.][benchmark]") {
+  // Status and data byte 1. Mostly clock and aftertouch, which nobody is interested in.
+  std::vector<std::pair<unsigned char, unsigned char>> events;
+  for (int i = 0; i < 1024; i++) {
+    const auto channel = (unsigned char) (i % 16);
+    const auto data1 = (unsigned char) (i % 128);
+    switch (i % 4) {
+      case 0:
+        events.emplace_back(0xf8, 0);
+        break;
+      case 1:
+        events.emplace_back(0xd0 | channel, data1);
+        break;
+      case 2:
+        events.emplace_back(0xa0 | channel, data1);
+        break;
+      default:
+        events.emplace_back(0xb0 | channel, data1);
+        break;
+    }
+  }
+  const auto filter = MidiPreFilter::compile({controlChangesOnDevice(0, 0, 31), controlChangesOnDevice(1, 64, 127)});
+  BENCHMARK("1024 events") {
+    int matchCount = 0;
+    for (const auto& event : events) {
+      if (filter.matches(0, event.first, event.second)) {
+        matchCount++;
+      }
+    }
+    return matchCount;
+  };
+  // Captured events go through the ring to the main thread
+  MidiCaptureRing ring(events.size());
+  const auto capture = [&ring](const std::pair<unsigned char, unsigned char>& event) {
+    ring.push(CapturedMidiEvent{0, 0, event.first, event.second, 0, CapturedMidiEventKind::Raw, 0, 0, 0, 0, 0});
+  };
+  const auto drain = [&ring] {
+    int deliveredCount = 0;
+    ring.drain([&deliveredCount](const CapturedMidiEvent&) {
+      deliveredCount++;
+    });
+    return deliveredCount;
+  };
+  BENCHMARK("1024 events, pre-filtered capture") {
+    for (const auto& event : events) {
+      if (filter.matches(0, event.first, event.second)) {
+        capture(event);
+      }
+    }
+    return drain();
+  };
+  // Baseline: Everything except active sensing was captured and only filtered by the subscribers
+  BENCHMARK("1024 events, unfiltered capture") {
+    for (const auto& event : events) {
+      if (event.first != 0xfe) {
+        capture(event);
+      }
+    }
+    return drain();
+  };
+}
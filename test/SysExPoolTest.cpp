@@ -0,0 +1,60 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Reaper.h>
+#include <reaplus/SysExPool.h>
+#include <reaplus/IncomingSysExEvent.h>
+#include <reaplus/IncomingMidiEvent.h>
+#include <vector>
+
+using namespace reaplus;
+
+TEST_CASE("SysEx pool hands out buffers until exhausted") {
+  SysExPool pool(2, 8);
+  const unsigned char message[] = {0xf0, 0x01, 0x02, 0xf7};
+  const auto first = pool.acquire(message, sizeof(message));
+  const auto second = pool.acquire(message, sizeof(message));
+  REQUIRE(first >= 0);
+  REQUIRE(second >= 0);
+  REQUIRE(first != second);
+  REQUIRE(std::vector<unsigned char>(pool.buffer(first), pool.buffer(first) + 4)
+              == std::vector<unsigned char>(message, message + 4));
+  REQUIRE(pool.acquire(message, sizeof(message)) == -1);
+  REQUIRE(pool.exhaustedCount() == 1);
+  const unsigned char tooBig[9] = {0xf0};
+  pool.release(first);
+  REQUIRE(pool.acquire(tooBig, sizeof(tooBig)) == -1);
+  REQUIRE(pool.oversizedCount() == 1);
+  REQUIRE(pool.freeBufferCount() == 1);
+  REQUIRE(pool.acquire(message, sizeof(message)) == first);
+}
+
+TEST_CASE("Captured SysEx is delivered complete and released after consumption") {
+  FakeReaper fake;
+  fake.addMidiInputDevice(0, "Controller");
+  auto& reaper = Reaper::instance();
+  // Captured MIDI is delivered in the helper control surface's Run()
+  reaper.init();
+  const auto& pool = reaper.sysExPool();
+  std::vector<std::vector<unsigned char>> receivedMessages;
+  int rawEventCount = 0;
+  const auto sysExSubscription = reaper.incomingSysExEvents().subscribe(
+      [&receivedMessages, &pool](const IncomingSysExEvent& event) {
+        // Still occupied while being consumed
+        REQUIRE(pool.freeBufferCount() == pool.bufferCount() - 1);
+        receivedMessages.emplace_back(event.data(), event.data() + event.size());
+      });
+  const auto rawSubscription = reaper.incomingMidiEvents().subscribe([&rawEventCount](const IncomingMidiEvent&) {
+    rawEventCount++;
+  });
+  const std::vector<unsigned char> identityReply{0xf0, 0x7e, 0x00, 0x06, 0x02, 0x47, 0x73, 0x00, 0xf7};
+  fake.queueMidiInputEvent(0, identityReply);
+  fake.queueMidiInputEvent(0, {0x90, 60, 100});
+  fake.processAudioBlock(512);
+  fake.runControlSurfaces();
+  REQUIRE(receivedMessages == std::vector<std::vector<unsigned char>>{identityReply});
+  // SysEx is not delivered as (truncated) short message anymore
+  REQUIRE(rawEventCount == 1);
+  REQUIRE(pool.freeBufferCount() == pool.bufferCount());
+  sysExSubscription.unsubscribe();
+  rawSubscription.unsubscribe();
+}
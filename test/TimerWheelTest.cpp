@@ -0,0 +1,163 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/TimerWheel.h>
+#include <reaplus/Reaper.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace reaplus;
+using std::chrono::milliseconds;
+using std::chrono::hours;
+using std::chrono::seconds;
+
+namespace {
+  const auto START = TimerWheel::Clock::time_point();
+}
+
+TEST_CASE("Timer wheel fires timers in due order") {
+  TimerWheel wheel(START);
+  std::string fired;
+  wheel.scheduleAt(START + milliseconds(30), [&fired] {
+    fired += "c";
+  });
+  wheel.scheduleAt(START + milliseconds(10), [&fired] {
+    fired += "a";
+  });
+  wheel.scheduleAt(START + milliseconds(10), [&fired] {
+    fired += "b";
+  });
+  REQUIRE(wheel.size() == 3);
+  REQUIRE(wheel.advance(START + milliseconds(9)) == 0);
+  REQUIRE(wheel.advance(START + milliseconds(10)) == 2);
+  REQUIRE(fired == "ab");
+  REQUIRE(wheel.advance(START + milliseconds(100)) == 1);
+  REQUIRE(fired == "abc");
+  REQUIRE(wheel.size() == 0);
+}
+
+TEST_CASE("Timer wheel fires overdue timers with the next advance") {
+  TimerWheel wheel(START);
+  wheel.advance(START + milliseconds(50));
+  bool fired = false;
+  wheel.scheduleAt(START + milliseconds(20), [&fired] {
+    fired = true;
+  });
+  wheel.advance(START + milliseconds(50));
+  REQUIRE(fired);
+}
+
+TEST_CASE("Timer wheel cascades far timers down to their exact tick") {
+  TimerWheel wheel(START);
+  std::vector<milliseconds> delays{milliseconds(64), milliseconds(4095), milliseconds(4097), milliseconds(300000),
+      std::chrono::duration_cast<milliseconds>(hours(6))};
+  std::vector<int> firedAt;
+  for (const auto delay : delays) {
+    const auto due = (int) delay.count();
+    wheel.scheduleAt(START + delay, [&firedAt, due] {
+      firedAt.push_back(due);
+    });
+  }
+  for (const auto delay : delays) {
+    wheel.advance(START + delay - milliseconds(1));
+    REQUIRE(firedAt.size() < delays.size());
+    REQUIRE((firedAt.empty() || firedAt.back() < delay.count()));
+    const auto firedCount = firedAt.size();
+    wheel.advance(START + delay);
+    REQUIRE(firedAt.size() == firedCount + 1);
+    REQUIRE(firedAt.back() == delay.count());
+  }
+}
+
+TEST_CASE("Timer wheel cancels timers via handle") {
+  TimerWheel wheel(START);
+  bool fired = false;
+  const auto handle = wheel.scheduleAt(START + milliseconds(10), [&fired] {
+    fired = true;
+  });
+  REQUIRE(wheel.isPending(handle));
+  REQUIRE(wheel.cancel(handle));
+  REQUIRE(!wheel.isPending(handle));
+  REQUIRE(!wheel.cancel(handle));
+  wheel.advance(START + milliseconds(20));
+  REQUIRE(!fired);
+  REQUIRE(!wheel.cancel(TimerHandle()));
+}
+
+TEST_CASE("Timer wheel doesn't confuse stale handles with reused timers") {
+  TimerWheel wheel(START);
+  const auto firstHandle = wheel.scheduleAt(START + milliseconds(1), [] {
+  });
+  wheel.advance(START + milliseconds(1));
+  bool fired = false;
+  const auto secondHandle = wheel.scheduleAt(START + milliseconds(5), [&fired] {
+    fired = true;
+  });
+  REQUIRE(!wheel.isPending(firstHandle));
+  REQUIRE(!wheel.cancel(firstHandle));
+  REQUIRE(wheel.isPending(secondHandle));
+  wheel.advance(START + milliseconds(5));
+  REQUIRE(fired);
+}
+
+TEST_CASE("Timer wheel tasks can schedule and cancel timers") {
+  TimerWheel wheel(START);
+  int blinkCount = 0;
+  const auto releaseHandle = wheel.scheduleAt(START + milliseconds(100), [] {
+    throw std::runtime_error("should have been cancelled");
+  });
+  wheel.scheduleAt(START + milliseconds(1), [&wheel, &blinkCount, releaseHandle] {
+    blinkCount++;
+    wheel.cancel(releaseHandle);
+    wheel.scheduleAt(START + milliseconds(2), [&blinkCount] {
+      blinkCount++;
+    });
+  });
+  wheel.advance(START + milliseconds(1));
+  REQUIRE(blinkCount == 1);
+  REQUIRE(wheel.size() == 1);
+  wheel.advance(START + milliseconds(200));
+  REQUIRE(blinkCount == 2);
+}
+
+TEST_CASE("Delayed main thread tasks are executed by the helper control surface") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  bool fired = false;
+  reaper.executeLaterInMainThread(milliseconds(0), [&fired] {
+    fired = true;
+  });
+  const auto handle = reaper.executeLaterInMainThread(milliseconds(0), [] {
+    throw std::runtime_error("should have been cancelled");
+  });
+  REQUIRE(reaper.timerWheel().cancel(handle));
+  std::this_thread::sleep_for(milliseconds(2));
+  fake.runControlSurfaces();
+  REQUIRE(fired);
+}
+
+TEST_CASE("Timer wheel with 100k pending timers", "[.][benchmark]") {
+  const int timerCount = 100000;
+  // Spread over one minute, so each millisecond has a few timers due
+  const auto horizon = milliseconds(60000);
+  TimerWheel wheel(START);
+  for (int i = 0; i < timerCount; i++) {
+    wheel.scheduleAt(START + milliseconds(1 + i % horizon.count()), [] {});
+  }
+  auto now = START;
+  BENCHMARK("Schedule and cancel") {
+    const auto handle = wheel.scheduleAt(now + seconds(5), [] {});
+    return wheel.cancel(handle);
+  };
+  BENCHMARK("Advance by 1 ms") {
+    now += milliseconds(1);
+    const auto firedCount = wheel.advance(now);
+    // Keep the number of pending timers constant
+    for (std::size_t i = 0; i < firedCount; i++) {
+      wheel.scheduleAt(now + horizon, [] {});
+    }
+    return firedCount;
+  };
+  REQUIRE(wheel.size() == (std::size_t) timerCount);
+}
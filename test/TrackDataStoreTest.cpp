@@ -0,0 +1,76 @@
+#include <catch.hpp>
+#include <reaplus/TrackDataStore.h>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+using namespace reaplus;
+
+namespace {
+  // Distinct fake track pointers, spaced like small heap objects
+  class FakeTracks {
+  public:
+    explicit FakeTracks(std::size_t count) : memory_(count * 64) {
+    }
+
+    MediaTrack* operator[](std::size_t index) {
+      return reinterpret_cast<MediaTrack*>(&memory_[index * 64]);
+    }
+
+  private:
+    std::vector<char> memory_;
+  };
+
+  TrackData trackDataWithVolume(double volume) {
+    TrackData data{};
+    data.volume = volume;
+    return data;
+  }
+}
+
+TEST_CASE("Track data store keeps slots dense") {
+  FakeTracks tracks(3);
+  TrackDataStore store;
+  for (int i = 0; i < 3; i++) {
+    REQUIRE(store.add(tracks[i], trackDataWithVolume(i)) == i);
+  }
+  REQUIRE(store.slotOf(tracks[1]) == 1);
+  store.remove(0);
+  // The last track moved into the freed slot
+  REQUIRE(store.size() == 2);
+  REQUIRE(store.slotOf(tracks[0]) == TrackDataStore::NO_SLOT);
+  REQUIRE(store.slotOf(tracks[2]) == 0);
+  REQUIRE(store.get(0).volume == 2);
+  REQUIRE(store.slotOf(tracks[1]) == 1);
+}
+
+TEST_CASE("Track data store lookup", "[.][benchmark]") {
+  const std::size_t trackCount = 5000;
+  FakeTracks tracks(trackCount + 1);
+  TrackDataStore store;
+  for (std::size_t i = 0; i < trackCount; i++) {
+    store.add(tracks[i], trackDataWithVolume(0));
+  }
+  std::size_t next = 0;
+  BENCHMARK("Known track among 5000") {
+    next = (next + 1) % trackCount;
+    return store.slotOf(tracks[next]);
+  };
+  BENCHMARK("Unknown track among 5000") {
+    return store.slotOf(tracks[trackCount]);
+  };
+  // Baseline: How the track data used to be looked up
+  std::unordered_map<MediaTrack*, TrackData> trackDataByMediaTrack;
+  for (std::size_t i = 0; i < trackCount; i++) {
+    trackDataByMediaTrack[tracks[i]] = trackDataWithVolume(0);
+  }
+  BENCHMARK("Known track among 5000, unordered_map") {
+    next = (next + 1) % trackCount;
+    const auto mediaTrack = tracks[next];
+    return trackDataByMediaTrack.count(mediaTrack) == 0 ? nullptr : &trackDataByMediaTrack.at(mediaTrack);
+  };
+  BENCHMARK("Unknown track among 5000, unordered_map") {
+    const auto mediaTrack = tracks[trackCount];
+    return trackDataByMediaTrack.count(mediaTrack) == 0 ? nullptr : &trackDataByMediaTrack.at(mediaTrack);
+  };
+}
@@ -0,0 +1,153 @@
+#include <catch.hpp>
+#include "FakeReaper.h"
+#include <reaplus/Chunk.h>
+#include <reaplus/Reaper.h>
+#include <reaplus/WorkerPool.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace reaplus;
+
+namespace {
+  // Collects what the pool posts to the main thread
+  class FakeMainThread {
+  public:
+    WorkerPool::MainThreadPoster poster() {
+      return [this](MainThreadTask task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+      };
+    }
+
+    void run() {
+      std::vector<MainThreadTask> tasks;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks.swap(tasks_);
+      }
+      for (auto& task : tasks) {
+        task();
+      }
+    }
+
+  private:
+    std::mutex mutex_;
+    std::vector<MainThreadTask> tasks_;
+  };
+}
+
+TEST_CASE("Worker pool delivers results and exceptions to the main thread") {
+  FakeMainThread mainThread;
+  WorkerPool pool(3, mainThread.poster());
+  std::atomic<int> nestedCount(0);
+  int resultSum = 0;
+  bool errorDelivered = false;
+  for (int i = 0; i < 100; i++) {
+    pool.submit([&pool, &nestedCount, i] {
+      // Goes into the worker's own deque
+      pool.submit([&nestedCount] {
+        nestedCount++;
+      });
+      return i;
+    }).then([&resultSum](int result) {
+      resultSum += result;
+    });
+  }
+  pool.submit([]() -> int {
+    throw std::runtime_error("expected");
+  }).then([](int) {}, [&errorDelivered](std::exception_ptr) {
+    errorDelivered = true;
+  });
+  // Finishes everything submitted so far
+  pool.shutdown();
+  REQUIRE(nestedCount == 100);
+  REQUIRE(resultSum == 0);
+  mainThread.run();
+  REQUIRE(resultSum == 4950);
+  REQUIRE(errorDelivered);
+  REQUIRE_THROWS_AS(pool.submit([] {}), std::logic_error);
+}
+
+TEST_CASE("Worker pool rejects submissions after shutdown without starting threads") {
+  FakeMainThread mainThread;
+  WorkerPool pool(2, mainThread.poster());
+  pool.shutdown();
+  REQUIRE_THROWS_AS(pool.submit([] {}), std::logic_error);
+  // Destructor must not find unjoined threads
+}
+
+TEST_CASE("Worker pool lets running tasks fan out while shutting down") {
+  FakeMainThread mainThread;
+  WorkerPool pool(2, mainThread.poster());
+  std::atomic<bool> shutdownRequested(false);
+  std::atomic<int> leafCount(0);
+  int errorCount = 0;
+  int resultCount = 0;
+  for (int i = 0; i < 4; i++) {
+    pool.submit([&pool, &shutdownRequested, &leafCount] {
+      while (!shutdownRequested) {
+        std::this_thread::yield();
+      }
+      // Give shutdown() time to set the stopping flag
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      for (int j = 0; j < 10; j++) {
+        pool.submit([&leafCount] {
+          leafCount++;
+        });
+      }
+    }).then([&resultCount] {
+      resultCount++;
+    }, [&errorCount](std::exception_ptr) {
+      errorCount++;
+    });
+  }
+  shutdownRequested = true;
+  pool.shutdown();
+  REQUIRE(leafCount == 40);
+  mainThread.run();
+  REQUIRE(resultCount == 4);
+  REQUIRE(errorCount == 0);
+}
+
+TEST_CASE("Worker pool delivers results also if then() comes late") {
+  FakeMainThread mainThread;
+  WorkerPool pool(1, mainThread.poster());
+  const auto future = pool.submit([] {
+    return std::string("done");
+  });
+  while (!future.isReady()) {
+    std::this_thread::yield();
+  }
+  std::string result;
+  future.then([&result](std::string r) {
+    result = std::move(r);
+  });
+  REQUIRE(result.empty());
+  mainThread.run();
+  REQUIRE(result == "done");
+}
+
+TEST_CASE("Chunks can be parsed in a Reaper worker thread") {
+  FakeReaper fake;
+  auto& reaper = Reaper::instance();
+  const auto content = std::make_shared<std::string>("<TRACK\nNAME Drums\n<FXCHAIN\nSHOW 0\n>\n>\n");
+  boost::optional<std::string> fxChain;
+  reaper.executeInWorkerThread([content] {
+    const auto region = Chunk(content).region().findFirstTagNamed(0, "FXCHAIN");
+    return region ? region->content().to_string() : std::string();
+  }).then([&fxChain](std::string result) {
+    fxChain = std::move(result);
+  });
+  const auto start = std::chrono::steady_clock::now();
+  while (!fxChain && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+    fake.runControlSurfaces();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  REQUIRE(fxChain.is_initialized());
+  REQUIRE(*fxChain == "<FXCHAIN\nSHOW 0\n>");
+}